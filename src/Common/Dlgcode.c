@@ -5734,6 +5734,10 @@ void handleError (HWND hwndDlg, int code, const char* srcPos)
 		Error ("ERR_NONSYS_INPLACE_ENC_INCOMPLETE", hwndDlg);
 		break;
 
+	case ERR_VOLUME_REENCRYPTION_INCOMPLETE:
+		Error ("ERR_VOLUME_REENCRYPTION_INCOMPLETE", hwndDlg);
+		break;
+
 	case ERR_SYS_HIDVOL_HEAD_REENC_MODE_WRONG:
 		Error ("ERR_SYS_HIDVOL_HEAD_REENC_MODE_WRONG", hwndDlg);
 		break;
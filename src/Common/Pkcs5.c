@@ -274,8 +274,73 @@ void derive_key_sha256 (const unsigned char *pwd, int pwd_len, const unsigned ch
 
 	sha256_hash (buf, SHA256_BLOCKSIZE, ctx);
 
+	b = 1;
+
+#ifdef SHA256_PBKDF2_LANES
+	/* Independent blocks are derived in parallel: two at a time as interleaved SHA-NI streams,
+	   otherwise SHA256_PBKDF2_LANES at a time in AVX2 lanes */
+	if (l > 1 && (HasSHA256 () || HasSAVX2 ()))
+	{
+		uint_32t u[SHA256_PBKDF2_LANES][8];
+		int maxLanes = HasSHA256 () ? SHA256_PBKDF2_SHANI_LANES : SHA256_PBKDF2_LANES;
+		int lane, lanes, i, derived;
+
+		while (b <= l)
+		{
+			lanes = l - b + 1;
+			if (lanes > maxLanes)
+				lanes = maxLanes;
+
+			/* iteration 1 of each lane; unused lanes are computed from a copy of the last one */
+			for (lane = 0; lane < maxLanes; lane++)
+			{
+				uint32 be = bswap_32 ((uint32) (b + (lane < lanes ? lane : lanes - 1)));
+
+				memcpy (hmac.k, salt, salt_len);
+				memcpy (&hmac.k[salt_len], &be, 4);
+				hmac_sha256_internal (hmac.k, salt_len + 4, &hmac);
+
+				memcpy (u[lane], hmac.k, SHA256_DIGESTSIZE);
+				for (i = 0; i < 8; i++)
+					u[lane][i] = bswap_32 (u[lane][i]);
+			}
+
+			if (maxLanes == SHA256_PBKDF2_SHANI_LANES)
+				derived = sha256_pbkdf2_shani_x2 (hmac.inner_digest_ctx.hash, hmac.outer_digest_ctx.hash, u, iterations, pAbortKeyDerivation);
+			else
+				derived = sha256_pbkdf2_x8 (hmac.inner_digest_ctx.hash, hmac.outer_digest_ctx.hash, u, iterations, pAbortKeyDerivation);
+
+			if (!derived)
+			{
+				burn (u, sizeof (u));
+				break;
+			}
+
+			if (pAbortKeyDerivation && *pAbortKeyDerivation == 1)
+			{
+				burn (u, sizeof (u));
+				goto cancelled;
+			}
+
+			for (lane = 0; lane < lanes; lane++, b++)
+			{
+				for (i = 0; i < 8; i++)
+					u[lane][i] = bswap_32 (u[lane][i]);
+
+				memcpy (dk, u[lane], b < l ? SHA256_DIGESTSIZE : r);
+				dk += SHA256_DIGESTSIZE;
+			}
+		}
+
+		burn (u, sizeof (u));
+
+		if (b > l)
+			goto done;
+	}
+#endif
+
 	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+	for (; b < l; b++)
 	{
 #ifndef TC_WINDOWS_BOOT
 		derive_u_sha256 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
@@ -300,6 +365,9 @@ void derive_key_sha256 (const unsigned char *pwd, int pwd_len, const unsigned ch
 #endif
 	memcpy (dk, hmac.u, r);
 
+#ifdef SHA256_PBKDF2_LANES
+done:
+#endif
 #if defined (DEVICE_DRIVER) && !defined(_M_ARM64)
 	if (NT_SUCCESS (saveStatus))
 		KeRestoreExtendedProcessorState(&SaveState);
@@ -518,8 +586,82 @@ void derive_key_sha512 (const unsigned char *pwd, int pwd_len, const unsigned ch
 
 	sha512_hash (buf, SHA512_BLOCKSIZE, ctx);
 
+	b = 1;
+
+#ifdef SHA512_PBKDF2_LANES
+	/* Independent blocks are derived in parallel: SHA512_PBKDF2_LANES at a time in AVX2 lanes,
+	   or SHA512_PBKDF2_AVX512_LANES at a time in AVX-512 lanes when more blocks are needed */
+	if (l > 1 && HasSAVX2 ())
+	{
+		uint_64t u[SHA512_PBKDF2_AVX512_LANES][8];
+		int maxLanes = (HasSAVX512 () && l > SHA512_PBKDF2_LANES) ? SHA512_PBKDF2_AVX512_LANES : SHA512_PBKDF2_LANES;
+		int lane, lanes, i, derived;
+
+		while (b <= l)
+		{
+			lanes = l - b + 1;
+			if (lanes > maxLanes)
+				lanes = maxLanes;
+
+			/* iteration 1 of each lane; unused lanes are computed from a copy of the last one */
+			for (lane = 0; lane < maxLanes; lane++)
+			{
+				uint32 be = bswap_32 ((uint32) (b + (lane < lanes ? lane : lanes - 1)));
+
+				memcpy (hmac.k, salt, salt_len);
+				memcpy (&hmac.k[salt_len], &be, 4);
+				hmac_sha512_internal (hmac.k, salt_len + 4, &hmac);
+
+				memcpy (u[lane], hmac.k, SHA512_DIGESTSIZE);
+				for (i = 0; i < 8; i++)
+					u[lane][i] = bswap_64 (u[lane][i]);
+			}
+
+			if (maxLanes == SHA512_PBKDF2_AVX512_LANES)
+			{
+				derived = sha512_pbkdf2_x8 (hmac.inner_digest_ctx.hash, hmac.outer_digest_ctx.hash, u, iterations, pAbortKeyDerivation);
+
+				/* AVX-512 support was not compiled in: the same blocks are derived with AVX2 */
+				if (!derived)
+				{
+					maxLanes = SHA512_PBKDF2_LANES;
+					continue;
+				}
+			}
+			else
+				derived = sha512_pbkdf2_x4 (hmac.inner_digest_ctx.hash, hmac.outer_digest_ctx.hash, u, iterations, pAbortKeyDerivation);
+
+			if (!derived)
+			{
+				burn (u, sizeof (u));
+				break;
+			}
+
+			if (pAbortKeyDerivation && *pAbortKeyDerivation == 1)
+			{
+				burn (u, sizeof (u));
+				goto cancelled;
+			}
+
+			for (lane = 0; lane < lanes; lane++, b++)
+			{
+				for (i = 0; i < 8; i++)
+					u[lane][i] = bswap_64 (u[lane][i]);
+
+				memcpy (dk, u[lane], b < l ? SHA512_DIGESTSIZE : r);
+				dk += SHA512_DIGESTSIZE;
+			}
+		}
+
+		burn (u, sizeof (u));
+
+		if (b > l)
+			goto done;
+	}
+#endif
+
 	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+	for (; b < l; b++)
 	{
 		derive_u_sha512 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
 		// Check if the derivation was aborted
@@ -536,6 +678,9 @@ void derive_key_sha512 (const unsigned char *pwd, int pwd_len, const unsigned ch
 		goto cancelled;
 	memcpy (dk, hmac.u, r);
 
+#ifdef SHA512_PBKDF2_LANES
+done:
+#endif
 #if defined (DEVICE_DRIVER) && !defined(_M_ARM64)
 	if (NT_SUCCESS (saveStatus))
 		KeRestoreExtendedProcessorState(&SaveState);
@@ -786,8 +931,61 @@ void derive_key_blake2s (const unsigned char *pwd, int pwd_len, const unsigned c
 
 	blake2s_update (ctx, buf, BLAKE2S_BLOCKSIZE);
 
+	b = 1;
+
+#ifdef BLAKE2S_PBKDF2_LANES
+	/* Independent blocks are derived in parallel, BLAKE2S_PBKDF2_LANES at a time */
+	if (l > 1 && HasSAVX2 ())
+	{
+		uint32 u[BLAKE2S_PBKDF2_LANES][8];
+		int lane, lanes;
+
+		while (b <= l)
+		{
+			lanes = l - b + 1;
+			if (lanes > BLAKE2S_PBKDF2_LANES)
+				lanes = BLAKE2S_PBKDF2_LANES;
+
+			/* iteration 1 of each lane; unused lanes are computed from a copy of the last one */
+			for (lane = 0; lane < BLAKE2S_PBKDF2_LANES; lane++)
+			{
+				uint32 be = bswap_32 ((uint32) (b + (lane < lanes ? lane : lanes - 1)));
+
+				memcpy (hmac.k, salt, salt_len);
+				memcpy (&hmac.k[salt_len], &be, 4);
+				hmac_blake2s_internal (hmac.k, salt_len + 4, &hmac);
+
+				memcpy (u[lane], hmac.k, BLAKE2S_DIGESTSIZE);
+			}
+
+			if (!blake2s_pbkdf2_x8 (&hmac.inner_digest_ctx, &hmac.outer_digest_ctx, u, iterations, pAbortKeyDerivation))
+			{
+				burn (u, sizeof (u));
+				break;
+			}
+
+			if (pAbortKeyDerivation && *pAbortKeyDerivation)
+			{
+				burn (u, sizeof (u));
+				goto cancelled;
+			}
+
+			for (lane = 0; lane < lanes; lane++, b++)
+			{
+				memcpy (dk, u[lane], b < l ? BLAKE2S_DIGESTSIZE : r);
+				dk += BLAKE2S_DIGESTSIZE;
+			}
+		}
+
+		burn (u, sizeof (u));
+
+		if (b > l)
+			goto done;
+	}
+#endif
+
 	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+	for (; b < l; b++)
 	{
 #ifndef TC_WINDOWS_BOOT
 		derive_u_blake2s (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
@@ -812,6 +1010,9 @@ void derive_key_blake2s (const unsigned char *pwd, int pwd_len, const unsigned c
 #endif
 	memcpy (dk, hmac.u, r);
 
+#ifdef BLAKE2S_PBKDF2_LANES
+done:
+#endif
 #if defined (DEVICE_DRIVER) && !defined(_M_ARM64)
 	if (NT_SUCCESS (saveStatus))
 		KeRestoreExtendedProcessorState(&SaveState);
@@ -1009,8 +1210,54 @@ void derive_key_whirlpool (const unsigned char *pwd, int pwd_len, const unsigned
 
 	WHIRLPOOL_add (buf, WHIRLPOOL_BLOCKSIZE, ctx);
 
+	/* Blocks are derived WHIRLPOOL_PBKDF2_LANES at a time */
+	for (b = 1; b <= l; b += WHIRLPOOL_PBKDF2_LANES)
+	{
+		unsigned char u[WHIRLPOOL_PBKDF2_LANES][WHIRLPOOL_DIGESTSIZE];
+		int lane, lanes;
+
+		lanes = l - b + 1;
+		if (lanes > WHIRLPOOL_PBKDF2_LANES)
+			lanes = WHIRLPOOL_PBKDF2_LANES;
+
+		/* iteration 1 of each lane */
+		for (lane = 0; lane < lanes; lane++)
+		{
+			uint32 be = bswap_32 ((uint32) (b + lane));
+
+			memcpy (hmac.k, salt, salt_len);
+			memcpy (&hmac.k[salt_len], &be, 4);
+			hmac_whirlpool_internal (hmac.k, salt_len + 4, &hmac);
+
+			memcpy (u[lane], hmac.k, WHIRLPOOL_DIGESTSIZE);
+		}
+
+		if (!WHIRLPOOL_pbkdf2 (&hmac.inner_digest_ctx, &hmac.outer_digest_ctx, u, lanes, iterations, pAbortKeyDerivation))
+		{
+			burn (u, sizeof (u));
+			break;
+		}
+
+		if (pAbortKeyDerivation && *pAbortKeyDerivation)
+		{
+			burn (u, sizeof (u));
+			goto cancelled;
+		}
+
+		for (lane = 0; lane < lanes; lane++)
+		{
+			memcpy (dk, u[lane], b + lane < l ? WHIRLPOOL_DIGESTSIZE : r);
+			dk += WHIRLPOOL_DIGESTSIZE;
+		}
+
+		burn (u, sizeof (u));
+	}
+
+	if (b > l)
+		goto done;
+
 	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+	for (; b < l; b++)
 	{
 		derive_u_whirlpool (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
 		// Check if the derivation was aborted
@@ -1026,6 +1273,7 @@ void derive_key_whirlpool (const unsigned char *pwd, int pwd_len, const unsigned
 	if (pAbortKeyDerivation && *pAbortKeyDerivation)
 		goto cancelled;
 	memcpy (dk, hmac.u, r);
+done:
 cancelled:
 	/* Prevent possible leaks. */
 	burn (&hmac, sizeof(hmac));
@@ -1141,7 +1389,10 @@ static void derive_u_streebog (const unsigned char *salt, int salt_len, uint32 i
 	hmac_streebog_internal (k, salt_len + 4, hmac);
 	memcpy (u, k, STREEBOG_DIGESTSIZE);
 
-	/* remaining iterations */
+	/* remaining iterations, reusing the round keys of the constant key block state */
+	if (STREEBOG_pbkdf2 (&hmac->inner_digest_ctx, &hmac->outer_digest_ctx, u, iterations, pAbortKeyDerivation))
+		return;
+
 	for (c = 1; c < iterations; c++)
 	{
 		// CANCELLATION CHECK: Check every 1024 iterations
@@ -456,7 +456,8 @@ enum
 	ERR_RAND_INIT_FAILED					= 34,
 	ERR_CAPI_INIT_FAILED					= 35,
 	ERR_XTS_MASTERKEY_VULNERABLE			= 36,
-	ERR_SYSENC_XTS_MASTERKEY_VULNERABLE			= 37
+	ERR_SYSENC_XTS_MASTERKEY_VULNERABLE			= 37,
+	ERR_VOLUME_REENCRYPTION_INCOMPLETE		= 38
 };
 
 #endif 	// #ifndef TCDEFS_H
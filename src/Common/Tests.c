@@ -1649,7 +1649,7 @@ int __cdecl StreebogHash (unsigned char* input, unsigned long inputLen, unsigned
 
 BOOL test_pkcs5 ()
 {
-	unsigned char dk[144];
+	unsigned char dk[192];
 
 	/* HMAC-SHA-256 tests */
 	if (!test_hmac_sha256())
@@ -1700,6 +1700,11 @@ BOOL test_pkcs5 ()
 	if (memcmp (dk, "\xf2\xa0\x4f\xb2\xd3\xe9\xa5\xd8\x51\x0b\x5c\x06\xdf\x70\x8e\x24\xe9\xc7\xd9\x15\x3d\x22\xcd\xde\xb8\xa6\xdb\xfd\x71\x85\xc6\x99\x32\xc0\xee\x37\x27\xf7\x24\xcf\xea\xa6\xac\x73\xa1\x4c\x4e\x52\x9b\x94\xf3\x54\x06\xfc\x04\x65\xa1\x0a\x24\xfe\xf0\x98\x1d\xa6\x22\x28\xeb\x24\x55\x74\xce\x6a\x3a\x28\xe2\x04\x3a\x59\x13\xec\x3f\xf2\xdb\xcf\x58\xdd\x53\xd9\xf9\x17\xf6\xda\x74\x06\x3c\x0b\x66\xf5\x0f\xf5\x58\xa3\x27\x52\x8c\x5b\x07\x91\xd0\x81\xeb\xb6\xbc\x30\x69\x42\x71\xf2\xd7\x18\x42\xbe\xe8\x02\x93\x70\x66\xad\x35\x65\xbc\xf7\x96\x8e\x64\xf1\xc6\x92\xda\xe0\xdc\x1f\xb5\xf4", 144) != 0)
 		return FALSE;
 
+	/* PKCS-5 test 5 with HMAC-SHA-256 used as the PRF (derives a header key in several blocks at once) */
+	derive_key_sha256 ((unsigned char*)"password", 8, (unsigned char*)"\x12\x34\x56\x78", 4, 5, dk, 192, NULL);
+	if (memcmp (dk, "\xf2\xa0\x4f\xb2\xd3\xe9\xa5\xd8\x51\x0b\x5c\x06\xdf\x70\x8e\x24\xe9\xc7\xd9\x15\x3d\x22\xcd\xde\xb8\xa6\xdb\xfd\x71\x85\xc6\x99\x32\xc0\xee\x37\x27\xf7\x24\xcf\xea\xa6\xac\x73\xa1\x4c\x4e\x52\x9b\x94\xf3\x54\x06\xfc\x04\x65\xa1\x0a\x24\xfe\xf0\x98\x1d\xa6\x22\x28\xeb\x24\x55\x74\xce\x6a\x3a\x28\xe2\x04\x3a\x59\x13\xec\x3f\xf2\xdb\xcf\x58\xdd\x53\xd9\xf9\x17\xf6\xda\x74\x06\x3c\x0b\x66\xf5\x0f\xf5\x58\xa3\x27\x52\x8c\x5b\x07\x91\xd0\x81\xeb\xb6\xbc\x30\x69\x42\x71\xf2\xd7\x18\x42\xbe\xe8\x02\x93\x70\x66\xad\x35\x65\xbc\xf7\x96\x8e\x64\xf1\xc6\x92\xda\xe0\xdc\x1f\xb5\xf4\x15\xe8\xda\x2b\xb8\xd5\x96\x06\x50\x0e\xdb\xd7\xbf\x5d\x14\x7e\x16\x3c\xbd\x69\x29\x11\x45\x25\xaa\xc1\x7c\x6f\x0e\xcb\xe6\x86\x83\x77\xf0\xf4\x66\xbb\x34\x82\x3a\x84\x88\xde\xda\x8e\xce\x85", 192) != 0)
+		return FALSE;
+
 	/* PKCS-5 test 1 with HMAC-SHA-512 used as the PRF */
 	derive_key_sha512 ((unsigned char*)"password", 8, (unsigned char*)"\x12\x34\x56\x78", 4, 5, dk, 4, NULL);
 	if (memcmp (dk, "\x13\x64\xae\xf8", 4) != 0)
@@ -1711,6 +1716,11 @@ BOOL test_pkcs5 ()
 	if (memcmp (dk, "\x13\x64\xae\xf8\x0d\xf5\x57\x6c\x30\xd5\x71\x4c\xa7\x75\x3f\xfd\x00\xe5\x25\x8b\x39\xc7\x44\x7f\xce\x23\x3d\x08\x75\xe0\x2f\x48\xd6\x30\xd7\x00\xb6\x24\xdb\xe0\x5a\xd7\x47\xef\x52\xca\xa6\x34\x83\x47\xe5\xcb\xe9\x87\xf1\x20\x59\x6a\xe6\xa9\xcf\x51\x78\xc6\xb6\x23\xa6\x74\x0d\xe8\x91\xbe\x1a\xd0\x28\xcc\xce\x16\x98\x9a\xbe\xfb\xdc\x78\xc9\xe1\x7d\x72\x67\xce\xe1\x61\x56\x5f\x96\x68\xe6\xe1\xdd\xf4\xbf\x1b\x80\xe0\x19\x1c\xf4\xc4\xd3\xdd\xd5\xd5\x57\x2d\x83\xc7\xa3\x37\x87\xf4\x4e\xe0\xf6\xd8\x6d\x65\xdc\xa0\x52\xa3\x13\xbe\x81\xfc\x30\xbe\x7d\x69\x58\x34\xb6\xdd\x41\xc6", 144) != 0)
 		return FALSE;
 
+	/* PKCS-5 test 3 with HMAC-SHA-512 used as the PRF (derives a header key in several blocks at once) */
+	derive_key_sha512 ((unsigned char*)"password", 8, (unsigned char*)"\x12\x34\x56\x78", 4, 5, dk, 192, NULL);
+	if (memcmp (dk, "\x13\x64\xae\xf8\x0d\xf5\x57\x6c\x30\xd5\x71\x4c\xa7\x75\x3f\xfd\x00\xe5\x25\x8b\x39\xc7\x44\x7f\xce\x23\x3d\x08\x75\xe0\x2f\x48\xd6\x30\xd7\x00\xb6\x24\xdb\xe0\x5a\xd7\x47\xef\x52\xca\xa6\x34\x83\x47\xe5\xcb\xe9\x87\xf1\x20\x59\x6a\xe6\xa9\xcf\x51\x78\xc6\xb6\x23\xa6\x74\x0d\xe8\x91\xbe\x1a\xd0\x28\xcc\xce\x16\x98\x9a\xbe\xfb\xdc\x78\xc9\xe1\x7d\x72\x67\xce\xe1\x61\x56\x5f\x96\x68\xe6\xe1\xdd\xf4\xbf\x1b\x80\xe0\x19\x1c\xf4\xc4\xd3\xdd\xd5\xd5\x57\x2d\x83\xc7\xa3\x37\x87\xf4\x4e\xe0\xf6\xd8\x6d\x65\xdc\xa0\x52\xa3\x13\xbe\x81\xfc\x30\xbe\x7d\x69\x58\x34\xb6\xdd\x41\xc6\x21\x50\xf5\x60\x44\xf9\x87\x69\xfd\x75\x75\xcb\x10\xe5\xe0\xfd\xf0\x7d\x3f\x79\xe2\xa0\x68\xb5\xbf\xd1\x76\x91\xc8\x68\x67\xd9\x01\x00\x4c\x1b\xfc\x1a\xd3\x39\x7b\x9d\x3d\x88\x71\xfc\x55\x1a", 192) != 0)
+		return FALSE;
+
 #ifndef WOLFCRYPT_BACKEND
 	/* PKCS-5 test 1 with HMAC-BLAKE2s used as the PRF */
 	derive_key_blake2s ((unsigned char*)"password", 8, (unsigned char*)"\x12\x34\x56\x78", 4, 5, dk, 4, NULL);
@@ -1722,6 +1732,11 @@ BOOL test_pkcs5 ()
 	if (memcmp (dk, "\x8d\x51\xfa\x31\x46\x25\x37\x67\xa3\x29\x6b\x3c\x6b\xc1\x5d\xb2\xee\xe1\x6c\x28\x00\x26\xea\x08\x65\x9c\x12\xf1\x07\xde\x0d\xb9\x9b\x4f\x39\xfa\xc6\x80\x26\xb1\x8f\x8e\x48\x89\x85\x2d\x24\x2d", 48) != 0)
 		return FALSE;
 
+	/* PKCS-5 test 3 with HMAC-BLAKE2s used as the PRF (derives a header key in several blocks at once) */
+	derive_key_blake2s ((unsigned char*)"password", 8, (unsigned char*)"\x12\x34\x56\x78", 4, 5, dk, 192, NULL);
+	if (memcmp (dk, "\x8d\x51\xfa\x31\x46\x25\x37\x67\xa3\x29\x6b\x3c\x6b\xc1\x5d\xb2\xee\xe1\x6c\x28\x00\x26\xea\x08\x65\x9c\x12\xf1\x07\xde\x0d\xb9\x9b\x4f\x39\xfa\xc6\x80\x26\xb1\x8f\x8e\x48\x89\x85\x2d\x24\x2d\xbd\x63\x72\x4a\x6c\xc6\x19\x7e\xc3\x1a\x5d\xf7\x61\xdc\x0d\xc8\x16\x3d\xd1\x1b\x02\x9b\x84\xd1\xc1\xee\x73\xf7\x1a\x36\x82\x50\xd0\xe7\x57\x16\x2b\x27\x00\x97\xee\x6e\xa1\x55\x44\x55\x19\x4f\x1f\xea\xe4\x48\x30\xfd\xaa\xa1\xe6\x9e\x1e\x3c\x5c\x43\x56\x10\x29\x4f\x72\x57\x3a\x14\x15\x77\xa6\x0a\x56\xd2\x7b\xfa\x86\x22\x20\x65\xd8\xc2\x64\x24\x68\x95\xc5\x52\x0d\x22\x33\x3c\xa6\x7c\x89\x17\xde\x0b\xc9\x62\xaf\x52\x2b\xda\x14\x24\xb0\x3d\xe1\x2b\xea\x23\x3c\xd8\xca\x8a\xe3\x7a\xa7\x6f\xdd\x4a\x2c\x31\x46\xa2\xeb\x3e\x2a\x07\xf2\x08\x21\x42\xb3\xde\x03\x53\x36\xb5\xff\x24", 192) != 0)
+		return FALSE;
+
 	/* PKCS-5 test 1 with HMAC-Whirlpool used as the PRF */
 	derive_key_whirlpool ((unsigned char*)"password", 8, (unsigned char*)"\x12\x34\x56\x78", 4, 5, dk, 4, NULL);
 	if (memcmp (dk, "\x50\x7c\x36\x6f", 4) != 0)
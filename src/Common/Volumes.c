@@ -505,6 +505,13 @@ KeyReady:	;
 
 				// Now we have the correct password, cipher, hash algorithm, and volume type
 
+				// Re-encryption of the data area is not supported
+				if (GetHeaderField32 (header, TC_HEADER_OFFSET_FLAGS) & TC_HEADER_FLAG_REENCRYPTION)
+				{
+					status = ERR_VOLUME_REENCRYPTION_INCOMPLETE;
+					goto err;
+				}
+
 				// Check the version required to handle this volume
 				if (cryptoInfo->RequiredProgramVersion > VERSION_NUM)
 				{
@@ -31,6 +31,11 @@ extern "C" {
 // specifies the minimum program version required to mount the volume
 #define TC_VOLUME_MIN_REQUIRED_PROGRAM_VERSION	0x010b
 
+// Version number written to both volume headers while the data area is being re-encrypted;
+// exceeds the version of any release to prevent the volume from being mounted by implementations
+// unaware of the re-encryption
+#define TC_VOLUME_REENCRYPTION_REQUIRED_PROGRAM_VERSION	0xffff
+
 // Version number written (encrypted) to the key data area of an encrypted system partition/drive;
 // specifies the minimum program version required to decrypt the system partition/drive
 #define TC_SYSENC_KEYSCOPE_MIN_REQ_PROG_VERSION	0x010b
@@ -133,6 +138,7 @@ extern "C" {
 // Volume header flags
 #define TC_HEADER_FLAG_ENCRYPTED_SYSTEM			0x1
 #define TC_HEADER_FLAG_NONSYS_INPLACE_ENC		0x2		// The volume has been created (or is being encrypted/decrypted) using non-system in-place encryption
+#define TC_HEADER_FLAG_REENCRYPTION				0x4		// The data area is being re-encrypted with the master key of the primary header
 
 
 #ifndef TC_HEADER_Volume_VolumeHeader
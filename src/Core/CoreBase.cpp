@@ -13,7 +13,9 @@
 #include <set>
 
 #include "CoreBase.h"
+#include "FilesystemScanner.h"
 #include "RandomNumberGenerator.h"
+#include "Volume/EncryptionThreadPool.h"
 #include "Volume/Volume.h"
 
 namespace VeraCrypt
@@ -43,6 +45,9 @@ namespace VeraCrypt
 			newPkcs5Kdf = openVolume->GetPkcs5Kdf();
 		}
 
+		if (openVolume->IsReEncryptionInProgress())
+			throw VolumeEncryptionNotCompleted (SRC_POS);
+
 		if ((openVolume->GetHeader()->GetFlags() & TC_HEADER_FLAG_ENCRYPTED_SYSTEM) != 0
 			&& openVolume->GetType() == VolumeType::Hidden
 			&& openVolume->GetPath().IsDevice())
@@ -52,31 +57,36 @@ namespace VeraCrypt
 
 		RandomNumberGenerator::SetHash (newPkcs5Kdf->GetHash());
 
-		SecureBuffer newSalt (openVolume->GetSaltSize());
-		SecureBuffer newHeaderKey (VolumeHeader::GetLargestSerializedKeySize());
+		if (wipeCount < 1)
+			return;
 
-		shared_ptr <VolumePassword> password (Keyfile::ApplyListToPassword (newKeyfiles, newPassword, emvSupportEnabled));
+		size_t saltSize = openVolume->GetSaltSize();
+		size_t headerKeySize = VolumeHeader::GetLargestSerializedKeySize();
+		size_t headerCount = openVolume->GetLayout()->HasBackupHeader() ? 2 : 1;
 
-		bool backupHeader = false;
-		while (true)
+		// The header keys of all passes are independent of each other and are derived concurrently
+		// before the headers are written in order
+		SecureBuffer newSalts (saltSize * headerCount * wipeCount);
+		SecureBuffer newHeaderKeys (headerKeySize * headerCount * wipeCount);
+
+		for (size_t pass = 0; pass < headerCount * wipeCount; pass++)
 		{
-			for (int i = 1; i <= wipeCount; i++)
-			{
-				if (i == wipeCount)
-					RandomNumberGenerator::GetData (newSalt);
-				else
-					RandomNumberGenerator::GetDataFast (newSalt);
+			if ((pass + 1) % wipeCount == 0)
+				RandomNumberGenerator::GetData (newSalts.GetRange (pass * saltSize, saltSize));
+			else
+				RandomNumberGenerator::GetBulkData (newSalts.GetRange (pass * saltSize, saltSize));
+		}
 
-				newPkcs5Kdf->DeriveKey (newHeaderKey, *password, newPim, newSalt);
+		shared_ptr <VolumePassword> password (Keyfile::ApplyListToPassword (newKeyfiles, newPassword, emvSupportEnabled));
 
-				openVolume->ReEncryptHeader (backupHeader, newSalt, newHeaderKey, newPkcs5Kdf);
-				openVolume->GetFile()->Flush();
-			}
+		EncryptionThreadPool::DeriveKeys (*newPkcs5Kdf, *password, newPim, newSalts, saltSize, newHeaderKeys);
 
-			if (!openVolume->GetLayout()->HasBackupHeader() || backupHeader)
-				break;
+		for (size_t pass = 0; pass < headerCount * wipeCount; pass++)
+		{
+			bool backupHeader = (pass >= (size_t) wipeCount);
 
-			backupHeader = true;
+			openVolume->ReEncryptHeader (backupHeader, newSalts.GetRange (pass * saltSize, saltSize), newHeaderKeys.GetRange (pass * headerKeySize, headerKeySize), newPkcs5Kdf);
+			openVolume->GetFile()->Flush();
 		}
 	}
 
@@ -142,78 +152,7 @@ namespace VeraCrypt
 
 	uint64 CoreBase::GetMaxHiddenVolumeSize (shared_ptr <Volume> outerVolume) const
 	{
-		uint32 sectorSize = outerVolume->GetSectorSize();
-
-		SecureBuffer bootSectorBuffer (sectorSize);
-		outerVolume->ReadSectors (bootSectorBuffer, 0);
-
-		int fatType;
-		uint8 *bootSector = bootSectorBuffer.Ptr();
-
-		if (memcmp (bootSector + 54, "FAT12", 5) == 0)
-			fatType = 12;
-		else if (memcmp (bootSector + 54, "FAT16", 5) == 0)
-			fatType = 16;
-		else if (memcmp (bootSector + 82, "FAT32", 5) == 0)
-			fatType = 32;
-		else
-			throw ParameterIncorrect (SRC_POS);
-
-		uint32 clusterSize = bootSector[13] * sectorSize;
-		uint32 reservedSectorCount = Endian::Little (*(uint16 *) (bootSector + 14));
-		uint32 fatCount = bootSector[16];
-
-		uint64 fatSectorCount;
-		if (fatType == 32)
-			fatSectorCount = Endian::Little (*(uint32 *) (bootSector + 36));
-		else
-			fatSectorCount = Endian::Little (*(uint16 *) (bootSector + 22));
-		uint64 fatSize = fatSectorCount * sectorSize;
-
-		uint64 fatStartOffset = reservedSectorCount * sectorSize;
-		uint64 dataAreaOffset = reservedSectorCount * sectorSize + fatSize * fatCount;
-
-		if (fatType < 32)
-			dataAreaOffset += Endian::Little (*(uint16 *) (bootSector + 17)) * 32;
-
-		SecureBuffer sector (sectorSize);
-
-		// Find last used cluster
-		for (uint64 readOffset = fatStartOffset + fatSize - sectorSize;
-			readOffset >= fatStartOffset;
-			readOffset -= sectorSize)
-		{
-			outerVolume->ReadSectors (sector, readOffset);
-
-			for (int offset = sectorSize - 4; offset >= 0; offset -= 4)
-			{
-				if (*(uint32 *) (sector.Ptr() + offset))
-				{
-					uint64 clusterNumber = readOffset - fatStartOffset + offset;
-
-					if (fatType == 12)
-						clusterNumber = (clusterNumber * 8) / 12;
-					else if (fatType == 16)
-						clusterNumber /= 2;
-					else if (fatType == 32)
-						clusterNumber /= 4;
-
-					uint64 maxSize = outerVolume->GetSize() - dataAreaOffset;
-
-					// Some FAT entries may span over sector boundaries
-					if (maxSize >= clusterSize)
-						maxSize -= clusterSize;
-
-					uint64 clusterOffset = clusterNumber * clusterSize;
-					if (maxSize < clusterOffset)
-						return 0;
-
-					return maxSize - clusterOffset;
-				}
-			}
-		}
-
-		return 0;
+		return FilesystemScanner::GetFreeSpaceAtEnd (outerVolume);
 	}
 
 	shared_ptr <VolumeInfo> CoreBase::GetMountedVolume (const VolumePath &volumePath) const
@@ -259,10 +198,41 @@ namespace VeraCrypt
 			return false;
 	}
 
-	shared_ptr <Volume> CoreBase::OpenVolume (shared_ptr <VolumePath> volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr<Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr<Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope) const
+	BatchMountResultList CoreBase::MountVolumes (const MountOptionsList &optionsList, VolumeSlotNumber firstSlotNumber)
+	{
+		BatchMountResultList results;
+
+		foreach (shared_ptr <MountOptions> options, optionsList)
+		{
+			BatchMountResult result;
+			result.Options = options;
+
+			try
+			{
+				if (options->SlotNumber < GetFirstSlotNumber() && (!options->MountPoint || options->MountPoint->IsEmpty()))
+					options->SlotNumber = GetFirstFreeSlotNumber (firstSlotNumber);
+
+				result.MountedVolume = MountVolume (*options);
+			}
+			catch (Exception &e)
+			{
+				result.Error.reset (e.CloneNew());
+			}
+			catch (exception &e)
+			{
+				result.Error.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+			}
+
+			results.push_back (result);
+		}
+
+		return results;
+	}
+
+	shared_ptr <Volume> CoreBase::OpenVolume (shared_ptr <VolumePath> volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr<Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr<Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope, const VolumeTrialHint &trialHint) const
 	{
 		make_shared_auto (Volume, volume);
-		volume->Open (*volumePath, preserveTimestamps, password, pim, kdf, keyfiles, emvSupportEnabled, protection, protectionPassword, protectionPim, protectionKdf, protectionKeyfiles, sharedAccessAllowed, volumeType, useBackupHeaders, partitionInSystemEncryptionScope);
+		volume->Open (*volumePath, preserveTimestamps, password, pim, kdf, keyfiles, emvSupportEnabled, protection, protectionPassword, protectionPim, protectionKdf, protectionKeyfiles, sharedAccessAllowed, volumeType, useBackupHeaders, partitionInSystemEncryptionScope, trialHint);
 		return volume;
 	}
 
@@ -268,7 +268,7 @@ namespace VeraCrypt
 		sector[508+0] = 0x00;
 	}
 
-	void FatFormatter::Format (WriteSectorCallback &writeSector, uint64 deviceSize, uint32 clusterSize, uint32 sectorSize)
+	void FatFormatter::Format (WriteRegionCallback &writeRegion, uint64 deviceSize, uint32 clusterSize, uint32 sectorSize)
 	{
 		fatparams fatParams;
 
@@ -286,101 +286,82 @@ namespace VeraCrypt
 		GetFatParams (&fatParams);
 		fatparams *ft = &fatParams;
 
-		SecureBuffer sector (ft->sector_size);
-		uint32 sectorNumber = 0;
-
-		/* Write the data area */
-
-		sector.Zero();
-
 		uint32 volumeId;
 		RandomNumberGenerator::GetDataFast (BufferPtr ((uint8 *) &volumeId, sizeof (volumeId)));
 
-		PutBoot (ft, (uint8 *) sector, volumeId);
-		writeSector (sector); ++sectorNumber;
+		/* boot area */
+		SecureBuffer bootArea ((size_t) ft->reserved * ft->sector_size);
+		bootArea.Zero();
+
+		PutBoot (ft, bootArea.Ptr(), volumeId);
 
 		/* fat32 boot area */
 		if (ft->size_fat == 32)
 		{
 			/* fsinfo */
-			PutFSInfo((uint8 *) sector, ft);
-			writeSector (sector); ++sectorNumber;
+			PutFSInfo (bootArea.Ptr() + ft->sector_size, ft);
 
 			/* reserved */
-			while (sectorNumber < 6)
+			for (uint32 n = 2; n < 6; n++)
 			{
-				sector.Zero();
+				uint8 *sector = bootArea.Ptr() + n * ft->sector_size;
 				sector[508+3] = 0xaa; /* TrailSig */
 				sector[508+2] = 0x55;
-				writeSector (sector); ++sectorNumber;
 			}
 
 			/* bootsector backup */
-			sector.Zero();
-			PutBoot (ft, (uint8 *) sector, volumeId);
-			writeSector (sector); ++sectorNumber;
-
-			PutFSInfo((uint8 *) sector, ft);
-			writeSector (sector); ++sectorNumber;
+			PutBoot (ft, bootArea.Ptr() + 6 * ft->sector_size, volumeId);
+			PutFSInfo (bootArea.Ptr() + 7 * ft->sector_size, ft);
 		}
 
-		/* reserved */
-		while (sectorNumber < (uint32)ft->reserved)
-		{
-			sector.Zero();
-			writeSector (sector); ++sectorNumber;
-		}
+		if (!writeRegion.WriteData (bootArea))
+			return;
 
 		/* write fat */
+		SecureBuffer sector (ft->sector_size);
+
 		for (uint32 x = 1; x <= ft->fats; x++)
 		{
-			for (uint32 n = 0; n < ft->fat_length; n++)
+			sector.Zero();
+
+			uint8 fat_sig[12];
+			if (ft->size_fat == 32)
 			{
-				sector.Zero();
-
-				if (n == 0)
-				{
-					uint8 fat_sig[12];
-					if (ft->size_fat == 32)
-					{
-						fat_sig[0] = (uint8) ft->media;
-						fat_sig[1] = fat_sig[2] = 0xff;
-						fat_sig[3] = 0x0f;
-						fat_sig[4] = fat_sig[5] = fat_sig[6] = 0xff;
-						fat_sig[7] = 0x0f;
-						fat_sig[8] = fat_sig[9] = fat_sig[10] = 0xff;
-						fat_sig[11] = 0x0f;
-						memcpy (sector, fat_sig, 12);
-					}
-					else if (ft->size_fat == 16)
-					{
-						fat_sig[0] = (uint8) ft->media;
-						fat_sig[1] = 0xff;
-						fat_sig[2] = 0xff;
-						fat_sig[3] = 0xff;
-						memcpy (sector, fat_sig, 4);
-					}
-					else if (ft->size_fat == 12)
-					{
-						fat_sig[0] = (uint8) ft->media;
-						fat_sig[1] = 0xff;
-						fat_sig[2] = 0xff;
-						fat_sig[3] = 0x00;
-						memcpy (sector, fat_sig, 4);
-					}
-				}
-
-				if (!writeSector (sector))
-					return;
+				fat_sig[0] = (uint8) ft->media;
+				fat_sig[1] = fat_sig[2] = 0xff;
+				fat_sig[3] = 0x0f;
+				fat_sig[4] = fat_sig[5] = fat_sig[6] = 0xff;
+				fat_sig[7] = 0x0f;
+				fat_sig[8] = fat_sig[9] = fat_sig[10] = 0xff;
+				fat_sig[11] = 0x0f;
+				memcpy (sector, fat_sig, 12);
+			}
+			else if (ft->size_fat == 16)
+			{
+				fat_sig[0] = (uint8) ft->media;
+				fat_sig[1] = 0xff;
+				fat_sig[2] = 0xff;
+				fat_sig[3] = 0xff;
+				memcpy (sector, fat_sig, 4);
+			}
+			else if (ft->size_fat == 12)
+			{
+				fat_sig[0] = (uint8) ft->media;
+				fat_sig[1] = 0xff;
+				fat_sig[2] = 0xff;
+				fat_sig[3] = 0x00;
+				memcpy (sector, fat_sig, 4);
 			}
-		}
 
-		/* write rootdir */
-		for (uint32 x = 0; x < ft->size_root_dir / ft->sector_size; x++)
-		{
-			sector.Zero();
-			if (!writeSector (sector))
+			if (!writeRegion.WriteData (sector))
+				return;
+
+			// Remaining FAT sectors are empty
+			if (!writeRegion.WriteZeros ((uint64) (ft->fat_length - 1) * ft->sector_size))
 				return;
 		}
+
+		/* write rootdir */
+		writeRegion.WriteZeros ((uint64) (ft->size_root_dir / ft->sector_size) * ft->sector_size);
 	}
 }
@@ -20,13 +20,16 @@ namespace VeraCrypt
 	class FatFormatter
 	{
 	public:
-		struct WriteSectorCallback
+		// The filesystem is written sequentially as regions of explicit content and runs of zeroed sectors.
+		// Writing is stopped if false is returned.
+		struct WriteRegionCallback
 		{
-			virtual ~WriteSectorCallback () { }
-			virtual bool operator() (const BufferPtr &sector) = 0;
+			virtual ~WriteRegionCallback () { }
+			virtual bool WriteData (const ConstBufferPtr &data) = 0;
+			virtual bool WriteZeros (uint64 length) = 0;
 		};
 
-		static void Format (WriteSectorCallback &writeSector, uint64 deviceSize, uint32 clusterSize, uint32 sectorSize);
+		static void Format (WriteRegionCallback &writeRegion, uint64 deviceSize, uint32 clusterSize, uint32 sectorSize);
 	};
 }
 
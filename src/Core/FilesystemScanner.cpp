@@ -0,0 +1,657 @@
+/*
+ Copyright (c) 2013-2025 AM Crypto. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "FilesystemScanner.h"
+
+namespace VeraCrypt
+{
+	bool FilesystemScanner::FindLastSetBit (const ConstBufferPtr &bitmap, uint64 bitCount, uint64 &bitIndex)
+	{
+		size_t byteCount = (size_t) (bitCount / 8);
+		size_t lastByteIndex = byteCount;
+		uint8 lastByte = 0;
+
+		// Bits following the last valid one may be set (ext4 pads the bitmap of the last group)
+		if (bitCount % 8 != 0)
+			lastByte = bitmap.GetRange (byteCount, 1).Get()[0] & ((1 << (bitCount % 8)) - 1);
+
+		if (!lastByte)
+		{
+			lastByteIndex = GetDataEnd (bitmap.GetRange (0, byteCount));
+			if (lastByteIndex == 0)
+				return false;
+
+			lastByte = bitmap.Get()[--lastByteIndex];
+		}
+
+		int bit = 7;
+		while (!(lastByte & (1 << bit)))
+			--bit;
+
+		bitIndex = (uint64) lastByteIndex * 8 + bit;
+		return true;
+	}
+
+	bool FilesystemScanner::FindLastSetBit (shared_ptr <Volume> volume, const vector <Extent> &bitmap, uint64 bitCount, uint64 &bitIndex)
+	{
+		uint64 byteCount = (bitCount + 7) / 8;
+
+		vector <uint64> extentOffsets;
+		uint64 bitmapOffset = 0;
+
+		foreach (const Extent &extent, bitmap)
+		{
+			extentOffsets.push_back (bitmapOffset);
+			bitmapOffset += extent.Length;
+		}
+
+		SecureBuffer chunk (ReadChunkSize);
+
+		for (size_t i = bitmap.size(); i > 0; --i)
+		{
+			const Extent &extent = bitmap[i - 1];
+			uint64 extentOffset = extentOffsets[i - 1];
+
+			if (extent.Sparse || extentOffset >= byteCount)
+				continue;
+
+			uint64 extentEnd = min (extentOffset + extent.Length, byteCount);
+
+			// Chunks are aligned with the start of the extent
+			uint64 chunkOffset = extentOffset + ((extentEnd - extentOffset - 1) / ReadChunkSize) * ReadChunkSize;
+			uint64 chunkEnd = extentEnd;
+
+			while (true)
+			{
+				BufferPtr chunkData = chunk.GetRange (0, (size_t) (chunkEnd - chunkOffset));
+				ReadData (volume, chunkData, extent.Start + chunkOffset - extentOffset);
+
+				uint64 chunkBitIndex;
+				if (FindLastSetBit (chunkData, min (bitCount - chunkOffset * 8, (uint64) chunkData.Size() * 8), chunkBitIndex))
+				{
+					bitIndex = chunkOffset * 8 + chunkBitIndex;
+					return true;
+				}
+
+				if (chunkOffset == extentOffset)
+					break;
+
+				chunkEnd = chunkOffset;
+				chunkOffset -= ReadChunkSize;
+			}
+		}
+
+		return false;
+	}
+
+	size_t FilesystemScanner::GetDataEnd (const ConstBufferPtr &data)
+	{
+		const uint8 *bytes = data.Get();
+		size_t end = data.Size();
+
+		while (end % sizeof (uint64) != 0)
+		{
+			if (bytes[end - 1])
+				return end;
+			--end;
+		}
+
+		// Blocks of 64 bytes are tested by a single comparison, which allows the compiler to vectorize the loop
+		while (end >= 64)
+		{
+			const uint64 *words = (const uint64 *) (bytes + end - 64);
+
+			if ((words[0] | words[1] | words[2] | words[3] | words[4] | words[5] | words[6] | words[7]) != 0)
+				break;
+
+			end -= 64;
+		}
+
+		while (end > 0 && !bytes[end - 1])
+			--end;
+
+		return end;
+	}
+
+	vector <FilesystemScanner::Extent> FilesystemScanner::GetExFatClusterChain (shared_ptr <Volume> volume, const ExFatLayout &layout, uint32 firstCluster, uint64 length)
+	{
+		// The whole chain is returned if length is zero
+		vector <Extent> extents;
+		uint64 chainLength = 0;
+		uint32 cluster = firstCluster;
+
+		uint64 fatSize = (layout.ClusterCount + 2) * sizeof (uint32);
+		SecureBuffer fatChunk (ReadChunkSize);
+		uint64 fatChunkOffset = 0;
+		size_t fatChunkSize = 0;
+
+		for (uint64 i = 0; i < layout.ClusterCount; ++i)
+		{
+			if (cluster < 2 || cluster - 2 >= layout.ClusterCount)
+				throw ParameterIncorrect (SRC_POS);
+
+			uint64 clusterOffset = layout.ClusterHeapOffset + (uint64) (cluster - 2) * layout.ClusterSize;
+
+			if (!extents.empty() && extents.back().Start + extents.back().Length == clusterOffset)
+				extents.back().Length += layout.ClusterSize;
+			else
+				extents.push_back (Extent (clusterOffset, layout.ClusterSize));
+
+			chainLength += layout.ClusterSize;
+			if (length != 0 && chainLength >= length)
+				return extents;
+
+			// Next cluster
+			uint64 entryOffset = (uint64) cluster * sizeof (uint32);
+
+			if (entryOffset < fatChunkOffset || entryOffset + sizeof (uint32) > fatChunkOffset + fatChunkSize)
+			{
+				fatChunkOffset = entryOffset - entryOffset % ReadChunkSize;
+				fatChunkSize = (size_t) min ((uint64) ReadChunkSize, fatSize - fatChunkOffset);
+				ReadData (volume, fatChunk.GetRange (0, fatChunkSize), layout.FatOffset + fatChunkOffset);
+			}
+
+			uint32 nextCluster = Endian::Little (*(uint32 *) (fatChunk.Ptr() + entryOffset - fatChunkOffset));
+
+			if (nextCluster == 0xffffFFFF)
+			{
+				if (length != 0)
+					throw ParameterIncorrect (SRC_POS);
+
+				return extents;
+			}
+
+			// Contiguous files may not be recorded in the FAT
+			cluster = (nextCluster == 0 ? cluster + 1 : nextCluster);
+		}
+
+		throw ParameterIncorrect (SRC_POS);
+	}
+
+	uint64 FilesystemScanner::GetFreeSpaceAtEnd (shared_ptr <Volume> volume)
+	{
+		SecureBuffer header (2 * 1024);
+		ReadData (volume, header, 0);
+
+		const uint8 *bootSector = header.Ptr();
+
+		if (memcmp (bootSector + 3, "EXFAT   ", 8) == 0)
+			return GetFreeSpaceAtEndExFat (volume, header);
+
+		if (memcmp (bootSector + 3, "NTFS    ", 8) == 0)
+			return GetFreeSpaceAtEndNtfs (volume, header);
+
+		if (memcmp (bootSector + 54, "FAT12", 5) == 0)
+			return GetFreeSpaceAtEndFat (volume, header, 12);
+
+		if (memcmp (bootSector + 54, "FAT16", 5) == 0)
+			return GetFreeSpaceAtEndFat (volume, header, 16);
+
+		if (memcmp (bootSector + 82, "FAT32", 5) == 0)
+			return GetFreeSpaceAtEndFat (volume, header, 32);
+
+		// ext2/3/4 superblock is stored at offset 1024
+		if (Endian::Little (*(uint16 *) (bootSector + 1024 + 56)) == 0xEF53)
+			return GetFreeSpaceAtEndExt (volume, header.GetRange (1024, 1024));
+
+		throw ParameterIncorrect (SRC_POS);
+	}
+
+	uint64 FilesystemScanner::GetFreeSpaceAtEndExFat (shared_ptr <Volume> volume, const ConstBufferPtr &bootSector)
+	{
+		const uint8 *boot = bootSector.Get();
+
+		uint32 bytesPerSectorShift = boot[108];
+		uint32 sectorsPerClusterShift = boot[109];
+
+		if (bytesPerSectorShift < 9 || bytesPerSectorShift > 12 || bytesPerSectorShift + sectorsPerClusterShift > 25)
+			throw ParameterIncorrect (SRC_POS);
+
+		uint64 bytesPerSector = 1ULL << bytesPerSectorShift;
+
+		ExFatLayout layout;
+		layout.ClusterSize = bytesPerSector << sectorsPerClusterShift;
+		layout.FatOffset = Endian::Little (*(uint32 *) (boot + 80)) * bytesPerSector;
+		layout.ClusterHeapOffset = Endian::Little (*(uint32 *) (boot + 88)) * bytesPerSector;
+		layout.ClusterCount = Endian::Little (*(uint32 *) (boot + 92));
+
+		uint32 rootDirectoryCluster = Endian::Little (*(uint32 *) (boot + 96));
+		uint64 filesystemSize = min (Endian::Little (*(uint64 *) (boot + 72)) * bytesPerSector, volume->GetSize());
+
+		// Find the allocation bitmap in the root directory
+		uint32 bitmapCluster = 0;
+		uint64 bitmapSize = 0;
+
+		vector <Extent> rootDirectory = GetExFatClusterChain (volume, layout, rootDirectoryCluster, 0);
+		SecureBuffer directoryData (layout.ClusterSize);
+
+		foreach (const Extent &extent, rootDirectory)
+		{
+			for (uint64 offset = 0; offset < extent.Length && bitmapCluster == 0; offset += layout.ClusterSize)
+			{
+				ReadData (volume, directoryData, extent.Start + offset);
+
+				for (size_t entry = 0; entry < directoryData.Size(); entry += 32)
+				{
+					const uint8 *directoryEntry = directoryData.Ptr() + entry;
+
+					// End of directory
+					if (directoryEntry[0] == 0)
+						throw ParameterIncorrect (SRC_POS);
+
+					// Allocation bitmap of the first FAT
+					if (directoryEntry[0] == 0x81 && (directoryEntry[1] & 1) == 0)
+					{
+						bitmapCluster = Endian::Little (*(uint32 *) (directoryEntry + 20));
+						bitmapSize = Endian::Little (*(uint64 *) (directoryEntry + 24));
+						break;
+					}
+				}
+			}
+
+			if (bitmapCluster != 0)
+				break;
+		}
+
+		if (bitmapCluster == 0 || bitmapSize == 0)
+			throw ParameterIncorrect (SRC_POS);
+
+		// Bit N of the allocation bitmap corresponds to cluster N + 2
+		uint64 lastUsedCluster;
+		uint64 usedEnd = layout.ClusterHeapOffset;
+
+		if (FindLastSetBit (volume, GetExFatClusterChain (volume, layout, bitmapCluster, bitmapSize), min (layout.ClusterCount, bitmapSize * 8), lastUsedCluster))
+			usedEnd += (lastUsedCluster + 1) * layout.ClusterSize;
+
+		if (usedEnd >= filesystemSize)
+			return 0;
+
+		return filesystemSize - usedEnd;
+	}
+
+	uint64 FilesystemScanner::GetFreeSpaceAtEndExt (shared_ptr <Volume> volume, const ConstBufferPtr &superblock)
+	{
+		const uint8 *sb = superblock.Get();
+
+		uint32 incompatFeatures = Endian::Little (*(uint32 *) (sb + 96));
+		uint32 roCompatFeatures = Endian::Little (*(uint32 *) (sb + 100));
+		bool is64bit = (incompatFeatures & 0x80) != 0;
+		bool metaBlockGroups = (incompatFeatures & 0x10) != 0;
+		bool groupChecksums = (roCompatFeatures & (0x10 | 0x400)) != 0;
+
+		uint32 logBlockSize = Endian::Little (*(uint32 *) (sb + 24));
+		if (logBlockSize > 6)
+			throw ParameterIncorrect (SRC_POS);
+
+		uint64 blockSize = 1024ULL << logBlockSize;
+		uint64 blockCount = Endian::Little (*(uint32 *) (sb + 4));
+		if (is64bit)
+			blockCount |= (uint64) Endian::Little (*(uint32 *) (sb + 336)) << 32;
+
+		uint64 firstDataBlock = Endian::Little (*(uint32 *) (sb + 20));
+		uint64 blocksPerGroup = Endian::Little (*(uint32 *) (sb + 32));
+		uint64 inodesPerGroup = Endian::Little (*(uint32 *) (sb + 40));
+		uint64 inodeSize = Endian::Little (*(uint32 *) (sb + 76)) > 0 ? Endian::Little (*(uint16 *) (sb + 88)) : 128;
+		uint64 reservedGdtBlocks = Endian::Little (*(uint16 *) (sb + 206));
+		uint64 descriptorSize = is64bit ? Endian::Little (*(uint16 *) (sb + 254)) : 32;
+		uint64 firstMetaBlockGroup = Endian::Little (*(uint32 *) (sb + 260));
+
+		if (blocksPerGroup == 0 || blocksPerGroup > blockSize * 8 || blockCount <= firstDataBlock
+			|| descriptorSize < 32 || descriptorSize > blockSize || blockSize % descriptorSize != 0)
+		{
+			throw ParameterIncorrect (SRC_POS);
+		}
+
+		uint64 filesystemSize = min (blockCount * blockSize, volume->GetSize());
+		uint64 groupCount = (blockCount - firstDataBlock + blocksPerGroup - 1) / blocksPerGroup;
+		uint64 descriptorsPerBlock = blockSize / descriptorSize;
+		uint64 gdtBlocks = (groupCount + descriptorsPerBlock - 1) / descriptorsPerBlock;
+		uint64 inodeTableBlocks = (inodesPerGroup * inodeSize + blockSize - 1) / blockSize;
+
+		SecureBuffer descriptorBlock ((size_t) blockSize);
+		SecureBuffer bitmaps (ReadChunkSize);
+
+		// Block groups are scanned from the last one. Group descriptors are read a block at a time.
+		for (uint64 descriptorBlockIndex = gdtBlocks; descriptorBlockIndex > 0; )
+		{
+			--descriptorBlockIndex;
+
+			uint64 descriptorBlockNumber;
+			if (metaBlockGroups && descriptorBlockIndex >= firstMetaBlockGroup)
+			{
+				uint64 metaGroupStart = descriptorBlockIndex * descriptorsPerBlock;
+				descriptorBlockNumber = firstDataBlock + metaGroupStart * blocksPerGroup + (IsExtBackupGroup (metaGroupStart, roCompatFeatures) ? 1 : 0);
+			}
+			else
+				descriptorBlockNumber = firstDataBlock + 1 + descriptorBlockIndex;
+
+			ReadData (volume, descriptorBlock, descriptorBlockNumber * blockSize);
+
+			uint64 firstGroup = descriptorBlockIndex * descriptorsPerBlock;
+			uint64 group = min (firstGroup + descriptorsPerBlock, groupCount);
+
+			while (group > firstGroup)
+			{
+				--group;
+
+				const uint8 *descriptor = descriptorBlock.Ptr() + (group - firstGroup) * descriptorSize;
+				uint64 groupStart = firstDataBlock + group * blocksPerGroup;
+				uint64 groupBlocks = min (blocksPerGroup, blockCount - groupStart);
+
+				uint64 blockBitmap = Endian::Little (*(uint32 *) descriptor);
+				if (descriptorSize >= 64)
+					blockBitmap |= (uint64) Endian::Little (*(uint32 *) (descriptor + 0x20)) << 32;
+
+				uint16 flags = Endian::Little (*(uint16 *) (descriptor + 0x12));
+
+				// The block bitmap of an uninitialized group is not stored. Such a group contains only
+				// a superblock backup and metadata, which may belong to the group itself.
+				if (groupChecksums && (flags & 0x2))
+				{
+					uint64 inodeBitmap = Endian::Little (*(uint32 *) (descriptor + 4));
+					uint64 inodeTable = Endian::Little (*(uint32 *) (descriptor + 8));
+					if (descriptorSize >= 64)
+					{
+						inodeBitmap |= (uint64) Endian::Little (*(uint32 *) (descriptor + 0x24)) << 32;
+						inodeTable |= (uint64) Endian::Little (*(uint32 *) (descriptor + 0x28)) << 32;
+					}
+
+					uint64 usedEnd = 0;
+					bool backupGroup = IsExtBackupGroup (group, roCompatFeatures);
+
+					if (backupGroup)
+						usedEnd = groupStart + 1 + (metaBlockGroups ? min (firstMetaBlockGroup, gdtBlocks) : gdtBlocks) + reservedGdtBlocks;
+
+					// With meta_bg, descriptors of a meta group are stored in its first, second and last group
+					uint64 metaGroupIndex = group % descriptorsPerBlock;
+					if (metaBlockGroups && (metaGroupIndex <= 1 || metaGroupIndex == descriptorsPerBlock - 1))
+						usedEnd = max (usedEnd, groupStart + (backupGroup ? 2 : 1));
+
+					if (blockBitmap >= groupStart && blockBitmap < groupStart + groupBlocks)
+						usedEnd = max (usedEnd, blockBitmap + 1);
+
+					if (inodeBitmap >= groupStart && inodeBitmap < groupStart + groupBlocks)
+						usedEnd = max (usedEnd, inodeBitmap + 1);
+
+					if (inodeTable >= groupStart && inodeTable < groupStart + groupBlocks)
+						usedEnd = max (usedEnd, inodeTable + inodeTableBlocks);
+
+					if (usedEnd != 0)
+						return usedEnd * blockSize >= filesystemSize ? 0 : filesystemSize - usedEnd * blockSize;
+
+					continue;
+				}
+
+				// Bitmaps stored in consecutive blocks (flex_bg) are read at once
+				uint64 batchFirstGroup = group;
+				uint64 batchFirstBitmap = blockBitmap;
+
+				while (batchFirstGroup > firstGroup && (group - batchFirstGroup + 2) * blockSize <= bitmaps.Size())
+				{
+					const uint8 *previousDescriptor = descriptor - (group - batchFirstGroup + 1) * descriptorSize;
+
+					uint64 previousBitmap = Endian::Little (*(uint32 *) previousDescriptor);
+					if (descriptorSize >= 64)
+						previousBitmap |= (uint64) Endian::Little (*(uint32 *) (previousDescriptor + 0x20)) << 32;
+
+					if ((groupChecksums && (Endian::Little (*(uint16 *) (previousDescriptor + 0x12)) & 0x2))
+						|| previousBitmap + 1 != batchFirstBitmap)
+					{
+						break;
+					}
+
+					--batchFirstGroup;
+					batchFirstBitmap = previousBitmap;
+				}
+
+				BufferPtr batchData = bitmaps.GetRange (0, (size_t) ((group - batchFirstGroup + 1) * blockSize));
+				ReadData (volume, batchData, batchFirstBitmap * blockSize);
+
+				for (uint64 batchGroup = group + 1; batchGroup > batchFirstGroup; )
+				{
+					--batchGroup;
+
+					uint64 batchGroupStart = firstDataBlock + batchGroup * blocksPerGroup;
+					uint64 lastUsedBlock;
+
+					if (FindLastSetBit (batchData.GetRange ((size_t) ((batchGroup - batchFirstGroup) * blockSize), (size_t) blockSize),
+						min (blocksPerGroup, blockCount - batchGroupStart), lastUsedBlock))
+					{
+						uint64 usedEnd = (batchGroupStart + lastUsedBlock + 1) * blockSize;
+						return usedEnd >= filesystemSize ? 0 : filesystemSize - usedEnd;
+					}
+				}
+
+				group = batchFirstGroup;
+			}
+		}
+
+		return filesystemSize;
+	}
+
+	uint64 FilesystemScanner::GetFreeSpaceAtEndFat (shared_ptr <Volume> volume, const ConstBufferPtr &bootSector, int fatType)
+	{
+		uint32 sectorSize = volume->GetSectorSize();
+		const uint8 *boot = bootSector.Get();
+
+		uint32 clusterSize = boot[13] * sectorSize;
+		uint32 reservedSectorCount = Endian::Little (*(uint16 *) (boot + 14));
+		uint32 fatCount = boot[16];
+
+		uint64 fatSectorCount;
+		if (fatType == 32)
+			fatSectorCount = Endian::Little (*(uint32 *) (boot + 36));
+		else
+			fatSectorCount = Endian::Little (*(uint16 *) (boot + 22));
+		uint64 fatSize = fatSectorCount * sectorSize;
+
+		uint64 fatStartOffset = reservedSectorCount * sectorSize;
+		uint64 dataAreaOffset = reservedSectorCount * sectorSize + fatSize * fatCount;
+
+		if (fatType < 32)
+			dataAreaOffset += Endian::Little (*(uint16 *) (boot + 17)) * 32;
+
+		// Find last used cluster
+		uint64 lastBit;
+		if (!FindLastSetBit (volume, vector <Extent> (1, Extent (fatStartOffset, fatSize)), fatSize * 8, lastBit))
+			return 0;
+
+		// FAT is examined in 32-bit units as FAT12 entries may span over byte boundaries
+		uint64 clusterNumber = (lastBit / 8) & ~3ULL;
+
+		if (fatType == 12)
+			clusterNumber = (clusterNumber * 8) / 12;
+		else if (fatType == 16)
+			clusterNumber /= 2;
+		else if (fatType == 32)
+			clusterNumber /= 4;
+
+		uint64 maxSize = volume->GetSize() - dataAreaOffset;
+
+		// Some FAT entries may span over sector boundaries
+		if (maxSize >= clusterSize)
+			maxSize -= clusterSize;
+
+		uint64 clusterOffset = clusterNumber * clusterSize;
+		if (maxSize < clusterOffset)
+			return 0;
+
+		return maxSize - clusterOffset;
+	}
+
+	uint64 FilesystemScanner::GetFreeSpaceAtEndNtfs (shared_ptr <Volume> volume, const ConstBufferPtr &bootSector)
+	{
+		const uint8 *boot = bootSector.Get();
+
+		uint64 bytesPerSector = Endian::Little (*(uint16 *) (boot + 11));
+		if (bytesPerSector < 256 || bytesPerSector > 4096 || (bytesPerSector & (bytesPerSector - 1)) != 0)
+			throw ParameterIncorrect (SRC_POS);
+
+		uint32 sectorsPerCluster = boot[13];
+		uint64 clusterSize = sectorsPerCluster > 0x80 ? 1ULL << (256 - sectorsPerCluster) : sectorsPerCluster * bytesPerSector;
+		if (clusterSize == 0 || clusterSize > 2 * BYTES_PER_MB)
+			throw ParameterIncorrect (SRC_POS);
+
+		uint64 sectorCount = Endian::Little (*(uint64 *) (boot + 40));
+		uint64 mftCluster = Endian::Little (*(uint64 *) (boot + 48));
+		int8 clustersPerMftRecord = (int8) boot[64];
+
+		if (clustersPerMftRecord < -16)
+			throw ParameterIncorrect (SRC_POS);
+
+		uint64 mftRecordSize = clustersPerMftRecord > 0 ? clustersPerMftRecord * clusterSize : 1ULL << -clustersPerMftRecord;
+		if (mftRecordSize < 512 || mftRecordSize > 64 * 1024)
+			throw ParameterIncorrect (SRC_POS);
+
+		// The backup boot sector follows the filesystem
+		uint64 filesystemSize = min (sectorCount * bytesPerSector, volume->GetSize());
+		uint64 clusterCount = sectorCount * bytesPerSector / clusterSize;
+
+		// MFT record 6 describes $Bitmap
+		SecureBuffer recordBuffer ((size_t) mftRecordSize);
+		ReadData (volume, recordBuffer, mftCluster * clusterSize + 6 * mftRecordSize);
+		uint8 *record = recordBuffer.Ptr();
+
+		if (memcmp (record, "FILE", 4) != 0)
+			throw ParameterIncorrect (SRC_POS);
+
+		// Restore the last two bytes of each 512-byte block replaced by the update sequence number
+		size_t updateSequenceOffset = Endian::Little (*(uint16 *) (record + 4));
+		size_t updateSequenceCount = Endian::Little (*(uint16 *) (record + 6));
+
+		if (updateSequenceCount == 0 || updateSequenceOffset + updateSequenceCount * 2 > mftRecordSize || (updateSequenceCount - 1) * 512 > mftRecordSize)
+			throw ParameterIncorrect (SRC_POS);
+
+		for (size_t i = 1; i < updateSequenceCount; ++i)
+		{
+			uint8 *blockEnd = record + i * 512 - 2;
+
+			if (memcmp (blockEnd, record + updateSequenceOffset, 2) != 0)
+				throw ParameterIncorrect (SRC_POS);
+
+			memcpy (blockEnd, record + updateSequenceOffset + i * 2, 2);
+		}
+
+		// Find the unnamed $DATA attribute
+		size_t attribute = Endian::Little (*(uint16 *) (record + 20));
+
+		while (true)
+		{
+			if (attribute + 16 > mftRecordSize || Endian::Little (*(uint32 *) (record + attribute)) == 0xffffFFFF)
+				throw ParameterIncorrect (SRC_POS);
+
+			size_t attributeLength = Endian::Little (*(uint32 *) (record + attribute + 4));
+			if (attributeLength < 16 || attribute + attributeLength > mftRecordSize)
+				throw ParameterIncorrect (SRC_POS);
+
+			if (Endian::Little (*(uint32 *) (record + attribute)) == 0x80 && record[attribute + 9] == 0)
+				break;
+
+			attribute += attributeLength;
+		}
+
+		size_t attributeEnd = attribute + Endian::Little (*(uint32 *) (record + attribute + 4));
+
+		// Only a non-resident $DATA attribute stored entirely in the base record is supported
+		if (record[attribute + 8] == 0 || attribute + 64 > attributeEnd || Endian::Little (*(uint64 *) (record + attribute + 16)) != 0)
+			throw ParameterIncorrect (SRC_POS);
+
+		uint64 bitmapSize = Endian::Little (*(uint64 *) (record + attribute + 48));
+
+		// Decode the runlist
+		vector <Extent> bitmap;
+		size_t run = attribute + Endian::Little (*(uint16 *) (record + attribute + 32));
+		uint64 lcn = 0;
+
+		while (run < attributeEnd && record[run] != 0)
+		{
+			size_t lengthSize = record[run] & 0xf;
+			size_t offsetSize = record[run] >> 4;
+
+			if (lengthSize == 0 || lengthSize > 8 || offsetSize > 8 || run + 1 + lengthSize + offsetSize > attributeEnd)
+				throw ParameterIncorrect (SRC_POS);
+
+			uint64 runLength = 0;
+			for (size_t i = 0; i < lengthSize; ++i)
+				runLength |= (uint64) record[run + 1 + i] << (i * 8);
+
+			if (offsetSize == 0)
+			{
+				bitmap.push_back (Extent (0, runLength * clusterSize, true));
+			}
+			else
+			{
+				// Cluster offset is signed and relative to the previous run
+				uint64 lcnDelta = 0;
+				for (size_t i = 0; i < offsetSize; ++i)
+					lcnDelta |= (uint64) record[run + 1 + lengthSize + i] << (i * 8);
+
+				if (offsetSize < 8 && (record[run + lengthSize + offsetSize] & 0x80))
+					lcnDelta |= ~0ULL << (offsetSize * 8);
+
+				lcn += lcnDelta;
+				bitmap.push_back (Extent (lcn * clusterSize, runLength * clusterSize));
+			}
+
+			run += 1 + lengthSize + offsetSize;
+		}
+
+		uint64 lastUsedCluster;
+		uint64 usedEnd = 0;
+
+		if (FindLastSetBit (volume, bitmap, min (clusterCount, bitmapSize * 8), lastUsedCluster))
+			usedEnd = (lastUsedCluster + 1) * clusterSize;
+
+		if (usedEnd >= filesystemSize)
+			return 0;
+
+		return filesystemSize - usedEnd;
+	}
+
+	bool FilesystemScanner::IsExtBackupGroup (uint64 group, uint32 roCompatFeatures)
+	{
+		// Superblock backups are stored in all groups unless the sparse_super feature is enabled
+		if (!(roCompatFeatures & 0x1) || group <= 1)
+			return true;
+
+		for (uint64 base = 3; base <= 7; base += 2)
+		{
+			uint64 power = base;
+			while (power < group)
+				power *= base;
+
+			if (power == group)
+				return true;
+		}
+
+		return false;
+	}
+
+	void FilesystemScanner::ReadData (shared_ptr <Volume> volume, const BufferPtr &buffer, uint64 offset)
+	{
+		uint32 sectorSize = volume->GetSectorSize();
+
+		uint64 alignedOffset = offset - offset % sectorSize;
+		uint64 alignedEnd = offset + buffer.Size();
+		if (alignedEnd % sectorSize != 0)
+			alignedEnd += sectorSize - alignedEnd % sectorSize;
+
+		if (alignedEnd < offset || alignedEnd > volume->GetSize())
+			throw ParameterIncorrect (SRC_POS);
+
+		if (alignedOffset == offset && alignedEnd == offset + buffer.Size())
+		{
+			volume->ReadSectors (buffer, offset);
+			return;
+		}
+
+		SecureBuffer sectors ((size_t) (alignedEnd - alignedOffset));
+		volume->ReadSectors (sectors, alignedOffset);
+		buffer.CopyFrom (sectors.GetRange ((size_t) (offset - alignedOffset), buffer.Size()));
+	}
+}
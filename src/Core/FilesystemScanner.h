@@ -0,0 +1,62 @@
+/*
+ Copyright (c) 2013-2025 AM Crypto. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#ifndef TC_HEADER_Core_FilesystemScanner
+#define TC_HEADER_Core_FilesystemScanner
+
+#include "Platform/Platform.h"
+#include "Volume/Volume.h"
+
+namespace VeraCrypt
+{
+	// Determines the free space following the last allocated cluster or block of the filesystem stored
+	// in a volume. FAT, exFAT, NTFS and ext2/3/4 are supported. Allocation tables and bitmaps are read in
+	// large chunks, which are scanned from their ends.
+	class FilesystemScanner
+	{
+	public:
+		// ParameterIncorrect is thrown if the filesystem is not supported or its structures are invalid
+		static uint64 GetFreeSpaceAtEnd (shared_ptr <Volume> volume);
+
+		static const size_t ReadChunkSize = 1024 * 1024;
+
+	protected:
+		struct Extent
+		{
+			Extent (uint64 start, uint64 length, bool sparse = false) : Length (length), Sparse (sparse), Start (start) { }
+
+			uint64 Length;
+			bool Sparse;		// Not allocated; reads as zeros
+			uint64 Start;		// Byte offset within the volume
+		};
+
+		struct ExFatLayout
+		{
+			uint64 ClusterCount;
+			uint64 ClusterHeapOffset;
+			uint64 ClusterSize;
+			uint64 FatOffset;
+		};
+
+		static bool FindLastSetBit (const ConstBufferPtr &bitmap, uint64 bitCount, uint64 &bitIndex);
+		static bool FindLastSetBit (shared_ptr <Volume> volume, const vector <Extent> &bitmap, uint64 bitCount, uint64 &bitIndex);
+		static size_t GetDataEnd (const ConstBufferPtr &data);
+		static vector <Extent> GetExFatClusterChain (shared_ptr <Volume> volume, const ExFatLayout &layout, uint32 firstCluster, uint64 length);
+		static uint64 GetFreeSpaceAtEndExFat (shared_ptr <Volume> volume, const ConstBufferPtr &bootSector);
+		static uint64 GetFreeSpaceAtEndExt (shared_ptr <Volume> volume, const ConstBufferPtr &superblock);
+		static uint64 GetFreeSpaceAtEndFat (shared_ptr <Volume> volume, const ConstBufferPtr &bootSector, int fatType);
+		static uint64 GetFreeSpaceAtEndNtfs (shared_ptr <Volume> volume, const ConstBufferPtr &bootSector);
+		static bool IsExtBackupGroup (uint64 group, uint32 roCompatFeatures);
+		static void ReadData (shared_ptr <Volume> volume, const BufferPtr &buffer, uint64 offset);
+
+	private:
+		FilesystemScanner ();
+	};
+}
+
+#endif // TC_HEADER_Core_FilesystemScanner
@@ -0,0 +1,610 @@
+/*
+ Copyright (c) 2013-2025 AM Crypto. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "Volume/EncryptionTest.h"
+#include "Volume/EncryptionModeXTS.h"
+#ifdef WOLFCRYPT_BACKEND
+#include "Volume/EncryptionModeWolfCryptXTS.h"
+#endif
+#include "Core.h"
+
+#ifdef TC_UNIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "InPlaceEncryptor.h"
+
+namespace VeraCrypt
+{
+	InPlaceEncryptor::InPlaceEncryptor ()
+		: AbortRequested (false), SizeDone (0)
+	{
+		mProgressInfo.EncryptionInProgress = false;
+		mProgressInfo.TotalSize = 0;
+		mProgressInfo.SizeDone = 0;
+	}
+
+	InPlaceEncryptor::~InPlaceEncryptor ()
+	{
+	}
+
+	void InPlaceEncryptor::Abort ()
+	{
+		AbortRequested = true;
+	}
+
+	void InPlaceEncryptor::CheckResult ()
+	{
+		if (ThreadException)
+			ThreadException->Throw();
+	}
+
+	void InPlaceEncryptor::EncryptionThread ()
+	{
+		try
+		{
+			if (StartOffset > ShiftSize)
+			{
+				Chunks.clear();
+				for (size_t i = 0; i < QueueDepth; ++i)
+					Chunks.push_back (shared_ptr <Chunk> (new Chunk));
+
+				struct ReaderFunctor : public Functor
+				{
+					ReaderFunctor (InPlaceEncryptor *encryptor) : Encryptor (encryptor) { }
+					virtual void operator() ()
+					{
+						Encryptor->ReaderThread ();
+					}
+					InPlaceEncryptor *Encryptor;
+				};
+
+				struct WriterFunctor : public Functor
+				{
+					WriterFunctor (InPlaceEncryptor *encryptor) : Encryptor (encryptor) { }
+					virtual void operator() ()
+					{
+						Encryptor->WriterThread ();
+					}
+					InPlaceEncryptor *Encryptor;
+				};
+
+				Thread readerThread;
+				Thread writerThread;
+				readerThread.Start (new ReaderFunctor (this));
+				writerThread.Start (new WriterFunctor (this));
+
+				// Chunks read by the reader thread are encrypted by the encryption thread pool and passed
+				// to the writer thread. A chunk of zero length terminates the pipeline.
+				shared_ptr <Exception> encryptionException;
+
+				for (size_t chunkIndex = 0; ; chunkIndex = (chunkIndex + 1) % Chunks.size())
+				{
+					Chunk &chunk = *Chunks[chunkIndex];
+
+					while (chunk.Status.Get() != Chunk::State::Read)
+						ChunkReadEvent.Wait();
+
+					bool lastChunk = (chunk.Length == 0);
+
+					if (!lastChunk && !AbortRequested)
+					{
+						try
+						{
+							EA->EncryptSectors (chunk.Data.GetRange (0, chunk.Length),
+								chunk.Offset / ENCRYPTION_DATA_UNIT_SIZE, chunk.Length / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
+						}
+						catch (Exception &e)
+						{
+							encryptionException.reset (e.CloneNew());
+							AbortRequested = true;
+						}
+						catch (exception &e)
+						{
+							encryptionException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+							AbortRequested = true;
+						}
+					}
+
+					chunk.Status.Set (Chunk::State::Encrypted);
+					ChunkEncryptedEvent.Signal();
+
+					if (lastChunk)
+						break;
+				}
+
+				readerThread.Join();
+				writerThread.Join();
+				Chunks.clear();
+
+				// Record the progress made since the last checkpoint so that the encryption can be resumed
+				if (EncryptedAreaStart != LastCheckpoint)
+				{
+					try
+					{
+						WriteCheckpoint (EncryptedAreaStart);
+					}
+					catch (...)
+					{
+						if (!ReaderException && !encryptionException && !WriterException)
+							throw;
+					}
+				}
+
+				if (ReaderException)
+					ReaderException->Throw();
+
+				if (encryptionException)
+					encryptionException->Throw();
+
+				if (WriterException)
+					WriterException->Throw();
+			}
+
+			if (!AbortRequested)
+				FinalizeVolume();
+		}
+		catch (Exception &e)
+		{
+			ThreadException.reset (e.CloneNew());
+		}
+		catch (exception &e)
+		{
+			ThreadException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+		}
+		catch (...)
+		{
+			ThreadException.reset (new UnknownException (SRC_POS));
+		}
+
+		Chunks.clear();
+		VolumeFile.reset();
+		mProgressInfo.EncryptionInProgress = false;
+	}
+
+	void InPlaceEncryptor::EncryptVolume (shared_ptr <InPlaceEncryptionOptions> options)
+	{
+		EncryptionTest::TestAll();
+
+		{
+#ifdef TC_UNIX
+			// Temporarily take ownership of a device if the user is not an administrator
+			UserId origDeviceOwner ((uid_t) -1);
+
+			if (options->Path.IsDevice() && !Core->HasAdminPrivileges())
+			{
+				origDeviceOwner = FilesystemPath (wstring (options->Path)).GetOwner();
+				Core->SetFileOwner (options->Path, UserId (getuid()));
+			}
+
+			finally_do_arg2 (FilesystemPath, options->Path, UserId, origDeviceOwner,
+			{
+				if (finally_arg2.SystemId != (uid_t) -1)
+					Core->SetFileOwner (finally_arg, finally_arg2);
+			});
+#endif
+
+			VolumeFile.reset (new File);
+			VolumeFile->Open (options->Path, File::OpenReadWrite, File::ShareNone, File::ExclusiveDeviceAccess);
+
+			HostSize = VolumeFile->Length();
+		}
+
+		try
+		{
+			// Sector size
+			uint32 sectorSize;
+			if (options->Path.IsDevice())
+			{
+				sectorSize = VolumeFile->GetDeviceSectorSize();
+
+				if (sectorSize < TC_MIN_VOLUME_SECTOR_SIZE
+					|| sectorSize > TC_MAX_VOLUME_SECTOR_SIZE
+#if !defined (TC_LINUX) && !defined (TC_MACOSX)
+					|| sectorSize != TC_SECTOR_SIZE_LEGACY
+#endif
+					|| sectorSize % ENCRYPTION_DATA_UNIT_SIZE != 0)
+				{
+					throw UnsupportedSectorSize (SRC_POS);
+				}
+			}
+			else
+				sectorSize = TC_SECTOR_SIZE_FILE_HOSTED_VOLUME;
+
+			if (HostSize < TC_MIN_VOLUME_SIZE || HostSize % sectorSize != 0)
+				throw ParameterIncorrect (SRC_POS);
+
+			// The data is moved up by the size of the primary header group and the backup header group
+			// occupies the end of the host
+			Layout.reset (new VolumeLayoutV2Normal());
+			DataSize = Layout->GetMaxDataSize (HostSize);
+			EncryptedAreaEnd = ShiftSize + DataSize;
+
+			PasswordKey = Keyfile::ApplyListToPassword (options->Keyfiles, options->Password, options->EMVSupportEnabled);
+
+			HeaderSalt.Allocate (VolumeHeader::GetSaltSize());
+			HeaderKey.Allocate (VolumeHeader::GetLargestSerializedKeySize());
+
+			if (options->Resume)
+			{
+				// Progress of an interrupted encryption is recorded in the backup header
+				Volume volume;
+				volume.Open (VolumeFile, options->Password, options->Pim, options->VolumeHeaderKdf, options->Keyfiles,
+					options->EMVSupportEnabled, VolumeProtection::None,
+					shared_ptr <VolumePassword> (), 0, shared_ptr <Pkcs5Kdf> (), shared_ptr <KeyfileList> (),
+					VolumeType::Normal, true);
+
+				Header = volume.GetHeader();
+
+				if (!(Header->GetFlags() & TC_HEADER_FLAG_NONSYS_INPLACE_ENC)
+					|| Header->GetVolumeDataSize() != DataSize
+					|| Header->GetEncryptedAreaStart() < ShiftSize
+					|| Header->GetEncryptedAreaStart() + Header->GetEncryptedAreaLength() != EncryptedAreaEnd)
+				{
+					throw ParameterIncorrect (SRC_POS);
+				}
+
+				Layout = volume.GetLayout();
+				EA = volume.GetEncryptionAlgorithm();
+				Kdf = volume.GetPkcs5Kdf();
+
+				if (VolumeFile->ReadAt (HeaderSalt, HostSize + Layout->GetBackupHeaderOffset()) != HeaderSalt.Size())
+					throw MissingVolumeData (SRC_POS);
+
+				Kdf->DeriveKey (HeaderKey, *PasswordKey, options->Pim, HeaderSalt);
+
+				StartOffset = FindResumeOffset (Header->GetEncryptedAreaStart());
+			}
+			else
+			{
+				// The filesystem must have been shrunk so that it does not extend into the area of the backup headers
+				SecureBuffer firstSectors (VC_MAX (2048, sectorSize));
+				if (VolumeFile->ReadAt (firstSectors, 0) != firstSectors.Size())
+					throw MissingVolumeData (SRC_POS);
+
+				uint64 filesystemSize = GetFilesystemSize (firstSectors);
+				if (filesystemSize == 0 && !options->Force)
+					throw UnsupportedFilesystem (SRC_POS);
+
+				if (filesystemSize > DataSize)
+					throw ParameterTooLarge (SRC_POS);
+
+				Header = Layout->GetHeader();
+				SecureBuffer headerBuffer (Layout->GetHeaderSize());
+
+				VolumeHeaderCreationOptions headerOptions;
+				headerOptions.EA = options->EA;
+				headerOptions.Kdf = options->VolumeHeaderKdf;
+				headerOptions.Type = VolumeType::Normal;
+				headerOptions.SectorSize = sectorSize;
+				headerOptions.VolumeDataStart = ShiftSize;
+				headerOptions.VolumeDataSize = DataSize;
+
+				// Master data key
+				SecureBuffer masterKey (options->EA->GetKeySize() * 2);
+				RandomNumberGenerator::GetData (masterKey);
+				if (memcmp (masterKey.Ptr(), masterKey.Ptr() + masterKey.Size() / 2, masterKey.Size() / 2) == 0)
+					throw AssertionFailed (SRC_POS);
+
+				headerOptions.DataKey = masterKey;
+
+				// PKCS5 salt
+				RandomNumberGenerator::GetData (HeaderSalt);
+				headerOptions.Salt = HeaderSalt;
+
+				// Header key
+				options->VolumeHeaderKdf->DeriveKey (HeaderKey, *PasswordKey, options->Pim, HeaderSalt);
+				headerOptions.HeaderKey = HeaderKey;
+
+				Header->Create (headerBuffer, headerOptions);
+				Header->SetFlags (TC_HEADER_FLAG_NONSYS_INPLACE_ENC);
+
+				// Data area keys
+				EA = options->EA;
+				EA->SetKey (masterKey.GetRange (0, EA->GetKeySize()));
+#ifdef WOLFCRYPT_BACKEND
+				shared_ptr <EncryptionMode> mode (new EncryptionModeWolfCryptXTS ());
+				EA->SetKeyXTS (masterKey.GetRange (EA->GetKeySize(), EA->GetKeySize()));
+#else
+				shared_ptr <EncryptionMode> mode (new EncryptionModeXTS ());
+#endif
+				mode->SetKey (masterKey.GetRange (EA->GetKeySize(), EA->GetKeySize()));
+				EA->SetMode (mode);
+
+				Kdf = options->VolumeHeaderKdf;
+
+				// Backup header with an empty encrypted area
+				WriteCheckpoint (EncryptedAreaEnd);
+
+				VolumeLayoutV2Hidden hiddenLayout;
+				WriteFakeHiddenVolumeHeader (HostSize + hiddenLayout.GetBackupHeaderOffset());
+				VolumeFile->Flush();
+
+				StartOffset = EncryptedAreaEnd;
+			}
+
+			Options = options;
+			AbortRequested = false;
+			EncryptedAreaStart = StartOffset;
+			LastCheckpoint = Header->GetEncryptedAreaStart();
+			SizeDone.Set (EncryptedAreaEnd - StartOffset);
+
+			mProgressInfo.TotalSize = DataSize;
+			mProgressInfo.EncryptionInProgress = true;
+
+			struct ThreadFunctor : public Functor
+			{
+				ThreadFunctor (InPlaceEncryptor *encryptor) : Encryptor (encryptor) { }
+				virtual void operator() ()
+				{
+					Encryptor->EncryptionThread ();
+				}
+				InPlaceEncryptor *Encryptor;
+			};
+
+			Thread thread;
+			thread.Start (new ThreadFunctor (this));
+		}
+		catch (...)
+		{
+			VolumeFile.reset();
+			throw;
+		}
+	}
+
+	void InPlaceEncryptor::FinalizeVolume ()
+	{
+		if (LastCheckpoint != ShiftSize)
+			WriteCheckpoint (ShiftSize);
+
+		// Headers of the completed volume no longer indicate an in-place encryption, which could otherwise be resumed
+		Header->SetFlags (Header->GetFlags() & ~TC_HEADER_FLAG_NONSYS_INPLACE_ENC);
+
+		// The primary header replaces the first bytes of the original data, which have already been moved
+		SecureBuffer primaryHeaderSalt (VolumeHeader::GetSaltSize());
+		RandomNumberGenerator::GetData (primaryHeaderSalt);
+
+		SecureBuffer primaryHeaderKey (VolumeHeader::GetLargestSerializedKeySize());
+		Kdf->DeriveKey (primaryHeaderKey, *PasswordKey, Options->Pim, primaryHeaderSalt);
+
+		SecureBuffer headerBuffer (Layout->GetHeaderSize());
+		headerBuffer.Zero();
+		Header->EncryptNew (headerBuffer, primaryHeaderSalt, primaryHeaderKey, Kdf);
+		VolumeFile->WriteAt (headerBuffer, Layout->GetHeaderOffset());
+
+		VolumeLayoutV2Hidden hiddenLayout;
+		WriteFakeHiddenVolumeHeader (hiddenLayout.GetHeaderOffset());
+		VolumeFile->Flush();
+
+		// The backup header is updated last so that an interruption before this point can still be resumed
+		WriteCheckpoint (ShiftSize);
+
+		SizeDone.Set (DataSize);
+	}
+
+	uint64 InPlaceEncryptor::FindResumeOffset (uint64 checkpointOffset)
+	{
+		if (checkpointOffset == EncryptedAreaEnd || checkpointOffset == ShiftSize)
+			return checkpointOffset;
+
+		// Pieces encrypted after the checkpoint was written are located by comparing each decrypted piece with
+		// its plaintext source, which remains unmodified until the following piece is written. The next piece
+		// to encrypt is the one whose target area still contains at least one sector of the previous source.
+		SecureBuffer target (ShiftSize);
+		SecureBuffer source (ShiftSize);
+
+		uint64 pieceEnd = checkpointOffset + ShiftSize;
+
+		for (uint64 pieceCount = 0; pieceCount <= CheckpointInterval / ShiftSize + 1 && pieceEnd > ShiftSize; ++pieceCount)
+		{
+			uint64 pieceStart = VC_MAX (pieceEnd - ShiftSize, (uint64) ShiftSize);
+			size_t pieceLength = (size_t) (pieceEnd - pieceStart);
+
+			BufferPtr targetData = target.GetRange (0, pieceLength);
+			BufferPtr sourceData = source.GetRange (0, pieceLength);
+
+			if (VolumeFile->ReadAt (targetData, pieceStart) != pieceLength
+				|| VolumeFile->ReadAt (sourceData, pieceStart - ShiftSize) != pieceLength)
+			{
+				throw MissingVolumeData (SRC_POS);
+			}
+
+			EA->DecryptSectors (targetData, pieceStart / ENCRYPTION_DATA_UNIT_SIZE, pieceLength / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
+
+			for (size_t offset = 0; offset < pieceLength; offset += ENCRYPTION_DATA_UNIT_SIZE)
+			{
+				if (memcmp (targetData.Get() + offset, sourceData.Get() + offset, ENCRYPTION_DATA_UNIT_SIZE) == 0)
+					return pieceStart;
+			}
+
+			pieceEnd = pieceStart;
+		}
+
+		throw MissingVolumeData (SRC_POS);
+	}
+
+	uint64 InPlaceEncryptor::GetFilesystemSize (const ConstBufferPtr &firstSectors)
+	{
+		// Only ext2/3/4 filesystems are recognized
+		if (firstSectors.Size() < 2048)
+			return 0;
+
+		const uint8 *superblock = firstSectors.Get() + 1024;
+
+		if (Endian::Little (*(uint16 *) (superblock + 56)) != 0xef53)
+			return 0;
+
+		uint64 blockCount = Endian::Little (*(uint32 *) (superblock + 4));
+		uint32 logBlockSize = Endian::Little (*(uint32 *) (superblock + 24));
+
+		// 64-bit block numbers
+		if (Endian::Little (*(uint32 *) (superblock + 0x60)) & 0x80)
+			blockCount |= (uint64) Endian::Little (*(uint32 *) (superblock + 0x150)) << 32;
+
+		if (logBlockSize > 6)
+			return 0;
+
+		return blockCount * (1024 << logBlockSize);
+	}
+
+	InPlaceEncryptor::ProgressInfo InPlaceEncryptor::GetProgressInfo ()
+	{
+		mProgressInfo.SizeDone = SizeDone.Get();
+		return mProgressInfo;
+	}
+
+	void InPlaceEncryptor::ReaderThread ()
+	{
+		uint64 endOffset = StartOffset;
+		size_t chunkIndex = 0;
+
+		try
+		{
+			// Each chunk is read from the position of its data before the shift
+			while (endOffset > ShiftSize && !AbortRequested)
+			{
+				Chunk &chunk = *Chunks[chunkIndex];
+
+				while (chunk.Status.Get() != Chunk::State::Free)
+					ChunkFreeEvent.Wait();
+
+				uint64 startOffset = (endOffset - ShiftSize > ChunkSize) ? endOffset - ChunkSize : ShiftSize;
+				size_t length = (size_t) (endOffset - startOffset);
+
+				if (VolumeFile->ReadAt (chunk.Data.GetRange (0, length), startOffset - ShiftSize) != length)
+					throw MissingVolumeData (SRC_POS);
+
+				chunk.Offset = startOffset;
+				chunk.Length = length;
+				chunk.Status.Set (Chunk::State::Read);
+				ChunkReadEvent.Signal();
+
+				endOffset = startOffset;
+				chunkIndex = (chunkIndex + 1) % Chunks.size();
+			}
+		}
+		catch (Exception &e)
+		{
+			ReaderException.reset (e.CloneNew());
+			AbortRequested = true;
+		}
+		catch (exception &e)
+		{
+			ReaderException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+			AbortRequested = true;
+		}
+
+		Chunk &lastChunk = *Chunks[chunkIndex];
+		while (lastChunk.Status.Get() != Chunk::State::Free)
+			ChunkFreeEvent.Wait();
+
+		lastChunk.Length = 0;
+		lastChunk.Status.Set (Chunk::State::Read);
+		ChunkReadEvent.Signal();
+	}
+
+	void InPlaceEncryptor::WriteCheckpoint (uint64 encryptedAreaStart)
+	{
+		Header->SetEncryptedArea (encryptedAreaStart, EncryptedAreaEnd - encryptedAreaStart);
+
+		SecureBuffer headerBuffer (Layout->GetHeaderSize());
+		headerBuffer.Zero();
+		Header->EncryptNew (headerBuffer, HeaderSalt, HeaderKey, Kdf);
+
+		VolumeFile->WriteAt (headerBuffer, HostSize + Layout->GetBackupHeaderOffset());
+		VolumeFile->Flush();
+
+		LastCheckpoint = encryptedAreaStart;
+	}
+
+	void InPlaceEncryptor::WriteFakeHiddenVolumeHeader (uint64 offset)
+	{
+		// Write fake random header to space reserved for hidden volume header
+		VolumeLayoutV2Hidden hiddenLayout;
+		shared_ptr <VolumeHeader> hiddenHeader (hiddenLayout.GetHeader());
+		SecureBuffer hiddenHeaderBuffer (hiddenLayout.GetHeaderSize());
+
+		VolumeHeaderCreationOptions headerOptions;
+		headerOptions.EA = EA->GetNew();
+		headerOptions.Kdf = Kdf;
+		headerOptions.Type = VolumeType::Hidden;
+		headerOptions.SectorSize = Header->GetSectorSize();
+		headerOptions.VolumeDataStart = ShiftSize;
+		headerOptions.VolumeDataSize = hiddenLayout.GetMaxDataSize (DataSize);
+
+		// Master data key
+		SecureBuffer hiddenMasterKey (headerOptions.EA->GetKeySize() * 2);
+		RandomNumberGenerator::GetBulkData (hiddenMasterKey);
+		headerOptions.DataKey = hiddenMasterKey;
+
+		// PKCS5 salt
+		SecureBuffer hiddenSalt (VolumeHeader::GetSaltSize());
+		RandomNumberGenerator::GetBulkData (hiddenSalt);
+		headerOptions.Salt = hiddenSalt;
+
+		// Header key
+		SecureBuffer hiddenHeaderKey (VolumeHeader::GetLargestSerializedKeySize());
+		RandomNumberGenerator::GetBulkData (hiddenHeaderKey);
+		headerOptions.HeaderKey = hiddenHeaderKey;
+
+		hiddenHeader->Create (hiddenHeaderBuffer, headerOptions);
+
+		VolumeFile->WriteAt (hiddenHeaderBuffer, offset);
+	}
+
+	void InPlaceEncryptor::WriterThread ()
+	{
+		for (size_t chunkIndex = 0; ; chunkIndex = (chunkIndex + 1) % Chunks.size())
+		{
+			Chunk &chunk = *Chunks[chunkIndex];
+
+			while (chunk.Status.Get() != Chunk::State::Encrypted)
+				ChunkEncryptedEvent.Wait();
+
+			if (chunk.Length == 0)
+				break;
+
+			try
+			{
+				// Data is shifted by the size of a piece. Each piece overwrites the plaintext source of the
+				// piece written before it, which must therefore be stored on the disk first.
+				for (uint64 pieceEnd = chunk.Offset + chunk.Length; pieceEnd > chunk.Offset && !AbortRequested; )
+				{
+					uint64 pieceStart = VC_MAX (pieceEnd - ShiftSize, chunk.Offset);
+
+					VolumeFile->WriteAt (chunk.Data.GetRange ((size_t) (pieceStart - chunk.Offset), (size_t) (pieceEnd - pieceStart)), pieceStart);
+					VolumeFile->Flush();
+
+					EncryptedAreaStart = pieceStart;
+					SizeDone.Set (EncryptedAreaEnd - pieceStart);
+
+					// The first piece is always recorded to limit the search for the resume offset
+					if (pieceEnd == StartOffset || LastCheckpoint - pieceStart >= CheckpointInterval)
+						WriteCheckpoint (pieceStart);
+
+					pieceEnd = pieceStart;
+				}
+			}
+			catch (Exception &e)
+			{
+				WriterException.reset (e.CloneNew());
+				AbortRequested = true;
+			}
+			catch (exception &e)
+			{
+				WriterException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+				AbortRequested = true;
+			}
+
+			chunk.Status.Set (Chunk::State::Free);
+			ChunkFreeEvent.Signal();
+		}
+	}
+}
@@ -0,0 +1,123 @@
+/*
+ Copyright (c) 2013-2025 AM Crypto. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#ifndef TC_HEADER_Core_InPlaceEncryptor
+#define TC_HEADER_Core_InPlaceEncryptor
+
+#include "Platform/Platform.h"
+#include "Volume/Volume.h"
+#include "Volume/VolumeLayout.h"
+
+namespace VeraCrypt
+{
+	struct InPlaceEncryptionOptions
+	{
+		InPlaceEncryptionOptions () : Pim (0), EMVSupportEnabled (false), Force (false), Resume (false) { }
+
+		VolumePath Path;
+		shared_ptr <VolumePassword> Password;
+		int Pim;
+		shared_ptr <KeyfileList> Keyfiles;
+		shared_ptr <Pkcs5Kdf> VolumeHeaderKdf;	// Optional when resuming
+		shared_ptr <EncryptionAlgorithm> EA;		// Ignored when resuming
+		bool EMVSupportEnabled;
+		bool Force;		// Accepts filesystems whose size cannot be determined
+		bool Resume;
+	};
+
+	// Converts a device or file containing plaintext data to a normal volume without copying the data
+	// elsewhere. The data is shifted up by the size of the primary header group, which requires the
+	// filesystem to be shrunk by TC_TOTAL_VOLUME_HEADERS_SIZE beforehand, and encrypted from the end
+	// towards the start. Progress is recorded in the backup header so that an interrupted encryption
+	// can be resumed.
+	class InPlaceEncryptor
+	{
+	public:
+		struct ProgressInfo
+		{
+			bool EncryptionInProgress;
+			uint64 TotalSize;
+			uint64 SizeDone;
+		};
+
+		InPlaceEncryptor ();
+		virtual ~InPlaceEncryptor ();
+
+		void Abort ();
+		void CheckResult ();
+		void EncryptVolume (shared_ptr <InPlaceEncryptionOptions> options);
+		ProgressInfo GetProgressInfo ();
+
+		static const size_t ChunkSize = 4 * BYTES_PER_MB;
+		static const uint64 CheckpointInterval = 64 * BYTES_PER_MB;
+		static const size_t QueueDepth = 4;
+		static const uint32 ShiftSize = TC_VOLUME_DATA_OFFSET;
+
+	protected:
+		struct Chunk
+		{
+			struct State
+			{
+				enum Enum
+				{
+					Free,
+					Read,
+					Encrypted
+				};
+			};
+
+			Chunk () : Data (ChunkSize), Length (0), Offset (0), Status (State::Free) { }
+
+			SecureBuffer Data;
+			size_t Length;
+			uint64 Offset;		// Target offset of the encrypted data
+			SharedVal <State::Enum> Status;
+		};
+
+		void EncryptionThread ();
+		uint64 FindResumeOffset (uint64 checkpointOffset);
+		void FinalizeVolume ();
+		static uint64 GetFilesystemSize (const ConstBufferPtr &firstSectors);
+		void ReaderThread ();
+		void WriteCheckpoint (uint64 encryptedAreaStart);
+		void WriteFakeHiddenVolumeHeader (uint64 offset);
+		void WriterThread ();
+
+		volatile bool AbortRequested;
+		vector < shared_ptr <Chunk> > Chunks;
+		SyncEvent ChunkEncryptedEvent;
+		SyncEvent ChunkFreeEvent;
+		SyncEvent ChunkReadEvent;
+		uint64 DataSize;
+		shared_ptr <EncryptionAlgorithm> EA;
+		uint64 EncryptedAreaEnd;
+		uint64 EncryptedAreaStart;		// Data above this offset has been encrypted and written
+		shared_ptr <VolumeHeader> Header;
+		SecureBuffer HeaderKey;
+		SecureBuffer HeaderSalt;
+		uint64 HostSize;
+		shared_ptr <Pkcs5Kdf> Kdf;
+		uint64 LastCheckpoint;
+		shared_ptr <VolumeLayout> Layout;
+		shared_ptr <InPlaceEncryptionOptions> Options;
+		shared_ptr <VolumePassword> PasswordKey;
+		ProgressInfo mProgressInfo;
+		shared_ptr <Exception> ReaderException;
+		SharedVal <uint64> SizeDone;
+		uint64 StartOffset;
+		shared_ptr <Exception> ThreadException;
+		shared_ptr <File> VolumeFile;
+		shared_ptr <Exception> WriterException;
+
+	private:
+		InPlaceEncryptor (const InPlaceEncryptor &);
+		InPlaceEncryptor &operator= (const InPlaceEncryptor &);
+	};
+}
+
+#endif // TC_HEADER_Core_InPlaceEncryptor
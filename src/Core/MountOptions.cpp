@@ -51,6 +51,7 @@ namespace VeraCrypt
 		TC_CLONE (Removable);
 		TC_CLONE (SharedAccessAllowed);
 		TC_CLONE (SlotNumber);
+		TC_CLONE (TrialHint);
 		TC_CLONE (UseBackupHeaders);
 	}
 
@@ -122,6 +123,25 @@ namespace VeraCrypt
 
 		sr.Deserialize ("Pim", Pim);
 		sr.Deserialize ("ProtectionPim", ProtectionPim);
+
+		sr.Deserialize ("TrialHintEncryptionAlgorithm", TrialHint.EncryptionAlgorithm);
+
+		if (!sr.DeserializeBool ("TrialHintHeaderKeyNull"))
+		{
+			TrialHint.HeaderKey.reset (new VolumeHeaderKey);
+			sr.Deserialize ("TrialHintHeaderKeyKdf", TrialHint.HeaderKey->Kdf);
+
+			TrialHint.HeaderKey->Key.Allocate (VolumeHeader::GetLargestSerializedKeySize());
+			sr.Deserialize ("TrialHintHeaderKey", TrialHint.HeaderKey->Key);
+
+			TrialHint.HeaderKey->Salt.Allocate (VolumeHeader::GetSaltSize());
+			sr.Deserialize ("TrialHintHeaderKeySalt", TrialHint.HeaderKey->Salt);
+		}
+		else
+			TrialHint.HeaderKey.reset();
+
+		sr.Deserialize ("TrialHintKdf", TrialHint.Kdf);
+		TrialHint.Type = static_cast <VolumeType::Enum> (sr.DeserializeInt32 ("TrialHintType"));
 	}
 
 	void MountOptions::Serialize (shared_ptr <Stream> stream) const
@@ -174,6 +194,19 @@ namespace VeraCrypt
 
 		sr.Serialize ("Pim", Pim);
 		sr.Serialize ("ProtectionPim", ProtectionPim);
+
+		sr.Serialize ("TrialHintEncryptionAlgorithm", TrialHint.EncryptionAlgorithm);
+
+		sr.Serialize ("TrialHintHeaderKeyNull", TrialHint.HeaderKey == nullptr);
+		if (TrialHint.HeaderKey)
+		{
+			sr.Serialize ("TrialHintHeaderKeyKdf", TrialHint.HeaderKey->Kdf);
+			sr.Serialize ("TrialHintHeaderKey", ConstBufferPtr (TrialHint.HeaderKey->Key));
+			sr.Serialize ("TrialHintHeaderKeySalt", ConstBufferPtr (TrialHint.HeaderKey->Salt));
+		}
+
+		sr.Serialize ("TrialHintKdf", TrialHint.Kdf);
+		sr.Serialize ("TrialHintType", static_cast <uint32> (TrialHint.Type));
 	}
 
 	TC_SERIALIZER_FACTORY_ADD_CLASS (MountOptions);
@@ -70,12 +70,15 @@ namespace VeraCrypt
 		bool Removable;
 		bool SharedAccessAllowed;
 		VolumeSlotNumber SlotNumber;
+		VolumeTrialHint TrialHint;
 		bool UseBackupHeaders;
 		bool EMVSupportEnabled;
 
 	protected:
 		void CopyFrom (const MountOptions &other);
 	};
+
+	typedef list < shared_ptr <MountOptions> > MountOptionsList;
 }
 
 #endif // TC_HEADER_Core_MountOptions
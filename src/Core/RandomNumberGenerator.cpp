@@ -104,6 +104,53 @@ namespace VeraCrypt
 		}
 	}
 
+	void RandomNumberGenerator::GetBulkData (const BufferPtr &buffer)
+	{
+		if (!Running)
+			throw NotInitialized (SRC_POS);
+
+		// Bulk data is taken from a ChaCha20 generator which is periodically reseeded from the pool.
+		// Large requests are served in segments, each from the keystream of a one-time key drawn from the generator.
+		ScopeLock lock (StreamMutex);
+
+		SecureBuffer segmentKey (CHACHA20RNG_KEYSZ + CHACHA20RNG_IVSZ);
+		SecureBuffer segmentContext (sizeof (ChaCha256Ctx), 16);
+
+		uint8 *data = buffer.Get();
+		size_t dataLength = buffer.Size();
+
+		while (dataLength > 0)
+		{
+			if (!StreamContext.IsAllocated() || StreamBytesSinceReseed >= MaxStreamBytesBeforeReseed)
+				ReseedStream();
+
+			size_t length = dataLength;
+			if (length > StreamSegmentSize)
+				length = StreamSegmentSize;
+			if (length > MaxStreamBytesBeforeReseed - StreamBytesSinceReseed)
+				length = (size_t) (MaxStreamBytesBeforeReseed - StreamBytesSinceReseed);
+
+			ChaCha20RngCtx *streamContext = (ChaCha20RngCtx *) StreamContext.Ptr();
+
+			if (length < CHACHA20RNG_RSBUFSZ)
+			{
+				ChaCha20RngGetBytes (streamContext, data, length);
+			}
+			else
+			{
+				ChaCha20RngGetBytes (streamContext, segmentKey, segmentKey.Size());
+				ChaCha256Init ((ChaCha256Ctx *) segmentContext.Ptr(), segmentKey, segmentKey.Ptr() + CHACHA20RNG_KEYSZ, 20);
+
+				Memory::Zero (data, length);
+				ChaCha256Encrypt ((ChaCha256Ctx *) segmentContext.Ptr(), data, length, data);
+			}
+
+			StreamBytesSinceReseed += length;
+			data += length;
+			dataLength -= length;
+		}
+	}
+
 	void RandomNumberGenerator::GetData (const BufferPtr &buffer, bool fast, bool allowAnyLength)
 	{
 		if (!Running)
@@ -116,8 +163,8 @@ namespace VeraCrypt
 		size_t bufferLen = buffer.Size(), loopLen;
 		uint8* pbBuffer = buffer.Get();
 		
-		// Initialize JitterEntropy RNG for this call
-		if (0 == jent_entropy_init ())
+		// Initialize JitterEntropy RNG for this call (it is only used when polling in slow mode)
+		if (!fast && 0 == jent_entropy_init ())
 		{
 			JitterRngCtx = jent_entropy_collector_alloc (1, 0);
 		}
@@ -209,6 +256,25 @@ namespace VeraCrypt
 		}
 	}
 
+	void RandomNumberGenerator::ReseedStream ()
+	{
+		SecureBuffer seed (CHACHA20RNG_KEYSZ + CHACHA20RNG_IVSZ);
+
+		// The initial seed is obtained with a full poll of entropy sources
+		if (StreamContext.IsAllocated())
+		{
+			GetDataFast (seed);
+		}
+		else
+		{
+			GetData (seed);
+			StreamContext.Allocate (sizeof (ChaCha20RngCtx), 16);
+		}
+
+		ChaCha20RngInit ((ChaCha20RngCtx *) StreamContext.Ptr(), seed, nullptr, 0);
+		StreamBytesSinceReseed = 0;
+	}
+
 	void RandomNumberGenerator::SetHash (shared_ptr <Hash> hash)
 	{
 		ScopeLock lock (AccessMutex);
@@ -242,8 +308,12 @@ namespace VeraCrypt
 
 	void RandomNumberGenerator::Stop ()
 	{
+		ScopeLock streamLock (StreamMutex);
 		ScopeLock lock (AccessMutex);
 
+		if (StreamContext.IsAllocated())
+			StreamContext.Free ();
+
 		if (Pool.IsAllocated())
 			Pool.Free ();
 
@@ -302,4 +372,7 @@ namespace VeraCrypt
 	size_t RandomNumberGenerator::WriteOffset;
 	struct rand_data *RandomNumberGenerator::JitterRngCtx = NULL;
 	int RandomNumberGenerator::DevRandomBytesCount = 0;
+	SecureBuffer RandomNumberGenerator::StreamContext;
+	uint64 RandomNumberGenerator::StreamBytesSinceReseed;
+	Mutex RandomNumberGenerator::StreamMutex;
 }
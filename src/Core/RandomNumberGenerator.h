@@ -17,6 +17,7 @@
 #include "Volume/Hash.h"
 #include "Common/Random.h"
 #include "Crypto/jitterentropy.h"
+#include "Crypto/chachaRng.h"
 
 namespace VeraCrypt
 {
@@ -24,6 +25,7 @@ namespace VeraCrypt
 	{
 	public:
 		static void AddToPool (const ConstBufferPtr &buffer);
+		static void GetBulkData (const BufferPtr &buffer);
 		static void GetData (const BufferPtr &buffer, bool allowAnyLength = false) { GetData (buffer, false, allowAnyLength); }
 		static void GetDataFast (const BufferPtr &buffer, bool allowAnyLength = false) { GetData (buffer, true, allowAnyLength); }
 		static shared_ptr <Hash> GetHash ();
@@ -41,10 +43,13 @@ namespace VeraCrypt
 		static void AddSystemDataToPool (bool fast);
 		static void GetData (const BufferPtr &buffer, bool fast, bool allowAnyLength);
 		static void HashMixPool ();
+		static void ReseedStream ();
 		static void Test ();
 		RandomNumberGenerator ();
 
 		static const size_t MaxBytesAddedBeforePoolHashMix = RANDMIX_BYTE_INTERVAL;
+		static const uint64 MaxStreamBytesBeforeReseed = 64 * BYTES_PER_MB;
+		static const size_t StreamSegmentSize = 1024 * 1024;
 
 		static Mutex AccessMutex;
 		static size_t BytesAddedSincePoolHashMix;
@@ -56,6 +61,10 @@ namespace VeraCrypt
 		static size_t WriteOffset;
 		static struct rand_data *JitterRngCtx;
 		static int DevRandomBytesCount;
+
+		static SecureBuffer StreamContext;
+		static uint64 StreamBytesSinceReseed;
+		static Mutex StreamMutex;
 	};
 }
 
@@ -200,6 +200,17 @@ namespace VeraCrypt
 						continue;
 					}
 
+					// MountVolumesRequest
+					MountVolumesRequest *mountVolumesRequest = dynamic_cast <MountVolumesRequest*> (request.get());
+					if (mountVolumesRequest)
+					{
+						MountVolumesResponse (
+							Core->MountVolumes (mountVolumesRequest->OptionsList, mountVolumesRequest->FirstSlotNumber)
+						).Serialize (outputStream);
+
+						continue;
+					}
+
 					// SetFileOwnerRequest
 					SetFileOwnerRequest *setFileOwnerRequest = dynamic_cast <SetFileOwnerRequest*> (request.get());
 					if (setFileOwnerRequest)
@@ -276,6 +287,21 @@ namespace VeraCrypt
 		return SendRequest <MountVolumeResponse> (request)->MountedVolumeInfo;
 	}
 
+	BatchMountResultList CoreService::RequestMountVolumes (const MountOptionsList &optionsList, VolumeSlotNumber firstSlotNumber)
+	{
+		MountVolumesRequest request (optionsList, firstSlotNumber);
+		BatchMountResultList results = SendRequest <MountVolumesResponse> (request)->Results;
+
+		if (results.size() != optionsList.size())
+			throw ParameterIncorrect (SRC_POS);
+
+		MountOptionsList::const_iterator options = optionsList.begin();
+		for (BatchMountResultList::iterator result = results.begin(); result != results.end(); ++result)
+			result->Options = *options++;
+
+		return results;
+	}
+
 	void CoreService::RequestSetFileOwner (const FilesystemPath &path, const UserId &owner)
 	{
 		SetFileOwnerRequest request (path, owner);
@@ -33,6 +33,7 @@ namespace VeraCrypt
 		static uint64 RequestGetDeviceSize (const DevicePath &devicePath);
 		static HostDeviceList RequestGetHostDevices (bool pathListOnly);
 		static shared_ptr <VolumeInfo> RequestMountVolume (MountOptions &options);
+		static BatchMountResultList RequestMountVolumes (const MountOptionsList &optionsList, VolumeSlotNumber firstSlotNumber);
 		static void RequestSetFileOwner (const FilesystemPath &path, const UserId &owner);
 		static void SetAdminPasswordCallback (shared_ptr <GetStringFunctor> functor) { AdminPasswordCallback = functor; }
 		static void Start ();
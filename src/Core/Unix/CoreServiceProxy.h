@@ -136,6 +136,117 @@ namespace VeraCrypt
 			return mountedVolume;
 		}
 
+		virtual BatchMountResultList MountVolumes (const MountOptionsList &optionsList, VolumeSlotNumber firstSlotNumber = 0)
+		{
+			BatchMountResultList results;
+			MountOptionsList requestOptionsList;
+			MountOptionsList sourceOptionsList;
+			MountOptionsList cachedPasswordOptionsList;
+
+			foreach (shared_ptr <MountOptions> options, optionsList)
+			{
+				if (!VolumePasswordCache::IsEmpty()
+					&& (!options->Password || options->Password->IsEmpty())
+					&& (!options->Keyfiles || options->Keyfiles->empty()))
+				{
+					cachedPasswordOptionsList.push_back (options);
+					continue;
+				}
+
+				shared_ptr <MountOptions> newOptions (new MountOptions (*options));
+
+				newOptions->Password = Keyfile::ApplyListToPassword (options->Keyfiles, options->Password, options->EMVSupportEnabled);
+				if (newOptions->Keyfiles)
+					newOptions->Keyfiles->clear();
+
+				newOptions->ProtectionPassword = Keyfile::ApplyListToPassword (options->ProtectionKeyfiles, options->ProtectionPassword, options->EMVSupportEnabled);
+				if (newOptions->ProtectionKeyfiles)
+					newOptions->ProtectionKeyfiles->clear();
+
+				requestOptionsList.push_back (newOptions);
+				sourceOptionsList.push_back (options);
+			}
+
+			if (!requestOptionsList.empty())
+			{
+				MountOptionsList::const_iterator options = sourceOptionsList.begin();
+				foreach (BatchMountResult result, CoreService::RequestMountVolumes (requestOptionsList, firstSlotNumber))
+				{
+					result.Options = *options++;
+
+					if (result.Error)
+					{
+						if (dynamic_cast <ProtectionPasswordIncorrect *> (result.Error.get()))
+						{
+							if (result.Options->ProtectionKeyfiles && !result.Options->ProtectionKeyfiles->empty())
+								result.Error.reset (new ProtectionPasswordKeyfilesIncorrect (result.Error->what()));
+						}
+						else if (dynamic_cast <PasswordIncorrect *> (result.Error.get()))
+						{
+							if (result.Options->Keyfiles && !result.Options->Keyfiles->empty())
+								result.Error.reset (new PasswordKeyfilesIncorrect (result.Error->what()));
+						}
+					}
+					else if (result.Options->CachePassword
+						&& ((result.Options->Password && !result.Options->Password->IsEmpty()) || (result.Options->Keyfiles && !result.Options->Keyfiles->empty())))
+					{
+						VolumePasswordCache::Store (*Keyfile::ApplyListToPassword (result.Options->Keyfiles, result.Options->Password, result.Options->EMVSupportEnabled));
+					}
+
+					results.push_back (result);
+				}
+			}
+
+			// Volumes without a password are tried with each cached password in turn
+			foreach (shared_ptr <VolumePassword> password, VolumePasswordCache::GetPasswords())
+			{
+				if (cachedPasswordOptionsList.empty())
+					break;
+
+				requestOptionsList.clear();
+				foreach (shared_ptr <MountOptions> options, cachedPasswordOptionsList)
+				{
+					shared_ptr <MountOptions> newOptions (new MountOptions (*options));
+					newOptions->Password = password;
+					requestOptionsList.push_back (newOptions);
+				}
+
+				MountOptionsList remainingOptionsList;
+				MountOptionsList::const_iterator options = cachedPasswordOptionsList.begin();
+
+				foreach (BatchMountResult result, CoreService::RequestMountVolumes (requestOptionsList, firstSlotNumber))
+				{
+					result.Options = *options++;
+
+					if (result.Error && dynamic_cast <PasswordIncorrect *> (result.Error.get()))
+						remainingOptionsList.push_back (result.Options);
+					else
+						results.push_back (result);
+				}
+
+				cachedPasswordOptionsList = remainingOptionsList;
+			}
+
+			foreach (shared_ptr <MountOptions> options, cachedPasswordOptionsList)
+			{
+				BatchMountResult result;
+				result.Options = options;
+				result.Error.reset (new PasswordIncorrect (SRC_POS));
+				results.push_back (result);
+			}
+
+			foreach (const BatchMountResult &result, results)
+			{
+				if (result.MountedVolume)
+				{
+					VolumeEventArgs eventArgs (result.MountedVolume);
+					T::VolumeMountedEvent.Raise (eventArgs);
+				}
+			}
+
+			return results;
+		}
+
 		virtual void SetAdminPasswordCallback (shared_ptr <GetStringFunctor> functor)
 		{
 			CoreService::SetAdminPasswordCallback (functor);
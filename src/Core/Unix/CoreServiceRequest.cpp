@@ -236,6 +236,34 @@ namespace VeraCrypt
 		Options->Serialize (stream);
 	}
 
+	// MountVolumesRequest
+	void MountVolumesRequest::Deserialize (shared_ptr <Stream> stream)
+	{
+		CoreServiceRequest::Deserialize (stream);
+		Serializer sr (stream);
+		sr.Deserialize ("FirstSlotNumber", FirstSlotNumber);
+		Serializable::DeserializeList (stream, OptionsList);
+	}
+
+	bool MountVolumesRequest::RequiresElevation () const
+	{
+		foreach (shared_ptr <MountOptions> options, OptionsList)
+		{
+			if (MountVolumeRequest (options.get()).RequiresElevation())
+				return true;
+		}
+
+		return false;
+	}
+
+	void MountVolumesRequest::Serialize (shared_ptr <Stream> stream) const
+	{
+		CoreServiceRequest::Serialize (stream);
+		Serializer sr (stream);
+		sr.Serialize ("FirstSlotNumber", FirstSlotNumber);
+		Serializable::SerializeList (stream, OptionsList);
+	}
+
 	// SetFileOwnerRequest
 	void SetFileOwnerRequest::Deserialize (shared_ptr <Stream> stream)
 	{
@@ -275,5 +303,6 @@ namespace VeraCrypt
 	TC_SERIALIZER_FACTORY_ADD_CLASS (GetDeviceSizeRequest);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (GetHostDevicesRequest);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (MountVolumeRequest);
+	TC_SERIALIZER_FACTORY_ADD_CLASS (MountVolumesRequest);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (SetFileOwnerRequest);
 }
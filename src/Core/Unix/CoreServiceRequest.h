@@ -127,6 +127,18 @@ namespace VeraCrypt
 	};
 
 
+	struct MountVolumesRequest : CoreServiceRequest
+	{
+		MountVolumesRequest () { }
+		MountVolumesRequest (const MountOptionsList &optionsList, VolumeSlotNumber firstSlotNumber) : FirstSlotNumber (firstSlotNumber), OptionsList (optionsList) { }
+		TC_SERIALIZABLE (MountVolumesRequest);
+
+		virtual bool RequiresElevation () const;
+
+		VolumeSlotNumber FirstSlotNumber;
+		MountOptionsList OptionsList;
+	};
+
 	struct SetFileOwnerRequest : CoreServiceRequest
 	{
 		SetFileOwnerRequest () { }
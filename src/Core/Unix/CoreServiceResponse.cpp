@@ -102,6 +102,50 @@ namespace VeraCrypt
 		MountedVolumeInfo->Serialize (stream);
 	}
 
+	// MountVolumesResponse
+	void MountVolumesResponse::Deserialize (shared_ptr <Stream> stream)
+	{
+		Serializer sr (stream);
+
+		uint64 resultCount;
+		sr.Deserialize ("ResultCount", resultCount);
+
+		for (uint64 i = 0; i < resultCount; ++i)
+		{
+			BatchMountResult result;
+
+			bool mounted;
+			sr.Deserialize ("Mounted", mounted);
+
+			if (mounted)
+				result.MountedVolume = Serializable::DeserializeNew <VolumeInfo> (stream);
+			else
+				result.Error = Serializable::DeserializeNew <Exception> (stream);
+
+			Results.push_back (result);
+		}
+	}
+
+	void MountVolumesResponse::Serialize (shared_ptr <Stream> stream) const
+	{
+		Serializable::Serialize (stream);
+		Serializer sr (stream);
+
+		sr.Serialize ("ResultCount", (uint64) Results.size());
+
+		foreach (const BatchMountResult &result, Results)
+		{
+			sr.Serialize ("Mounted", result.MountedVolume ? true : false);
+
+			if (result.MountedVolume)
+				result.MountedVolume->Serialize (stream);
+			else if (result.Error)
+				result.Error->Serialize (stream);
+			else
+				ParameterIncorrect (SRC_POS).Serialize (stream);
+		}
+	}
+
 	// SetFileOwnerResponse
 	void SetFileOwnerResponse::Deserialize (shared_ptr <Stream> stream)
 	{
@@ -119,5 +163,6 @@ namespace VeraCrypt
 	TC_SERIALIZER_FACTORY_ADD_CLASS (GetDeviceSizeResponse);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (GetHostDevicesResponse);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (MountVolumeResponse);
+	TC_SERIALIZER_FACTORY_ADD_CLASS (MountVolumesResponse);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (SetFileOwnerResponse);
 }
@@ -78,6 +78,15 @@ namespace VeraCrypt
 		shared_ptr <VolumeInfo> MountedVolumeInfo;
 	};
 
+	struct MountVolumesResponse : CoreServiceResponse
+	{
+		MountVolumesResponse () { }
+		MountVolumesResponse (const BatchMountResultList &results) : Results (results) { }
+		TC_SERIALIZABLE (MountVolumesResponse);
+
+		BatchMountResultList Results;
+	};
+
 	struct SetFileOwnerResponse : CoreServiceResponse
 	{
 		SetFileOwnerResponse () { }
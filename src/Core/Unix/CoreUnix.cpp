@@ -13,13 +13,16 @@
 #include "CoreUnix.h"
 #include <errno.h>
 #include <iostream>
+#include <set>
 #include <signal.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <stdio.h>
 #include <unistd.h>
 #include "Platform/FileStream.h"
+#include "Platform/SharedVal.h"
 #include "Driver/Fuse/FuseService.h"
+#include "Volume/EncryptionThreadPool.h"
 #include "Volume/VolumePasswordCache.h"
 
 namespace VeraCrypt
@@ -599,6 +602,188 @@ namespace VeraCrypt
 		if (IsVolumeMounted (*options.Path))
 			throw VolumeAlreadyMounted (SRC_POS);
 
+		CheckMountPoint (options);
+
+		Cipher::EnableHwSupport (!options.NoHardwareCrypto);
+
+		shared_ptr <Volume> volume = OpenVolumeForMount (options);
+		shared_ptr <VolumeInfo> mountedVolume = MountOpenVolume (volume, options);
+
+		VolumeEventArgs eventArgs (mountedVolume);
+		VolumeMountedEvent.Raise (eventArgs);
+
+		return mountedVolume;
+	}
+
+	BatchMountResultList CoreUnix::MountVolumes (const MountOptionsList &optionsList, VolumeSlotNumber firstSlotNumber)
+	{
+		vector <BatchMountResult> results (optionsList.size());
+		vector < shared_ptr <Volume> > volumes (optionsList.size());
+
+		size_t i = 0;
+		foreach (shared_ptr <MountOptions> options, optionsList)
+			results[i++].Options = options;
+
+		// Header trials are CPU-bound and run concurrently, limited to the number of CPUs and,
+		// for memory-hard key derivation functions, to the available memory
+		struct OpenVolumeFunctor : public Functor
+		{
+			OpenVolumeFunctor (const CoreUnix *core, const vector <size_t> &items, vector <BatchMountResult> &results, vector < shared_ptr <Volume> > &volumes, SharedVal <size_t> &nextItem)
+				: Core (core), Items (items), Results (results), Volumes (volumes), NextItem (nextItem) { }
+
+			virtual void operator() ()
+			{
+				size_t next;
+				while ((next = NextItem.Increment() - 1) < Items.size())
+				{
+					size_t item = Items[next];
+					BatchMountResult &result = Results[item];
+					try
+					{
+						if (Core->IsVolumeMounted (*result.Options->Path))
+							throw VolumeAlreadyMounted (SRC_POS);
+
+						Volumes[item] = Core->OpenVolumeForMount (*result.Options);
+					}
+					catch (Exception &e)
+					{
+						result.Error.reset (e.CloneNew());
+					}
+					catch (exception &e)
+					{
+						result.Error.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+					}
+				}
+			}
+
+			const CoreUnix *Core;
+			const vector <size_t> &Items;
+			vector <BatchMountResult> &Results;
+			vector < shared_ptr <Volume> > &Volumes;
+			SharedVal <size_t> &NextItem;
+		};
+
+		struct MountOpenVolumeFunctor : public Functor
+		{
+			MountOpenVolumeFunctor (CoreUnix *core, const vector <size_t> &items, vector <BatchMountResult> &results, vector < shared_ptr <Volume> > &volumes, SharedVal <size_t> &nextItem)
+				: Core (core), Items (items), Results (results), Volumes (volumes), NextItem (nextItem) { }
+
+			virtual void operator() ()
+			{
+				size_t next;
+				while ((next = NextItem.Increment() - 1) < Items.size())
+				{
+					size_t item = Items[next];
+					if (!Volumes[item])
+						continue;
+
+					BatchMountResult &result = Results[item];
+					try
+					{
+						result.MountedVolume = Core->MountOpenVolume (Volumes[item], *result.Options);
+					}
+					catch (Exception &e)
+					{
+						result.Error.reset (e.CloneNew());
+					}
+					catch (exception &e)
+					{
+						result.Error.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+					}
+
+					Volumes[item].reset();
+				}
+			}
+
+			CoreUnix *Core;
+			const vector <size_t> &Items;
+			vector <BatchMountResult> &Results;
+			vector < shared_ptr <Volume> > &Volumes;
+			SharedVal <size_t> &NextItem;
+		};
+
+		// Hardware acceleration is a process-wide setting and must not be changed while header trials are running.
+		// Volumes are therefore processed in two groups, each with its own setting.
+		set <VolumeSlotNumber> reservedSlots;
+		for (int noHardwareCrypto = 0; noHardwareCrypto < 2; ++noHardwareCrypto)
+		{
+			vector <size_t> items;
+			for (i = 0; i < results.size(); ++i)
+			{
+				if (results[i].Options->NoHardwareCrypto == (noHardwareCrypto != 0))
+					items.push_back (i);
+			}
+
+			if (items.empty())
+				continue;
+
+			Cipher::EnableHwSupport (noHardwareCrypto == 0);
+
+			uint64 memoryCost = 0;
+			foreach (size_t item, items)
+			{
+				uint64 itemMemoryCost = GetKeyDerivationMemoryCost (*results[item].Options);
+				if (itemMemoryCost > memoryCost)
+					memoryCost = itemMemoryCost;
+			}
+
+			SharedVal <size_t> nextItem (0);
+			RunConcurrently (items.size(), new OpenVolumeFunctor (this, items, results, volumes, nextItem), EncryptionThreadPool::GetMaxConcurrentKeyDerivations (memoryCost));
+
+			// Slots are assigned sequentially so that automatically numbered volumes do not collide
+			foreach (size_t item, items)
+			{
+				if (!volumes[item])
+					continue;
+
+				MountOptions &options = *results[item].Options;
+				try
+				{
+					if (options.SlotNumber < GetFirstSlotNumber() && (!options.MountPoint || options.MountPoint->IsEmpty()))
+					{
+						VolumeSlotNumber slotNumber = GetFirstFreeSlotNumber (firstSlotNumber);
+						while (reservedSlots.find (slotNumber) != reservedSlots.end())
+							slotNumber = GetFirstFreeSlotNumber (slotNumber + 1);
+
+						options.SlotNumber = slotNumber;
+					}
+
+					CoalesceSlotNumberAndMountPoint (options);
+
+					if (reservedSlots.find (options.SlotNumber) != reservedSlots.end())
+						throw VolumeSlotUnavailable (SRC_POS);
+
+					CheckMountPoint (options);
+					reservedSlots.insert (options.SlotNumber);
+				}
+				catch (Exception &e)
+				{
+					results[item].Error.reset (e.CloneNew());
+					volumes[item].reset();
+				}
+			}
+
+			nextItem.Set (0);
+			RunConcurrently (items.size(), new MountOpenVolumeFunctor (this, items, results, volumes, nextItem), EncryptionThreadPool::GetCpuCount());
+		}
+
+		BatchMountResultList resultList;
+		foreach (const BatchMountResult &result, results)
+		{
+			if (result.MountedVolume)
+			{
+				VolumeEventArgs eventArgs (result.MountedVolume);
+				VolumeMountedEvent.Raise (eventArgs);
+			}
+
+			resultList.push_back (result);
+		}
+
+		return resultList;
+	}
+
+	void CoreUnix::CheckMountPoint (const MountOptions &options) const
+	{
 		if (options.MountPoint && !options.MountPoint->IsEmpty())
 		{
 			// Reject if the mount point is a system directory
@@ -609,9 +794,28 @@ namespace VeraCrypt
 			if (!GetAllowInsecureMount() && IsDirectoryOnUserPath(*options.MountPoint))
 				throw MountPointNotAllowed (SRC_POS);
 		}
+	}
 
-		Cipher::EnableHwSupport (!options.NoHardwareCrypto);
+	uint64 CoreUnix::GetKeyDerivationMemoryCost (const MountOptions &options)
+	{
+		// Header trials derive keys with the specified function or, if none is specified, with each of them in turn
+		uint64 memoryCost = 0;
+		foreach (shared_ptr <Pkcs5Kdf> kdf, Pkcs5Kdf::GetAvailableAlgorithms())
+		{
+			if ((!options.Kdf || options.Kdf->GetName() == kdf->GetName()) && kdf->GetMemoryCost (options.Pim) > memoryCost)
+				memoryCost = kdf->GetMemoryCost (options.Pim);
 
+			if (options.Protection == VolumeProtection::HiddenVolumeReadOnly
+				&& (!options.ProtectionKdf || options.ProtectionKdf->GetName() == kdf->GetName())
+				&& kdf->GetMemoryCost (options.ProtectionPim) > memoryCost)
+				memoryCost = kdf->GetMemoryCost (options.ProtectionPim);
+		}
+
+		return memoryCost;
+	}
+
+	shared_ptr <Volume> CoreUnix::OpenVolumeForMount (MountOptions &options) const
+	{
 		shared_ptr <Volume> volume;
 
 		while (true)
@@ -634,10 +838,12 @@ namespace VeraCrypt
 					options.SharedAccessAllowed,
 					VolumeType::Unknown,
 					options.UseBackupHeaders,
-					options.PartitionInSystemEncryptionScope
+					options.PartitionInSystemEncryptionScope,
+					options.TrialHint
 					);
 
 				options.Password.reset();
+				options.TrialHint.HeaderKey.reset();
 			}
 			catch (SystemException &e)
 			{
@@ -650,20 +856,18 @@ namespace VeraCrypt
 				}
 
 				options.Password.reset();
+				options.TrialHint.HeaderKey.reset();
 				throw;
 			}
 
 			break;
 		}
 
-		if (options.Path->IsDevice())
-		{
-			const uint32 devSectorSize = volume->GetFile()->GetDeviceSectorSize();
-			const size_t volSectorSize = volume->GetSectorSize();
-			if (devSectorSize != volSectorSize)
-				throw DeviceSectorSizeMismatch (SRC_POS, StringConverter::ToWide(devSectorSize) + L" != " + StringConverter::ToWide((uint32) volSectorSize));
-		}
+		return volume;
+	}
 
+	string CoreUnix::CreateFuseMountDirectory () const
+	{
 		// Find a free mount point for FUSE service
 		MountedFilesystemList mountedFilesystems = GetMountedFilesystems ();
 		string fuseMountPoint;
@@ -704,18 +908,43 @@ namespace VeraCrypt
 			}
 		}
 
-		try
+		return fuseMountPoint;
+	}
+
+	shared_ptr <VolumeInfo> CoreUnix::MountOpenVolume (shared_ptr <Volume> volume, MountOptions &options)
+	{
+		if (volume->IsInPlaceEncryptionInProgress())
+			throw VolumeEncryptionNotCompleted (SRC_POS);
+
+		if (options.Path->IsDevice())
 		{
-			FuseService::Mount (volume, options.SlotNumber, fuseMountPoint);
+			const uint32 devSectorSize = volume->GetFile()->GetDeviceSectorSize();
+			const size_t volSectorSize = volume->GetSectorSize();
+			if (devSectorSize != volSectorSize)
+				throw DeviceSectorSizeMismatch (SRC_POS, StringConverter::ToWide(devSectorSize) + L" != " + StringConverter::ToWide((uint32) volSectorSize));
 		}
-		catch (...)
+
+		string fuseMountPoint;
 		{
+			// Allocation of the FUSE mount directory is not atomic and must be serialized until the FUSE service is mounted
+			static Mutex fuseMountMutex;
+			ScopeLock lock (fuseMountMutex);
+
+			fuseMountPoint = CreateFuseMountDirectory();
+
 			try
 			{
-				DirectoryPath (fuseMountPoint).Delete();
+				FuseService::Mount (volume, options.SlotNumber, fuseMountPoint);
+			}
+			catch (...)
+			{
+				try
+				{
+					DirectoryPath (fuseMountPoint).Delete();
+				}
+				catch (...) { }
+				throw;
 			}
-			catch (...) { }
-			throw;
 		}
 
 		try
@@ -795,12 +1024,42 @@ namespace VeraCrypt
 		if (mountedVolumes.size() != 1)
 			throw ParameterIncorrect (SRC_POS);
 
-		VolumeEventArgs eventArgs (mountedVolumes.front());
-		VolumeMountedEvent.Raise (eventArgs);
-
 		return mountedVolumes.front();
 	}
 
+	void CoreUnix::RunConcurrently (size_t itemCount, Functor *workFunctor, size_t maxThreadCount)
+	{
+		shared_ptr <Functor> functor (workFunctor);
+
+		size_t threadCount = maxThreadCount;
+		if (threadCount > itemCount)
+			threadCount = itemCount;
+
+		if (threadCount < 2)
+		{
+			(*functor)();
+			return;
+		}
+
+		struct ThreadFunctor : public Functor
+		{
+			ThreadFunctor (shared_ptr <Functor> functor) : WorkFunctor (functor) { }
+			virtual void operator() () { (*WorkFunctor)(); }
+			shared_ptr <Functor> WorkFunctor;
+		};
+
+		list < shared_ptr <Thread> > threads;
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			make_shared_auto (Thread, thread);
+			thread->Start (new ThreadFunctor (functor));
+			threads.push_back (thread);
+		}
+
+		foreach_ref (const Thread &thread, threads)
+			thread.Join();
+	}
+
 	void CoreUnix::MountAuxVolumeImage (const DirectoryPath &auxMountPoint, const MountOptions &options) const
 	{
 		DevicePath loopDev = AttachFileToLoopDevice (string (auxMountPoint) + FuseService::GetVolumeImagePath(), options.Protection == VolumeProtection::ReadOnly);
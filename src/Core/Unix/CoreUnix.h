@@ -45,6 +45,7 @@ namespace VeraCrypt
 		virtual bool HasAdminPrivileges () const { return getuid() == 0 || geteuid() == 0; }
 		virtual VolumeSlotNumber MountPointToSlotNumber (const DirectoryPath &mountPoint) const;
 		virtual shared_ptr <VolumeInfo> MountVolume (MountOptions &options);
+		virtual BatchMountResultList MountVolumes (const MountOptionsList &optionsList, VolumeSlotNumber firstSlotNumber = 0);
 		virtual void SetFileOwner (const FilesystemPath &path, const UserId &owner) const;
 		virtual DirectoryPath SlotNumberToMountPoint (VolumeSlotNumber slotNumber) const;
 		virtual void WipePasswordCache () const { throw NotApplicable (SRC_POS); }
@@ -53,6 +54,8 @@ namespace VeraCrypt
 
 	protected:
 		virtual DevicePath AttachFileToLoopDevice (const FilePath &filePath, bool readOnly) const { throw NotApplicable (SRC_POS); }
+		virtual void CheckMountPoint (const MountOptions &options) const;
+		virtual string CreateFuseMountDirectory () const;
 		virtual void DetachLoopDevice (const DevicePath &devicePath) const { throw NotApplicable (SRC_POS); }
 		virtual void DismountNativeVolume (shared_ptr <VolumeInfo> mountedVolume) const { throw NotApplicable (SRC_POS); }
 		virtual bool FilesystemSupportsUnixPermissions (const DevicePath &devicePath) const;
@@ -64,7 +67,11 @@ namespace VeraCrypt
 		virtual string GetTempDirectory () const;
 		virtual void MountFilesystem (const DevicePath &devicePath, const DirectoryPath &mountPoint, const string &filesystemType, bool readOnly, const string &systemMountOptions) const;
 		virtual void MountAuxVolumeImage (const DirectoryPath &auxMountPoint, const MountOptions &options) const;
+		virtual shared_ptr <VolumeInfo> MountOpenVolume (shared_ptr <Volume> volume, MountOptions &options);
 		virtual void MountVolumeNative (shared_ptr <Volume> volume, MountOptions &options, const DirectoryPath &auxMountPoint) const { throw NotApplicable (SRC_POS); }
+		static uint64 GetKeyDerivationMemoryCost (const MountOptions &options);
+		virtual shared_ptr <Volume> OpenVolumeForMount (MountOptions &options) const;
+		static void RunConcurrently (size_t itemCount, Functor *workFunctor, size_t maxThreadCount);
 
 	private:
 		CoreUnix (const CoreUnix &);
@@ -321,6 +321,7 @@ namespace VeraCrypt
 			|| !xts
 			|| algoNotSupported
 			|| volume->IsEncryptionNotCompleted ()
+			|| volume->IsReEncryptionInProgress ()
 			|| volume->GetProtectionType() == VolumeProtection::HiddenVolumeReadOnly)
 		{
 			throw NotApplicable (SRC_POS);
@@ -18,6 +18,7 @@
 #include "Core.h"
 
 #ifdef TC_UNIX
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -29,7 +30,7 @@
 namespace VeraCrypt
 {
 	VolumeCreator::VolumeCreator ()
-		: SizeDone (0)
+		: ExtentCount (0), SizeDone (0)
 	{
 	}
 
@@ -48,6 +49,39 @@ namespace VeraCrypt
 			ThreadException->Throw();
 	}
 
+	void VolumeCreator::CreateFakeHiddenVolumeHeader (const BufferPtr &headerBuffer, shared_ptr <VolumeCreationOptions> options, uint64 hostSize)
+	{
+		VolumeLayoutV2Hidden hiddenLayout;
+		shared_ptr <VolumeHeader> hiddenHeader (hiddenLayout.GetHeader());
+
+		VolumeHeaderCreationOptions headerOptions;
+		headerOptions.EA = options->EA->GetNew();
+		headerOptions.Kdf = options->VolumeHeaderKdf;
+		headerOptions.Type = VolumeType::Hidden;
+
+		headerOptions.SectorSize = options->SectorSize;
+
+		headerOptions.VolumeDataStart = hostSize - hiddenLayout.GetHeaderSize() * 2 - options->Size;
+		headerOptions.VolumeDataSize = hiddenLayout.GetMaxDataSize (options->Size);
+
+		// Master data key
+		SecureBuffer hiddenMasterKey (options->EA->GetKeySize() * 2);
+		RandomNumberGenerator::GetBulkData (hiddenMasterKey);
+		headerOptions.DataKey = hiddenMasterKey;
+
+		// PKCS5 salt
+		SecureBuffer hiddenSalt (VolumeHeader::GetSaltSize());
+		RandomNumberGenerator::GetBulkData (hiddenSalt);
+		headerOptions.Salt = hiddenSalt;
+
+		// Header key
+		SecureBuffer hiddenHeaderKey (VolumeHeader::GetLargestSerializedKeySize());
+		RandomNumberGenerator::GetBulkData (hiddenHeaderKey);
+		headerOptions.HeaderKey = hiddenHeaderKey;
+
+		hiddenHeader->Create (headerBuffer, headerOptions);
+	}
+
 	void VolumeCreator::CreationThread ()
 	{
 		try
@@ -64,27 +98,66 @@ namespace VeraCrypt
 
 			VolumeFile->SeekAt (DataStart);
 
+			if (SourceFile)
+			{
+				// Contents of the source image are encrypted with the master key in a single pass
+				FormatDataArea (endOffset, DataStart, SourceFile);
+				SourceFile.reset();
+			}
 			// Create filesystem
-			if (Options->Filesystem == VolumeCreationOptions::FilesystemType::FAT)
+			else if (Options->Filesystem == VolumeCreationOptions::FilesystemType::FAT)
 			{
 				if (filesystemSize < TC_MIN_FAT_FS_SIZE || filesystemSize > TC_MAX_FAT_SECTOR_COUNT * Options->SectorSize)
 					throw ParameterIncorrect (SRC_POS);
 
-				struct WriteSectorCallback : public FatFormatter::WriteSectorCallback
+				// Regions of the filesystem are collected in a large buffer, which is encrypted in a single
+				// pass. Runs of empty sectors are zeroed directly in the buffer.
+				struct WriteRegionCallback : public FatFormatter::WriteRegionCallback
 				{
-					WriteSectorCallback (VolumeCreator *creator) : Creator (creator), OutputBuffer (File::GetOptimalWriteSize()), OutputBufferWritePos (0) { }
+					WriteRegionCallback (VolumeCreator *creator) : Creator (creator), OutputBuffer (creator->GetFormatChunkSize(), FormatBufferAlignment), OutputBufferWritePos (0) { }
 
-					virtual bool operator() (const BufferPtr &sector)
+					virtual bool WriteData (const ConstBufferPtr &data)
 					{
-						OutputBuffer.GetRange (OutputBufferWritePos, sector.Size()).CopyFrom (sector);
-						OutputBufferWritePos += sector.Size();
+						size_t dataPos = 0;
+
+						while (dataPos < data.Size())
+						{
+							size_t length = min (data.Size() - dataPos, OutputBuffer.Size() - OutputBufferWritePos);
+
+							OutputBuffer.GetRange (OutputBufferWritePos, length).CopyFrom (data.GetRange (dataPos, length));
+							OutputBufferWritePos += length;
+							dataPos += length;
+
+							if (OutputBufferWritePos >= OutputBuffer.Size())
+								FlushOutputBuffer();
 
-						if (OutputBufferWritePos >= OutputBuffer.Size())
-							FlushOutputBuffer();
+							if (Creator->AbortRequested)
+								return false;
+						}
 
 						return !Creator->AbortRequested;
 					}
 
+					virtual bool WriteZeros (uint64 length)
+					{
+						while (length > 0)
+						{
+							size_t zeroLength = (size_t) min ((uint64) (OutputBuffer.Size() - OutputBufferWritePos), length);
+
+							OutputBuffer.GetRange (OutputBufferWritePos, zeroLength).Zero();
+							OutputBufferWritePos += zeroLength;
+							length -= zeroLength;
+
+							if (OutputBufferWritePos >= OutputBuffer.Size())
+								FlushOutputBuffer();
+
+							if (Creator->AbortRequested)
+								return false;
+						}
+
+						return true;
+					}
+
 					void FlushOutputBuffer ()
 					{
 						if (OutputBufferWritePos > 0)
@@ -106,9 +179,9 @@ namespace VeraCrypt
 					size_t OutputBufferWritePos;
 				};
 
-				WriteSectorCallback sectorWriter (this);
-				FatFormatter::Format (sectorWriter, filesystemSize, Options->FilesystemClusterSize, Options->SectorSize);
-				sectorWriter.FlushOutputBuffer();
+				WriteRegionCallback regionWriter (this);
+				FatFormatter::Format (regionWriter, filesystemSize, Options->FilesystemClusterSize, Options->SectorSize);
+				regionWriter.FlushOutputBuffer();
 			}
 
 			if (!Options->Quick)
@@ -116,21 +189,7 @@ namespace VeraCrypt
 				// Empty sectors are encrypted with different key to randomize plaintext
 				Core->RandomizeEncryptionAlgorithmKey (Options->EA);
 
-				SecureBuffer outputBuffer (File::GetOptimalWriteSize());
-				uint64 dataFragmentLength = outputBuffer.Size();
-
-				while (!AbortRequested && WriteOffset < endOffset)
-				{
-					if (WriteOffset + dataFragmentLength > endOffset)
-						dataFragmentLength = endOffset - WriteOffset;
-
-					outputBuffer.Zero();
-					Options->EA->EncryptSectors (outputBuffer, WriteOffset / ENCRYPTION_DATA_UNIT_SIZE, dataFragmentLength / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
-					VolumeFile->Write (outputBuffer, (size_t) dataFragmentLength);
-
-					WriteOffset += dataFragmentLength;
-					SizeDone.Set (WriteOffset - DataStart);
-				}
+				FormatDataArea (endOffset, DataStart);
 			}
 
 			if (!AbortRequested)
@@ -143,9 +202,10 @@ namespace VeraCrypt
 				SecureBuffer backupHeaderSalt (VolumeHeader::GetSaltSize());
 				RandomNumberGenerator::GetData (backupHeaderSalt);
 
-				Options->VolumeHeaderKdf->DeriveKey (HeaderKey, *PasswordKey, Options->Pim, backupHeaderSalt);
+				SecureBuffer backupHeaderKey (VolumeHeader::GetLargestSerializedKeySize());
+				Options->VolumeHeaderKdf->DeriveKey (backupHeaderKey, *PasswordKey, Options->Pim, backupHeaderSalt);
 
-				Layout->GetHeader()->EncryptNew (backupHeader, backupHeaderSalt, HeaderKey, Options->VolumeHeaderKdf);
+				Layout->GetHeader()->EncryptNew (backupHeader, backupHeaderSalt, backupHeaderKey, Options->VolumeHeaderKdf);
 
 				if (Options->Quick || Options->Type == VolumeType::Hidden)
 					VolumeFile->SeekEnd (Layout->GetBackupHeaderOffset());
@@ -155,41 +215,21 @@ namespace VeraCrypt
 				if (Options->Type == VolumeType::Normal)
 				{
 					// Write fake random header to space reserved for hidden volume header
-					VolumeLayoutV2Hidden hiddenLayout;
-					shared_ptr <VolumeHeader> hiddenHeader (hiddenLayout.GetHeader());
-					SecureBuffer hiddenHeaderBuffer (hiddenLayout.GetHeaderSize());
-
-					VolumeHeaderCreationOptions headerOptions;
-					headerOptions.EA = Options->EA;
-					headerOptions.Kdf = Options->VolumeHeaderKdf;
-					headerOptions.Type = VolumeType::Hidden;
-
-					headerOptions.SectorSize = Options->SectorSize;
-
-					headerOptions.VolumeDataStart = HostSize - hiddenLayout.GetHeaderSize() * 2 - Options->Size;
-					headerOptions.VolumeDataSize = hiddenLayout.GetMaxDataSize (Options->Size);
-
-					// Master data key
-					SecureBuffer hiddenMasterKey(Options->EA->GetKeySize() * 2);
-					RandomNumberGenerator::GetData (hiddenMasterKey);
-					headerOptions.DataKey = hiddenMasterKey;
-
-					// PKCS5 salt
-					SecureBuffer hiddenSalt (VolumeHeader::GetSaltSize());
-					RandomNumberGenerator::GetData (hiddenSalt);
-					headerOptions.Salt = hiddenSalt;
-
-					// Header key
-					SecureBuffer hiddenHeaderKey (VolumeHeader::GetLargestSerializedKeySize());
-					RandomNumberGenerator::GetData (hiddenHeaderKey);
-					headerOptions.HeaderKey = hiddenHeaderKey;
-
-					hiddenHeader->Create (backupHeader, headerOptions);
-
+					CreateFakeHiddenVolumeHeader (backupHeader, Options, HostSize);
 					VolumeFile->Write (backupHeader);
 				}
 
 				VolumeFile->Flush();
+
+				// Report fragmentation of file containers where the host filesystem supports it
+				if (!Options->Path.IsDevice())
+				{
+					try
+					{
+						ExtentCount = VolumeFile->GetExtentCount();
+					}
+					catch (...) { }
+				}
 			}
 		}
 		catch (Exception &e)
@@ -205,6 +245,7 @@ namespace VeraCrypt
 			ThreadException.reset (new UnknownException (SRC_POS));
 		}
 
+		SourceFile.reset();
 		VolumeFile.reset();
 		mProgressInfo.CreationInProgress = false;
 	}
@@ -236,6 +277,10 @@ namespace VeraCrypt
 				(options->Path.IsDevice() || options->Type == VolumeType::Hidden) ? File::OpenReadWrite : File::CreateReadWrite,
 				File::ShareNone);
 
+			// Reserve space for the whole container up front so that the filesystem can allocate it in few extents
+			if (options->Preallocate && !options->Path.IsDevice() && options->Type == VolumeType::Normal)
+				VolumeFile->Allocate (options->Size);
+
 			HostSize = VolumeFile->Length();
 		}
 
@@ -298,6 +343,24 @@ namespace VeraCrypt
 			if (headerOptions.VolumeDataSize < 1)
 				throw ParameterIncorrect (SRC_POS);
 
+			// Source image ("-" denotes standard input)
+			if (options->SourceImage)
+			{
+				SourceFile.reset (new File);
+
+				if (wstring (*options->SourceImage) == L"-")
+				{
+					SourceFile->AssignSystemHandle (STDIN_FILENO);
+				}
+				else
+				{
+					SourceFile->Open (*options->SourceImage);
+
+					if (SourceFile->Length() > headerOptions.VolumeDataSize)
+						throw ParameterTooLarge (SRC_POS);
+				}
+			}
+
 			// Master data key
 			MasterKey.Allocate (options->EA->GetKeySize() * 2);
 			RandomNumberGenerator::GetData (MasterKey);
@@ -319,6 +382,12 @@ namespace VeraCrypt
 			options->VolumeHeaderKdf->DeriveKey (HeaderKey, *PasswordKey, options->Pim, salt);
 			headerOptions.HeaderKey = HeaderKey;
 
+			// Keep the header key to allow the new volume to be opened without deriving it again
+			DerivedHeaderKey.reset (new VolumeHeaderKey);
+			DerivedHeaderKey->Kdf = options->VolumeHeaderKdf->GetName();
+			DerivedHeaderKey->Key.CopyFrom (HeaderKey);
+			DerivedHeaderKey->Salt.CopyFrom (salt);
+
 			header->Create (headerBuffer, headerOptions);
 
 			// Write new header
@@ -332,32 +401,7 @@ namespace VeraCrypt
 			if (options->Type == VolumeType::Normal)
 			{
 				// Write fake random header to space reserved for hidden volume header
-				VolumeLayoutV2Hidden hiddenLayout;
-				shared_ptr <VolumeHeader> hiddenHeader (hiddenLayout.GetHeader());
-				SecureBuffer hiddenHeaderBuffer (hiddenLayout.GetHeaderSize());
-
-				headerOptions.Type = VolumeType::Hidden;
-
-				headerOptions.VolumeDataStart = HostSize - hiddenLayout.GetHeaderSize() * 2 - options->Size;
-				headerOptions.VolumeDataSize = hiddenLayout.GetMaxDataSize (options->Size);
-
-				// Master data key
-				SecureBuffer hiddenMasterKey(options->EA->GetKeySize() * 2);
-				RandomNumberGenerator::GetData (hiddenMasterKey);
-				headerOptions.DataKey = hiddenMasterKey;
-
-				// PKCS5 salt
-				SecureBuffer hiddenSalt (VolumeHeader::GetSaltSize());
-				RandomNumberGenerator::GetData (hiddenSalt);
-				headerOptions.Salt = hiddenSalt;
-
-				// Header key
-				SecureBuffer hiddenHeaderKey (VolumeHeader::GetLargestSerializedKeySize());
-				RandomNumberGenerator::GetData (hiddenHeaderKey);
-				headerOptions.HeaderKey = hiddenHeaderKey;
-
-				hiddenHeader->Create (headerBuffer, headerOptions);
-
+				CreateFakeHiddenVolumeHeader (headerBuffer, options, HostSize);
 				VolumeFile->Write (headerBuffer);
 			}
 
@@ -392,11 +436,460 @@ namespace VeraCrypt
 		}
 		catch (...)
 		{
+			SourceFile.reset();
 			VolumeFile.reset();
 			throw;
 		}
 	}
 
+	void VolumeCreator::ExpandVolume (shared_ptr <VolumeExpansionOptions> options)
+	{
+		EncryptionTest::TestAll();
+
+		shared_ptr <Volume> volume;
+		{
+#ifdef TC_UNIX
+			// Temporarily take ownership of a device if the user is not an administrator
+			UserId origDeviceOwner ((uid_t) -1);
+
+			if (!Core->HasAdminPrivileges() && options->Path.IsDevice())
+			{
+				origDeviceOwner = FilesystemPath (wstring (options->Path)).GetOwner();
+				Core->SetFileOwner (options->Path, UserId (getuid()));
+			}
+
+			finally_do_arg2 (FilesystemPath, options->Path, UserId, origDeviceOwner,
+			{
+				if (finally_arg2.SystemId != (uid_t) -1)
+					Core->SetFileOwner (finally_arg, finally_arg2);
+			});
+#endif
+
+			volume = Core->OpenVolume (shared_ptr <VolumePath> (new VolumePath (options->Path)), false, options->Password, options->Pim, options->Kdf, options->Keyfiles, options->EMVSupportEnabled);
+		}
+
+		if (volume->IsEncryptionNotCompleted() || volume->IsReEncryptionInProgress())
+			throw VolumeEncryptionNotCompleted (SRC_POS);
+
+		// Only normal volumes whose backup headers are stored at the end of the host can be expanded
+		shared_ptr <VolumeHeader> header = volume->GetHeader();
+		if (typeid (*volume->GetLayout()) != typeid (VolumeLayoutV2Normal)
+			|| (header->GetFlags() & TC_HEADER_FLAG_ENCRYPTED_SYSTEM) != 0)
+		{
+			throw ParameterIncorrect (SRC_POS);
+		}
+
+		Layout = volume->GetLayout();
+		VolumeFile = volume->GetFile();
+
+		uint64 sectorSize = header->GetSectorSize();
+		DataStart = header->GetEncryptedAreaStart() + header->GetVolumeDataSize();
+		OldHostSize = DataStart - Layout->GetBackupHeaderOffset();
+
+		HostSize = options->Path.IsDevice() ? VolumeFile->Length() : options->Size;
+		HostSize -= HostSize % sectorSize;
+
+		// The previous backup headers remain intact until the new headers have been written
+		if (HostSize < OldHostSize + TC_VOLUME_HEADER_GROUP_SIZE)
+			throw ParameterIncorrect (SRC_POS);
+
+		// Data area is extended over the previous backup headers up to the new ones
+		make_shared_auto (VolumeCreationOptions, creationOptions);
+		creationOptions->Path = options->Path;
+		creationOptions->Type = VolumeType::Normal;
+		creationOptions->Size = HostSize;
+		creationOptions->VolumeHeaderKdf = volume->GetPkcs5Kdf();
+		creationOptions->EA = volume->GetEncryptionAlgorithm()->GetNew();
+		creationOptions->Quick = options->Quick;
+		creationOptions->SectorSize = (uint32) sectorSize;
+		creationOptions->FormatChunkSize = options->FormatChunkSize;
+		creationOptions->FormatQueueDepth = options->FormatQueueDepth;
+		creationOptions->FormatDirectIO = options->FormatDirectIO;
+
+#ifdef WOLFCRYPT_BACKEND
+		creationOptions->EA->SetMode (shared_ptr <EncryptionMode> (new EncryptionModeWolfCryptXTS ()));
+#else
+		creationOptions->EA->SetMode (shared_ptr <EncryptionMode> (new EncryptionModeXTS ()));
+#endif
+		// Sectors of the new area are encrypted with a random key to randomize plaintext
+		Core->RandomizeEncryptionAlgorithmKey (creationOptions->EA);
+
+		if (!options->Path.IsDevice())
+		{
+			try
+			{
+				// Space is reserved by the host filesystem without writing data
+				VolumeFile->Allocate (HostSize);
+			}
+			catch (SystemException &e)
+			{
+				// Hosts not supporting preallocation are extended by writing the new area and headers
+#ifdef TC_UNIX
+				if (e.GetErrorCode() != EOPNOTSUPP && e.GetErrorCode() != ENOTSUP
+#ifdef TC_FREEBSD
+					&& e.GetErrorCode() != EINVAL	// posix_fallocate() is not supported by the filesystem
+#endif
+					)
+				{
+					throw;
+				}
+#else
+				throw;
+#endif
+			}
+			catch (NotImplemented &) { }
+		}
+
+		Options = creationOptions;
+		ExpansionOptions = options;
+		ExpandedVolume = volume;
+		AbortRequested = false;
+		SizeDone.Set (0);
+
+		mProgressInfo.TotalSize = HostSize - OldHostSize;
+		mProgressInfo.CreationInProgress = true;
+
+		struct ThreadFunctor : public Functor
+		{
+			ThreadFunctor (VolumeCreator *creator) : Creator (creator) { }
+			virtual void operator() ()
+			{
+				Creator->ExpansionThread ();
+			}
+			VolumeCreator *Creator;
+		};
+
+		Thread thread;
+		thread.Start (new ThreadFunctor (this));
+	}
+
+	void VolumeCreator::ExpansionThread ()
+	{
+		bool headersWritten = false;
+
+		try
+		{
+			uint64 dataEnd = HostSize + Layout->GetBackupHeaderOffset();
+
+			WriteOffset = OldHostSize;
+			VolumeFile->SeekAt (WriteOffset);
+
+			if (!Options->Quick)
+				FormatDataArea (dataEnd, OldHostSize);
+
+			if (!AbortRequested)
+			{
+				// Backup headers are written first to keep the volume accessible if the primary header cannot be updated
+				shared_ptr <VolumeHeader> header = ExpandedVolume->GetHeader();
+				header->SetVolumeDataSize (dataEnd - header->GetEncryptedAreaStart());
+				header->SetEncryptedArea (header->GetEncryptedAreaStart(), dataEnd - header->GetEncryptedAreaStart());
+
+				SecureBuffer headerBuffer (Layout->GetHeaderSize());
+
+				Core->ReEncryptVolumeHeaderWithNewSalt (headerBuffer, header, ExpansionOptions->Password, ExpansionOptions->Pim, ExpansionOptions->Keyfiles, ExpansionOptions->EMVSupportEnabled);
+				VolumeFile->WriteAt (headerBuffer, dataEnd);
+
+				CreateFakeHiddenVolumeHeader (headerBuffer, Options, HostSize);
+				VolumeFile->WriteAt (headerBuffer, dataEnd + Layout->GetHeaderSize());
+				VolumeFile->Flush();
+
+				Core->ReEncryptVolumeHeaderWithNewSalt (headerBuffer, header, ExpansionOptions->Password, ExpansionOptions->Pim, ExpansionOptions->Keyfiles, ExpansionOptions->EMVSupportEnabled);
+				VolumeFile->WriteAt (headerBuffer, Layout->GetHeaderOffset());
+				VolumeFile->Flush();
+
+				headersWritten = true;
+
+				// The previous backup headers could be decrypted with the current password even after it is changed
+				SecureBuffer wipeBuffer (TC_VOLUME_HEADER_GROUP_SIZE);
+				wipeBuffer.Zero();
+				Options->EA->EncryptSectors (wipeBuffer, DataStart / ENCRYPTION_DATA_UNIT_SIZE, wipeBuffer.Size() / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
+
+				VolumeFile->WriteAt (wipeBuffer, DataStart);
+				VolumeFile->Flush();
+
+				SizeDone.Set (mProgressInfo.TotalSize);
+			}
+		}
+		catch (Exception &e)
+		{
+			ThreadException.reset (e.CloneNew());
+		}
+		catch (exception &e)
+		{
+			ThreadException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+		}
+		catch (...)
+		{
+			ThreadException.reset (new UnknownException (SRC_POS));
+		}
+
+		// An incomplete expansion of a file container is reverted
+		if (!headersWritten && !Options->Path.IsDevice())
+		{
+			try
+			{
+				VolumeFile->Truncate (OldHostSize);
+			}
+			catch (...) { }
+		}
+
+		ExpandedVolume.reset();
+		VolumeFile.reset();
+		mProgressInfo.CreationInProgress = false;
+	}
+
+	size_t VolumeCreator::GetFormatChunkSize () const
+	{
+		size_t chunkSize = Options->FormatChunkSize > 0 ? Options->FormatChunkSize : DefaultFormatChunkSize;
+		if (chunkSize > MaxFormatChunkSize)
+			chunkSize = MaxFormatChunkSize;
+
+		chunkSize -= chunkSize % FormatBufferAlignment;
+		if (chunkSize < FormatBufferAlignment)
+			chunkSize = FormatBufferAlignment;
+
+		return chunkSize;
+	}
+
+	void VolumeCreator::FormatDataArea (uint64 endOffset, uint64 progressStart, shared_ptr <File> source)
+	{
+		// Encryption of one chunk overlaps with writing of the previous ones, which are
+		// passed to a writer thread through a ring of buffers. Chunks contain zeros or,
+		// if a source is specified, its data up to its end.
+		size_t chunkSize = GetFormatChunkSize();
+
+		size_t queueDepth = Options->FormatQueueDepth > 0 ? Options->FormatQueueDepth : DefaultFormatQueueDepth;
+		if (queueDepth > MaxFormatQueueDepth)
+			queueDepth = MaxFormatQueueDepth;
+
+		struct FormatChunk
+		{
+			FormatChunk (size_t size) : Data (size, FormatBufferAlignment), Full (false), Length (0), Offset (0) { }
+
+			SecureBuffer Data;
+			SharedVal <bool> Full;
+			size_t Length;
+			uint64 Offset;
+		};
+
+		vector < shared_ptr <FormatChunk> > chunks;
+		for (size_t i = 0; i < queueDepth; ++i)
+			chunks.push_back (shared_ptr <FormatChunk> (new FormatChunk (chunkSize)));
+
+		// Aligned chunks bypass the page cache if requested and supported by the host
+		shared_ptr <File> directFile;
+		if (Options->FormatDirectIO)
+		{
+			try
+			{
+				directFile.reset (new File);
+				directFile->Open (Options->Path, File::OpenWrite, File::ShareReadWrite, File::DirectIO);
+			}
+			catch (SystemException &)
+			{
+				directFile.reset();
+			}
+		}
+
+		SyncEvent chunkFilledEvent;
+		SyncEvent chunkWrittenEvent;
+		// The exception is owned by the writer thread until it is joined. Its failure is published through a shared flag.
+		shared_ptr <Exception> writerException;
+		SharedVal <bool> writerFailed (false);
+
+		struct WriterFunctor : public Functor
+		{
+			WriterFunctor (VolumeCreator *creator, vector < shared_ptr <FormatChunk> > &chunks, shared_ptr <File> directFile, SyncEvent &chunkFilledEvent, SyncEvent &chunkWrittenEvent, shared_ptr <Exception> &writerException, SharedVal <bool> &writerFailed, uint64 progressStart)
+				: Chunks (chunks), ChunkFilledEvent (chunkFilledEvent), ChunkWrittenEvent (chunkWrittenEvent), Creator (creator), DirectFile (directFile), ProgressStart (progressStart), WriterException (writerException), WriterFailed (writerFailed)
+			{
+			}
+
+			virtual void operator() ()
+			{
+				for (size_t i = 0; ; i = (i + 1) % Chunks.size())
+				{
+					FormatChunk &chunk = *Chunks[i];
+
+					while (!chunk.Full.Get())
+						ChunkFilledEvent.Wait();
+
+					// A chunk of zero length terminates the queue
+					if (chunk.Length == 0)
+						break;
+
+					if (!WriterException)
+					{
+						try
+						{
+							ConstBufferPtr data (chunk.Data.GetRange (0, chunk.Length));
+
+							bool written = false;
+							if (DirectFile && chunk.Offset % FormatBufferAlignment == 0 && chunk.Length % FormatBufferAlignment == 0)
+							{
+								try
+								{
+									DirectFile->WriteAt (data, chunk.Offset);
+									written = true;
+								}
+								catch (SystemException &e)
+								{
+#ifdef TC_UNIX
+									// Some hosts accept direct I/O when opening but reject it when writing.
+									// The chunk and all subsequent ones are written through the buffered handle.
+									if (e.GetErrorCode() != EINVAL)
+										throw;
+
+									DirectFile.reset();
+#else
+									throw;
+#endif
+								}
+							}
+
+							if (!written)
+								Creator->VolumeFile->WriteAt (data, chunk.Offset);
+
+							Creator->SizeDone.Set (chunk.Offset + chunk.Length - ProgressStart);
+						}
+						catch (Exception &e)
+						{
+							WriterException.reset (e.CloneNew());
+						}
+						catch (exception &e)
+						{
+							WriterException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+						}
+						catch (...)
+						{
+							WriterException.reset (new UnknownException (SRC_POS));
+						}
+
+						if (WriterException)
+							WriterFailed.Set (true);
+					}
+
+					chunk.Full.Set (false);
+					ChunkWrittenEvent.Signal();
+				}
+			}
+
+			vector < shared_ptr <FormatChunk> > &Chunks;
+			SyncEvent &ChunkFilledEvent;
+			SyncEvent &ChunkWrittenEvent;
+			VolumeCreator *Creator;
+			shared_ptr <File> DirectFile;
+			uint64 ProgressStart;
+			shared_ptr <Exception> &WriterException;
+			SharedVal <bool> &WriterFailed;
+		};
+
+		Thread writerThread;
+		writerThread.Start (new WriterFunctor (this, chunks, directFile, chunkFilledEvent, chunkWrittenEvent, writerException, writerFailed, progressStart));
+
+		size_t chunkIndex = 0;
+		shared_ptr <Exception> encryptionException;
+		bool sourceEnd = false;
+
+		try
+		{
+			while (!AbortRequested && WriteOffset < endOffset)
+			{
+				FormatChunk &chunk = *chunks[chunkIndex];
+
+				while (chunk.Full.Get())
+					chunkWrittenEvent.Wait();
+
+				if (writerFailed.Get())
+					break;
+
+				uint64 chunkLength = chunkSize;
+				if (WriteOffset + chunkLength > endOffset)
+					chunkLength = endOffset - WriteOffset;
+
+				BufferPtr data (chunk.Data.GetRange (0, (size_t) chunkLength));
+
+				if (source)
+				{
+					size_t dataLength = 0;
+					while (dataLength < data.Size())
+					{
+						uint64 bytesRead = source->Read (data.GetRange (dataLength, data.Size() - dataLength));
+						if (bytesRead == 0)
+						{
+							sourceEnd = true;
+							break;
+						}
+
+						dataLength += (size_t) bytesRead;
+					}
+
+					if (dataLength == 0)
+						break;
+
+					// The end of the source is padded with zeros to keep the following chunks aligned for direct I/O
+					if (dataLength < data.Size())
+					{
+						chunkLength = dataLength + (FormatBufferAlignment - dataLength % FormatBufferAlignment) % FormatBufferAlignment;
+						if (chunkLength > data.Size())
+							chunkLength = data.Size();
+
+						data = chunk.Data.GetRange (0, (size_t) chunkLength);
+						data.GetRange (dataLength, data.Size() - dataLength).Zero();
+					}
+				}
+				else
+					data.Zero();
+
+				Options->EA->EncryptSectors (data, WriteOffset / ENCRYPTION_DATA_UNIT_SIZE, chunkLength / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
+
+				chunk.Offset = WriteOffset;
+				chunk.Length = (size_t) chunkLength;
+				chunk.Full.Set (true);
+				chunkFilledEvent.Signal();
+
+				WriteOffset += chunkLength;
+				chunkIndex = (chunkIndex + 1) % chunks.size();
+
+				if (sourceEnd)
+					break;
+			}
+
+			if (source && !sourceEnd && !AbortRequested && !writerFailed.Get())
+			{
+				uint8 byte;
+				if (source->Read (BufferPtr (&byte, sizeof (byte))) != 0)
+					throw ParameterTooLarge (SRC_POS);
+			}
+		}
+		catch (Exception &e)
+		{
+			encryptionException.reset (e.CloneNew());
+		}
+		catch (exception &e)
+		{
+			encryptionException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+		}
+
+		// Terminate the queue and wait until all chunks have been written
+		FormatChunk &lastChunk = *chunks[chunkIndex];
+		while (lastChunk.Full.Get())
+			chunkWrittenEvent.Wait();
+
+		lastChunk.Length = 0;
+		lastChunk.Full.Set (true);
+		chunkFilledEvent.Signal();
+
+		writerThread.Join();
+
+		if (encryptionException)
+			encryptionException->Throw();
+
+		if (writerException)
+			writerException->Throw();
+
+		VolumeFile->SeekAt (WriteOffset);
+	}
+
 	VolumeCreator::KeyInfo VolumeCreator::GetKeyInfo () const
 	{
 		KeyInfo info;
@@ -410,4 +903,14 @@ namespace VeraCrypt
 		mProgressInfo.SizeDone = SizeDone.Get();
 		return mProgressInfo;
 	}
+
+	VolumeTrialHint VolumeCreator::GetTrialHint () const
+	{
+		VolumeTrialHint hint;
+		hint.EncryptionAlgorithm = Options->EA->GetName();
+		hint.HeaderKey = DerivedHeaderKey;
+		hint.Kdf = Options->VolumeHeaderKdf->GetName();
+		hint.Type = Options->Type;
+		return hint;
+	}
 }
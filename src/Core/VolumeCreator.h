@@ -38,6 +38,8 @@ namespace VeraCrypt
 		shared_ptr <Pkcs5Kdf> VolumeHeaderKdf;
 		shared_ptr <EncryptionAlgorithm> EA;
 		bool Quick;
+		bool Preallocate;
+		shared_ptr <FilePath> SourceImage;
 		bool EMVSupportEnabled;
 
 		struct FilesystemType
@@ -138,6 +140,28 @@ namespace VeraCrypt
 		FilesystemType::Enum Filesystem;
 		uint32 FilesystemClusterSize;
 		uint32 SectorSize;
+
+		// Size of the buffers and number of buffers used to encrypt free space (0 = default)
+		uint32 FormatChunkSize;
+		uint32 FormatQueueDepth;
+		bool FormatDirectIO;
+	};
+
+	struct VolumeExpansionOptions
+	{
+		VolumeExpansionOptions () : Size (0), Pim (0), EMVSupportEnabled (false), Quick (false), FormatChunkSize (0), FormatQueueDepth (0), FormatDirectIO (false) { }
+
+		VolumePath Path;
+		uint64 Size;		// New size of a file container; a device-hosted volume is expanded to the size of the device
+		shared_ptr <VolumePassword> Password;
+		int Pim;
+		shared_ptr <Pkcs5Kdf> Kdf;
+		shared_ptr <KeyfileList> Keyfiles;
+		bool EMVSupportEnabled;
+		bool Quick;
+		uint32 FormatChunkSize;
+		uint32 FormatQueueDepth;
+		bool FormatDirectIO;
 	};
 
 	class VolumeCreator
@@ -163,27 +187,48 @@ namespace VeraCrypt
 		void Abort ();
 		void CheckResult ();
 		void CreateVolume (shared_ptr <VolumeCreationOptions> options);
+		void ExpandVolume (shared_ptr <VolumeExpansionOptions> options);
+		uint32 GetExtentCount () const { return ExtentCount; }
 		KeyInfo GetKeyInfo () const;
 		ProgressInfo GetProgressInfo ();
+		VolumeTrialHint GetTrialHint () const;
+
+		static const size_t DefaultFormatChunkSize = 4 * BYTES_PER_MB;
+		static const size_t DefaultFormatQueueDepth = 4;
+		static const size_t MaxFormatChunkSize = 64 * BYTES_PER_MB;
+		static const size_t MaxFormatQueueDepth = 64;
 
 	protected:
+		static void CreateFakeHiddenVolumeHeader (const BufferPtr &headerBuffer, shared_ptr <VolumeCreationOptions> options, uint64 hostSize);
 		void CreationThread ();
+		void ExpansionThread ();
+		void FormatDataArea (uint64 endOffset, uint64 progressStart, shared_ptr <File> source = shared_ptr <File> ());
+		size_t GetFormatChunkSize () const;
+
+		// Alignment of buffers and write offsets required for direct I/O
+		static const size_t FormatBufferAlignment = 4096;
 
 		volatile bool AbortRequested;
 		volatile bool CreationInProgress;
 		uint64 DataStart;
+		uint32 ExtentCount;
+		shared_ptr <VolumeExpansionOptions> ExpansionOptions;
+		shared_ptr <Volume> ExpandedVolume;
 		uint64 HostSize;
+		uint64 OldHostSize;
 		shared_ptr <VolumeCreationOptions> Options;
 		shared_ptr <Exception> ThreadException;
 		uint64 VolumeSize;
 
 		shared_ptr <VolumeLayout> Layout;
+		shared_ptr <File> SourceFile;
 		shared_ptr <File> VolumeFile;
 		SharedVal <uint64> SizeDone;
 		uint64 WriteOffset;
 		ProgressInfo mProgressInfo;
 
 		SecureBuffer HeaderKey;
+		shared_ptr <VolumeHeaderKey> DerivedHeaderKey;
 		shared_ptr <VolumePassword> PasswordKey;
 		SecureBuffer MasterKey;
 
@@ -0,0 +1,325 @@
+/*
+ Copyright (c) 2013-2025 AM Crypto. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "VolumeExporter.h"
+
+namespace VeraCrypt
+{
+	VolumeExporter::VolumeExporter ()
+		: AbortRequested (false), SizeDone (0)
+	{
+		mProgressInfo.ExportInProgress = false;
+		mProgressInfo.TotalSize = 0;
+		mProgressInfo.SizeDone = 0;
+	}
+
+	VolumeExporter::~VolumeExporter ()
+	{
+	}
+
+	void VolumeExporter::Abort ()
+	{
+		AbortRequested = true;
+	}
+
+	void VolumeExporter::CheckResult ()
+	{
+		if (ThreadException)
+			ThreadException->Throw();
+	}
+
+	void VolumeExporter::ExportThread ()
+	{
+		try
+		{
+			if (Options->Checksum)
+				Options->Checksum->Init();
+
+			Chunks.clear();
+			for (size_t i = 0; i < QueueDepth; ++i)
+				Chunks.push_back (shared_ptr <Chunk> (new Chunk));
+
+			struct ReaderFunctor : public Functor
+			{
+				ReaderFunctor (VolumeExporter *exporter) : Exporter (exporter) { }
+				virtual void operator() ()
+				{
+					Exporter->ReaderThread ();
+				}
+				VolumeExporter *Exporter;
+			};
+
+			struct WriterFunctor : public Functor
+			{
+				WriterFunctor (VolumeExporter *exporter) : Exporter (exporter) { }
+				virtual void operator() ()
+				{
+					Exporter->WriterThread ();
+				}
+				VolumeExporter *Exporter;
+			};
+
+			Thread readerThread;
+			Thread writerThread;
+			readerThread.Start (new ReaderFunctor (this));
+			writerThread.Start (new WriterFunctor (this));
+
+			// Chunks read by the reader thread are decrypted by the encryption thread pool and passed
+			// to the writer thread. A chunk of zero length terminates the pipeline.
+			shared_ptr <Exception> decryptionException;
+
+			for (size_t chunkIndex = 0; ; chunkIndex = (chunkIndex + 1) % Chunks.size())
+			{
+				Chunk &chunk = *Chunks[chunkIndex];
+
+				while (chunk.Status.Get() != Chunk::State::Read)
+					ChunkReadEvent.Wait();
+
+				bool lastChunk = (chunk.Length == 0);
+
+				if (!lastChunk && !AbortRequested)
+				{
+					try
+					{
+						Options->SourceVolume->DecryptSectors (chunk.Data.GetRange (0, chunk.Length), chunk.Offset);
+					}
+					catch (Exception &e)
+					{
+						decryptionException.reset (e.CloneNew());
+						AbortRequested = true;
+					}
+					catch (exception &e)
+					{
+						decryptionException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+						AbortRequested = true;
+					}
+				}
+
+				chunk.Status.Set (Chunk::State::Decrypted);
+				ChunkDecryptedEvent.Signal();
+
+				if (lastChunk)
+					break;
+			}
+
+			readerThread.Join();
+			writerThread.Join();
+
+			if (ReaderException)
+				ReaderException->Throw();
+
+			if (decryptionException)
+				decryptionException->Throw();
+
+			if (WriterException)
+				WriterException->Throw();
+
+			if (!AbortRequested)
+			{
+				Options->Output->Flush();
+
+				if (Options->Checksum)
+				{
+					Checksum.Allocate (Options->Checksum->GetDigestSize());
+					Options->Checksum->GetDigest (Checksum);
+				}
+			}
+		}
+		catch (Exception &e)
+		{
+			ThreadException.reset (e.CloneNew());
+		}
+		catch (exception &e)
+		{
+			ThreadException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+		}
+		catch (...)
+		{
+			ThreadException.reset (new UnknownException (SRC_POS));
+		}
+
+		Chunks.clear();
+		mProgressInfo.ExportInProgress = false;
+	}
+
+	void VolumeExporter::ExportVolume (shared_ptr <VolumeExportOptions> options)
+	{
+		if (!options->SourceVolume || !options->Output)
+			throw ParameterIncorrect (SRC_POS);
+
+		if (options->SourceVolume->IsInPlaceEncryptionInProgress() || options->SourceVolume->IsReEncryptionInProgress())
+			throw VolumeEncryptionNotCompleted (SRC_POS);
+
+		Options = options;
+		AbortRequested = false;
+		SizeDone.Set (0);
+
+		mProgressInfo.TotalSize = Options->SourceVolume->GetSize();
+		mProgressInfo.ExportInProgress = true;
+
+		struct ThreadFunctor : public Functor
+		{
+			ThreadFunctor (VolumeExporter *exporter) : Exporter (exporter) { }
+			virtual void operator() ()
+			{
+				Exporter->ExportThread ();
+			}
+			VolumeExporter *Exporter;
+		};
+
+		Thread thread;
+		thread.Start (new ThreadFunctor (this));
+	}
+
+	VolumeExporter::ProgressInfo VolumeExporter::GetProgressInfo ()
+	{
+		mProgressInfo.SizeDone = SizeDone.Get();
+		return mProgressInfo;
+	}
+
+	bool VolumeExporter::IsZeroBlock (const ConstBufferPtr &block)
+	{
+		for (size_t i = 0; i < block.Size(); ++i)
+		{
+			if (block[i] != 0)
+				return false;
+		}
+
+		return true;
+	}
+
+	void VolumeExporter::ReaderThread ()
+	{
+		uint64 volumeSize = Options->SourceVolume->GetSize();
+		uint64 offset = 0;
+		size_t chunkIndex = 0;
+
+		try
+		{
+			while (offset < volumeSize && !AbortRequested)
+			{
+				Chunk &chunk = *Chunks[chunkIndex];
+
+				while (chunk.Status.Get() != Chunk::State::Free)
+					ChunkFreeEvent.Wait();
+
+				size_t length = ChunkSize;
+				if (offset + length > volumeSize)
+					length = (size_t) (volumeSize - offset);
+
+				Options->SourceVolume->ReadEncryptedSectors (chunk.Data.GetRange (0, length), offset);
+
+				chunk.Offset = offset;
+				chunk.Length = length;
+				chunk.Status.Set (Chunk::State::Read);
+				ChunkReadEvent.Signal();
+
+				offset += length;
+				chunkIndex = (chunkIndex + 1) % Chunks.size();
+			}
+		}
+		catch (Exception &e)
+		{
+			ReaderException.reset (e.CloneNew());
+			AbortRequested = true;
+		}
+		catch (exception &e)
+		{
+			ReaderException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+			AbortRequested = true;
+		}
+
+		Chunk &lastChunk = *Chunks[chunkIndex];
+		while (lastChunk.Status.Get() != Chunk::State::Free)
+			ChunkFreeEvent.Wait();
+
+		lastChunk.Length = 0;
+		lastChunk.Status.Set (Chunk::State::Read);
+		ChunkReadEvent.Signal();
+	}
+
+	void VolumeExporter::WriteChunk (const Chunk &chunk)
+	{
+		ConstBufferPtr data (chunk.Data.GetRange (0, chunk.Length));
+
+		if (Options->Checksum)
+			Options->Checksum->ProcessData (data);
+
+		if (!Options->Sparse)
+		{
+			Options->Output->Write (data);
+			return;
+		}
+
+		// Runs of blocks containing data are written at once. The last block of the volume
+		// is always written to set the size of the output.
+		bool lastVolumeChunk = (chunk.Offset + chunk.Length == Options->SourceVolume->GetSize());
+		size_t runStart = 0;
+		bool dataRun = false;
+
+		for (size_t blockStart = 0; blockStart < chunk.Length; blockStart += SparseBlockSize)
+		{
+			size_t blockLength = SparseBlockSize;
+			if (blockStart + blockLength > chunk.Length)
+				blockLength = chunk.Length - blockStart;
+
+			bool skipBlock = IsZeroBlock (data.GetRange (blockStart, blockLength))
+				&& !(lastVolumeChunk && blockStart + blockLength == chunk.Length);
+
+			if (!skipBlock && !dataRun)
+			{
+				runStart = blockStart;
+				dataRun = true;
+			}
+			else if (skipBlock && dataRun)
+			{
+				Options->Output->WriteAt (data.GetRange (runStart, blockStart - runStart), chunk.Offset + runStart);
+				dataRun = false;
+			}
+		}
+
+		if (dataRun)
+			Options->Output->WriteAt (data.GetRange (runStart, chunk.Length - runStart), chunk.Offset + runStart);
+	}
+
+	void VolumeExporter::WriterThread ()
+	{
+		for (size_t chunkIndex = 0; ; chunkIndex = (chunkIndex + 1) % Chunks.size())
+		{
+			Chunk &chunk = *Chunks[chunkIndex];
+
+			while (chunk.Status.Get() != Chunk::State::Decrypted)
+				ChunkDecryptedEvent.Wait();
+
+			if (chunk.Length == 0)
+				break;
+
+			if (!AbortRequested)
+			{
+				try
+				{
+					WriteChunk (chunk);
+					SizeDone.Set (chunk.Offset + chunk.Length);
+				}
+				catch (Exception &e)
+				{
+					WriterException.reset (e.CloneNew());
+					AbortRequested = true;
+				}
+				catch (exception &e)
+				{
+					WriterException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+					AbortRequested = true;
+				}
+			}
+
+			chunk.Status.Set (Chunk::State::Free);
+			ChunkFreeEvent.Signal();
+		}
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ Copyright (c) 2013-2025 AM Crypto. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#ifndef TC_HEADER_Core_VolumeExporter
+#define TC_HEADER_Core_VolumeExporter
+
+#include "Platform/Platform.h"
+#include "Volume/Hash.h"
+#include "Volume/Volume.h"
+
+namespace VeraCrypt
+{
+	struct VolumeExportOptions
+	{
+		VolumeExportOptions () : Sparse (false) { }
+
+		shared_ptr <Hash> Checksum;		// Optional
+		shared_ptr <File> Output;
+		bool Sparse;					// All-zero blocks are skipped (output must be seekable)
+		shared_ptr <Volume> SourceVolume;
+	};
+
+	// Writes the decrypted data area of an open volume to a file or stream. Reading, decryption
+	// and writing of consecutive chunks overlap.
+	class VolumeExporter
+	{
+	public:
+		struct ProgressInfo
+		{
+			bool ExportInProgress;
+			uint64 TotalSize;
+			uint64 SizeDone;
+		};
+
+		VolumeExporter ();
+		virtual ~VolumeExporter ();
+
+		void Abort ();
+		void CheckResult ();
+		void ExportVolume (shared_ptr <VolumeExportOptions> options);
+		ConstBufferPtr GetChecksum () const { return Checksum; }
+		ProgressInfo GetProgressInfo ();
+
+		static const size_t ChunkSize = 4 * BYTES_PER_MB;
+		static const size_t QueueDepth = 4;
+		static const size_t SparseBlockSize = 4096;
+
+	protected:
+		struct Chunk
+		{
+			struct State
+			{
+				enum Enum
+				{
+					Free,
+					Read,
+					Decrypted
+				};
+			};
+
+			Chunk () : Data (ChunkSize), Length (0), Offset (0), Status (State::Free) { }
+
+			SecureBuffer Data;
+			size_t Length;
+			uint64 Offset;
+			SharedVal <State::Enum> Status;
+		};
+
+		void ExportThread ();
+		static bool IsZeroBlock (const ConstBufferPtr &block);
+		void ReaderThread ();
+		void WriteChunk (const Chunk &chunk);
+		void WriterThread ();
+
+		volatile bool AbortRequested;
+		SecureBuffer Checksum;
+		vector < shared_ptr <Chunk> > Chunks;
+		SyncEvent ChunkDecryptedEvent;
+		SyncEvent ChunkFreeEvent;
+		SyncEvent ChunkReadEvent;
+		shared_ptr <VolumeExportOptions> Options;
+		ProgressInfo mProgressInfo;
+		shared_ptr <Exception> ReaderException;
+		SharedVal <uint64> SizeDone;
+		shared_ptr <Exception> ThreadException;
+		shared_ptr <Exception> WriterException;
+
+	private:
+		VolumeExporter (const VolumeExporter &);
+		VolumeExporter &operator= (const VolumeExporter &);
+	};
+}
+
+#endif // TC_HEADER_Core_VolumeExporter
@@ -0,0 +1,450 @@
+/*
+ Copyright (c) 2013-2025 AM Crypto. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#include "Volume/EncryptionTest.h"
+#include "Volume/EncryptionModeXTS.h"
+#ifdef WOLFCRYPT_BACKEND
+#include "Volume/EncryptionModeWolfCryptXTS.h"
+#endif
+#include "Core.h"
+
+#ifdef TC_UNIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "VolumeReEncryptor.h"
+
+namespace VeraCrypt
+{
+	VolumeReEncryptor::VolumeReEncryptor ()
+		: AbortRequested (false), SizeDone (0)
+	{
+		mProgressInfo.ReEncryptionInProgress = false;
+		mProgressInfo.TotalSize = 0;
+		mProgressInfo.SizeDone = 0;
+	}
+
+	VolumeReEncryptor::~VolumeReEncryptor ()
+	{
+	}
+
+	void VolumeReEncryptor::Abort ()
+	{
+		AbortRequested = true;
+	}
+
+	void VolumeReEncryptor::BeginReEncryption (shared_ptr <Volume> volume, shared_ptr <VolumeReEncryptionOptions> options)
+	{
+		shared_ptr <VolumeHeader> previousHeader = volume->GetHeader();
+		shared_ptr <VolumeHeaderKey> previousHeaderKey = volume->GetHeaderKey();
+		shared_ptr <VolumeLayout> layout = volume->GetLayout();
+		shared_ptr <Pkcs5Kdf> kdf = volume->GetPkcs5Kdf();
+		shared_ptr <File> volumeFile = volume->GetFile();
+
+		// The data area must be fully encrypted with the previous key
+		if (previousHeader->GetEncryptedAreaLength() != previousHeader->GetVolumeDataSize())
+			throw VolumeEncryptionNotCompleted (SRC_POS);
+
+		SecureBuffer headerBuffer (layout->GetHeaderSize());
+
+		// The previous header is moved to the backup header slot. Both headers require a version above any
+		// release to prevent the volume from being opened by implementations unaware of the re-encryption.
+		previousHeader->SetFlags (previousHeader->GetFlags() | TC_HEADER_FLAG_REENCRYPTION);
+		previousHeader->SetRequiredMinProgramVersion (TC_VOLUME_REENCRYPTION_REQUIRED_PROGRAM_VERSION);
+		previousHeader->EncryptNew (headerBuffer, previousHeaderKey->Salt, previousHeaderKey->Key, kdf);
+
+		volumeFile->WriteAt (headerBuffer, volume->GetHostSize() + layout->GetBackupHeaderOffset());
+		volumeFile->Flush();
+
+		shared_ptr <EncryptionAlgorithm> ea = options->NewEA ? options->NewEA : volume->GetEncryptionAlgorithm()->GetNew();
+
+		// Master data key
+		SecureBuffer masterKey (ea->GetKeySize() * 2);
+		RandomNumberGenerator::GetData (masterKey);
+		if (memcmp (masterKey.Ptr(), masterKey.Ptr() + masterKey.Size() / 2, masterKey.Size() / 2) == 0)
+			throw AssertionFailed (SRC_POS);
+
+		// Header key
+		shared_ptr <VolumeHeaderKey> headerKey (new VolumeHeaderKey);
+		headerKey->Kdf = kdf->GetName();
+		headerKey->Salt.Allocate (VolumeHeader::GetSaltSize());
+		RandomNumberGenerator::GetData (headerKey->Salt);
+
+		headerKey->Key.Allocate (VolumeHeader::GetLargestSerializedKeySize());
+		shared_ptr <VolumePassword> passwordKey = Keyfile::ApplyListToPassword (options->Keyfiles, options->Password, options->EMVSupportEnabled);
+		kdf->DeriveKey (headerKey->Key, *passwordKey, options->Pim, headerKey->Salt);
+
+		VolumeHeaderCreationOptions headerOptions;
+		headerOptions.EA = ea;
+		headerOptions.Kdf = kdf;
+		headerOptions.Type = volume->GetType();
+		headerOptions.SectorSize = (uint32) previousHeader->GetSectorSize();
+		headerOptions.VolumeDataStart = previousHeader->GetEncryptedAreaStart();
+		headerOptions.VolumeDataSize = previousHeader->GetVolumeDataSize();
+		headerOptions.DataKey = masterKey;
+		headerOptions.Salt = headerKey->Salt;
+		headerOptions.HeaderKey = headerKey->Key;
+
+		shared_ptr <VolumeHeader> header (new VolumeHeader (layout->GetHeaderSize()));
+		header->Create (headerBuffer, headerOptions);
+		header->SetFlags (previousHeader->GetFlags() | TC_HEADER_FLAG_REENCRYPTION);
+		header->SetRequiredMinProgramVersion (TC_VOLUME_REENCRYPTION_REQUIRED_PROGRAM_VERSION);
+		header->SetEncryptedArea (previousHeader->GetEncryptedAreaStart(), 0);
+
+		// Data area keys
+		ea->SetKey (masterKey.GetRange (0, ea->GetKeySize()));
+#ifdef WOLFCRYPT_BACKEND
+		shared_ptr <EncryptionMode> mode (new EncryptionModeWolfCryptXTS ());
+		ea->SetKeyXTS (masterKey.GetRange (ea->GetKeySize(), ea->GetKeySize()));
+#else
+		shared_ptr <EncryptionMode> mode (new EncryptionModeXTS ());
+#endif
+		mode->SetKey (masterKey.GetRange (ea->GetKeySize(), ea->GetKeySize()));
+		ea->SetMode (mode);
+
+		header->EncryptNew (headerBuffer, headerKey->Salt, headerKey->Key, kdf);
+
+		volumeFile->WriteAt (headerBuffer, layout->GetHeaderOffset());
+		volumeFile->Flush();
+
+		volume->BeginReEncryption (header, headerKey);
+	}
+
+	void VolumeReEncryptor::CheckResult ()
+	{
+		if (ThreadException)
+			ThreadException->Throw();
+	}
+
+	void VolumeReEncryptor::FinalizeVolume ()
+	{
+		shared_ptr <VolumeHeader> header = mVolume->GetHeader();
+		header->SetFlags (header->GetFlags() & ~TC_HEADER_FLAG_REENCRYPTION);
+		header->SetRequiredMinProgramVersion (TC_VOLUME_MIN_REQUIRED_PROGRAM_VERSION);
+		header->SetEncryptedArea (header->GetEncryptedAreaStart(), DataEnd - DataStart);
+
+		SecureBuffer headerBuffer (Layout->GetHeaderSize());
+
+		shared_ptr <VolumeHeaderKey> headerKey = mVolume->GetHeaderKey();
+		header->EncryptNew (headerBuffer, headerKey->Salt, headerKey->Key, mVolume->GetPkcs5Kdf());
+		VolumeFile->WriteAt (headerBuffer, Layout->GetHeaderOffset());
+		VolumeFile->Flush();
+
+		// The backup header replaces the previous header, and the journal along with it, and is encrypted
+		// with the header key of the previous header to keep the salts of the two headers different
+		shared_ptr <VolumeHeaderKey> backupHeaderKey = mVolume->GetPreviousHeaderKey();
+		header->EncryptNew (headerBuffer, backupHeaderKey->Salt, backupHeaderKey->Key, mVolume->GetPkcs5Kdf());
+		VolumeFile->WriteAt (headerBuffer, mVolume->GetHostSize() + Layout->GetBackupHeaderOffset());
+		VolumeFile->Flush();
+
+		mVolume->EndReEncryption();
+	}
+
+	VolumeReEncryptor::ProgressInfo VolumeReEncryptor::GetProgressInfo ()
+	{
+		mProgressInfo.SizeDone = SizeDone.Get();
+		return mProgressInfo;
+	}
+
+	void VolumeReEncryptor::ReaderThread ()
+	{
+		uint64 offset = mVolume->GetReEncryptionBoundary();
+		size_t chunkIndex = 0;
+
+		bool hiddenVolumeProtected = (mVolume->GetProtectionType() == VolumeProtection::HiddenVolumeReadOnly);
+
+		try
+		{
+			while (offset < DataEnd && !AbortRequested)
+			{
+				Chunk &chunk = *Chunks[chunkIndex];
+
+				while (chunk.Status.Get() != Chunk::State::Free)
+					ChunkFreeEvent.Wait();
+
+				uint64 length = VC_MIN ((uint64) ChunkSize, DataEnd - offset);
+				chunk.Skip = false;
+
+				// The area of a protected hidden volume is left intact
+				if (hiddenVolumeProtected && offset < mVolume->GetProtectedRangeEnd() && offset + length > mVolume->GetProtectedRangeStart())
+				{
+					if (offset >= mVolume->GetProtectedRangeStart())
+					{
+						chunk.Skip = true;
+						length = VC_MIN (mVolume->GetProtectedRangeEnd(), DataEnd) - offset;
+					}
+					else
+						length = mVolume->GetProtectedRangeStart() - offset;
+				}
+
+				if (!chunk.Skip)
+				{
+					mVolume->LockReEncryptionRange (offset + length);
+
+					if (VolumeFile->ReadAt (chunk.Data.GetRange (0, (size_t) length), offset) != length)
+						throw MissingVolumeData (SRC_POS);
+				}
+
+				chunk.Offset = offset;
+				chunk.Length = length;
+				chunk.Status.Set (Chunk::State::Read);
+				ChunkReadEvent.Signal();
+
+				offset += length;
+				chunkIndex = (chunkIndex + 1) % Chunks.size();
+			}
+		}
+		catch (Exception &e)
+		{
+			ReaderException.reset (e.CloneNew());
+			AbortRequested = true;
+		}
+		catch (exception &e)
+		{
+			ReaderException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+			AbortRequested = true;
+		}
+
+		Chunk &lastChunk = *Chunks[chunkIndex];
+		while (lastChunk.Status.Get() != Chunk::State::Free)
+			ChunkFreeEvent.Wait();
+
+		lastChunk.Length = 0;
+		lastChunk.Status.Set (Chunk::State::Read);
+		ChunkReadEvent.Signal();
+	}
+
+	void VolumeReEncryptor::ReEncryptionThread ()
+	{
+		try
+		{
+			Chunks.clear();
+			for (size_t i = 0; i < QueueDepth; ++i)
+				Chunks.push_back (shared_ptr <Chunk> (new Chunk));
+
+			struct ReaderFunctor : public Functor
+			{
+				ReaderFunctor (VolumeReEncryptor *reEncryptor) : ReEncryptor (reEncryptor) { }
+				virtual void operator() ()
+				{
+					ReEncryptor->ReaderThread ();
+				}
+				VolumeReEncryptor *ReEncryptor;
+			};
+
+			Thread readerThread;
+			readerThread.Start (new ReaderFunctor (this));
+
+			// Each piece read ahead by the reader thread is decrypted with the previous key and encrypted with
+			// the new one by the encryption thread pool. The piece is recorded in the journal before it is
+			// written. A chunk of zero length terminates the pipeline.
+			shared_ptr <Exception> reEncryptionException;
+			uint64 boundary = LastCheckpoint;
+
+			for (size_t chunkIndex = 0; ; chunkIndex = (chunkIndex + 1) % Chunks.size())
+			{
+				Chunk &chunk = *Chunks[chunkIndex];
+
+				while (chunk.Status.Get() != Chunk::State::Read)
+					ChunkReadEvent.Wait();
+
+				bool lastChunk = (chunk.Length == 0);
+
+				if (!lastChunk && !AbortRequested)
+				{
+					try
+					{
+						uint64 chunkEnd = chunk.Offset + chunk.Length;
+
+						if (chunk.Skip)
+						{
+							WriteCheckpoint (chunkEnd);
+						}
+						else
+						{
+							BufferPtr data = chunk.Data.GetRange (0, (size_t) chunk.Length);
+
+							mVolume->ReEncryptSectors (data, chunk.Offset);
+							mVolume->WriteReEncryptionJournal (data, chunk.Offset);
+
+							VolumeFile->WriteAt (data, chunk.Offset);
+							VolumeFile->Flush();
+
+							if (chunkEnd - LastCheckpoint >= CheckpointInterval || chunkEnd == DataEnd)
+								WriteCheckpoint (chunkEnd);
+						}
+
+						boundary = chunkEnd;
+						SizeDone.Set (chunkEnd - DataStart);
+					}
+					catch (Exception &e)
+					{
+						reEncryptionException.reset (e.CloneNew());
+						AbortRequested = true;
+					}
+					catch (exception &e)
+					{
+						reEncryptionException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+						AbortRequested = true;
+					}
+				}
+
+				chunk.Status.Set (Chunk::State::Free);
+				ChunkFreeEvent.Signal();
+
+				if (lastChunk)
+					break;
+			}
+
+			readerThread.Join();
+			Chunks.clear();
+
+			// Record the progress made since the last checkpoint
+			if (boundary != LastCheckpoint)
+			{
+				try
+				{
+					WriteCheckpoint (boundary);
+				}
+				catch (...)
+				{
+					if (!ReaderException && !reEncryptionException)
+						throw;
+				}
+			}
+
+			if (ReaderException)
+				ReaderException->Throw();
+
+			if (reEncryptionException)
+				reEncryptionException->Throw();
+
+			if (!AbortRequested && LastCheckpoint == DataEnd)
+				FinalizeVolume();
+		}
+		catch (Exception &e)
+		{
+			ThreadException.reset (e.CloneNew());
+		}
+		catch (exception &e)
+		{
+			ThreadException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+		}
+		catch (...)
+		{
+			ThreadException.reset (new UnknownException (SRC_POS));
+		}
+
+		// Sectors read ahead become accessible again
+		try
+		{
+			if (mVolume->IsReEncryptionInProgress())
+				mVolume->LockReEncryptionRange (mVolume->GetReEncryptionBoundary());
+		}
+		catch (...) { }
+
+		Chunks.clear();
+		mProgressInfo.ReEncryptionInProgress = false;
+	}
+
+	void VolumeReEncryptor::ReEncryptVolume (shared_ptr <VolumeReEncryptionOptions> options)
+	{
+		EncryptionTest::TestAll();
+
+		shared_ptr <Volume> volume;
+		{
+#ifdef TC_UNIX
+			// Temporarily take ownership of a device if the user is not an administrator
+			UserId origDeviceOwner ((uid_t) -1);
+
+			if (options->Path.IsDevice() && !Core->HasAdminPrivileges())
+			{
+				origDeviceOwner = FilesystemPath (wstring (options->Path)).GetOwner();
+				Core->SetFileOwner (options->Path, UserId (getuid()));
+			}
+
+			finally_do_arg2 (FilesystemPath, options->Path, UserId, origDeviceOwner,
+			{
+				if (finally_arg2.SystemId != (uid_t) -1)
+					Core->SetFileOwner (finally_arg, finally_arg2);
+			});
+#endif
+
+			volume = Core->OpenVolume (shared_ptr <VolumePath> (new VolumePath (options->Path)), false, options->Password, options->Pim, options->Kdf, options->Keyfiles,
+				options->EMVSupportEnabled, options->Protection, options->ProtectionPassword, options->ProtectionPim, options->ProtectionKdf, options->ProtectionKeyfiles);
+		}
+
+		if (volume->IsEncryptionNotCompleted())
+			throw VolumeEncryptionNotCompleted (SRC_POS);
+
+		if (!volume->GetLayout()->HasBackupHeader())
+			throw ParameterIncorrect (SRC_POS);
+
+		if (!volume->IsReEncryptionInProgress())
+			BeginReEncryption (volume, options);
+
+		ReEncryptVolume (volume);
+	}
+
+	void VolumeReEncryptor::ReEncryptVolume (shared_ptr <Volume> volume)
+	{
+		if (!volume->IsReEncryptionInProgress())
+			throw ParameterIncorrect (SRC_POS);
+
+		if (volume->GetProtectionType() == VolumeProtection::ReadOnly)
+			throw VolumeReadOnly (SRC_POS);
+
+		mVolume = volume;
+		VolumeFile = volume->GetFile();
+		Layout = volume->GetLayout();
+
+		DataStart = volume->GetDataOffset();
+		DataEnd = DataStart + volume->GetSize();
+		LastCheckpoint = DataStart + volume->GetHeader()->GetEncryptedAreaLength();
+
+		AbortRequested = false;
+		ReaderException.reset();
+		ThreadException.reset();
+		SizeDone.Set (volume->GetReEncryptionBoundary() - DataStart);
+
+		mProgressInfo.TotalSize = volume->GetSize();
+		mProgressInfo.ReEncryptionInProgress = true;
+
+		struct ThreadFunctor : public Functor
+		{
+			ThreadFunctor (VolumeReEncryptor *reEncryptor) : ReEncryptor (reEncryptor) { }
+			virtual void operator() ()
+			{
+				ReEncryptor->ReEncryptionThread ();
+			}
+			VolumeReEncryptor *ReEncryptor;
+		};
+
+		Thread thread;
+		thread.Start (new ThreadFunctor (this));
+	}
+
+	void VolumeReEncryptor::WriteCheckpoint (uint64 boundary)
+	{
+		shared_ptr <VolumeHeader> header = mVolume->GetHeader();
+		header->SetEncryptedArea (header->GetEncryptedAreaStart(), boundary - DataStart);
+
+		SecureBuffer headerBuffer (Layout->GetHeaderSize());
+
+		shared_ptr <VolumeHeaderKey> headerKey = mVolume->GetHeaderKey();
+		header->EncryptNew (headerBuffer, headerKey->Salt, headerKey->Key, mVolume->GetPkcs5Kdf());
+
+		VolumeFile->WriteAt (headerBuffer, Layout->GetHeaderOffset());
+		VolumeFile->Flush();
+
+		mVolume->SetReEncryptionBoundary (boundary);
+		LastCheckpoint = boundary;
+	}
+}
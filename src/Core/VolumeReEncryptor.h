@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2013-2025 AM Crypto. All rights reserved.
+
+ Governed by the Apache License 2.0 the full text of which is
+ contained in the file License.txt included in VeraCrypt binary and source
+ code distribution packages.
+*/
+
+#ifndef TC_HEADER_Core_VolumeReEncryptor
+#define TC_HEADER_Core_VolumeReEncryptor
+
+#include "Platform/Platform.h"
+#include "Volume/Volume.h"
+#include "Volume/VolumeLayout.h"
+
+namespace VeraCrypt
+{
+	struct VolumeReEncryptionOptions
+	{
+		VolumeReEncryptionOptions () : Pim (0), EMVSupportEnabled (false), Protection (VolumeProtection::None), ProtectionPim (0) { }
+
+		VolumePath Path;
+		shared_ptr <VolumePassword> Password;
+		int Pim;
+		shared_ptr <Pkcs5Kdf> Kdf;
+		shared_ptr <KeyfileList> Keyfiles;
+		bool EMVSupportEnabled;
+		shared_ptr <EncryptionAlgorithm> NewEA;		// Current algorithm with a new master key if empty; ignored when resuming
+		VolumeProtection::Enum Protection;
+		shared_ptr <VolumePassword> ProtectionPassword;
+		int ProtectionPim;
+		shared_ptr <Pkcs5Kdf> ProtectionKdf;
+		shared_ptr <KeyfileList> ProtectionKeyfiles;
+	};
+
+	// Re-encrypts the data area of a volume with a new master key and, optionally, a different encryption
+	// algorithm. The data is decrypted and encrypted again in place from the start of the data area towards
+	// its end. The new header is stored in the primary header slot and the previous one in the backup slot
+	// until the re-encryption is completed. The progress is recorded in the primary header, which allows an
+	// interrupted re-encryption to be resumed, and the volume remains accessible in the meantime.
+	class VolumeReEncryptor
+	{
+	public:
+		struct ProgressInfo
+		{
+			bool ReEncryptionInProgress;
+			uint64 TotalSize;
+			uint64 SizeDone;
+		};
+
+		VolumeReEncryptor ();
+		virtual ~VolumeReEncryptor ();
+
+		void Abort ();
+		void CheckResult ();
+		ProgressInfo GetProgressInfo ();
+		void ReEncryptVolume (shared_ptr <VolumeReEncryptionOptions> options);
+		void ReEncryptVolume (shared_ptr <Volume> volume);
+
+		static const size_t ChunkSize = Volume::ReEncryptionPieceSize;
+		static const uint64 CheckpointInterval = 64 * BYTES_PER_MB;
+		static const size_t QueueDepth = 4;
+
+	protected:
+		struct Chunk
+		{
+			struct State
+			{
+				enum Enum
+				{
+					Free,
+					Read
+				};
+			};
+
+			Chunk () : Data (ChunkSize), Length (0), Offset (0), Skip (false), Status (State::Free) { }
+
+			SecureBuffer Data;
+			uint64 Length;
+			uint64 Offset;		// Host offset of the data
+			bool Skip;			// The range is not re-encrypted
+			SharedVal <State::Enum> Status;
+		};
+
+		void BeginReEncryption (shared_ptr <Volume> volume, shared_ptr <VolumeReEncryptionOptions> options);
+		void FinalizeVolume ();
+		void ReaderThread ();
+		void ReEncryptionThread ();
+		void WriteCheckpoint (uint64 boundary);
+
+		volatile bool AbortRequested;
+		vector < shared_ptr <Chunk> > Chunks;
+		SyncEvent ChunkFreeEvent;
+		SyncEvent ChunkReadEvent;
+		uint64 DataEnd;
+		uint64 DataStart;
+		uint64 LastCheckpoint;
+		shared_ptr <VolumeLayout> Layout;
+		shared_ptr <Volume> mVolume;
+		ProgressInfo mProgressInfo;
+		shared_ptr <Exception> ReaderException;
+		SharedVal <uint64> SizeDone;
+		shared_ptr <Exception> ThreadException;
+		shared_ptr <File> VolumeFile;
+
+	private:
+		VolumeReEncryptor (const VolumeReEncryptor &);
+		VolumeReEncryptor &operator= (const VolumeReEncryptor &);
+	};
+}
+
+#endif // TC_HEADER_Core_VolumeReEncryptor
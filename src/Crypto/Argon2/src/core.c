@@ -28,6 +28,11 @@
 #include "Crypto/misc.h"
 #include "blake2/blake2b.h"
 #include "blake2/blake2-impl.h"
+#if defined(TC_LINUX)
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #define secure_wipe_memory(v, n) burn((v), (n))
 
@@ -61,6 +66,136 @@ static void store_block(void *output, const block *src) {
 
 /***************Memory functions*****************/
 
+#if defined(TC_LINUX)
+/*
+ * Matrices of at least ARGON2_HUGE_PAGE_MIN_SIZE bytes are mapped on 2 MiB
+ * pages: with 4 KiB pages, page faults and TLB misses on the randomly
+ * referenced blocks take a large part of the hashing time.
+ */
+#define ARGON2_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+#define ARGON2_HUGE_PAGE_MIN_SIZE (8 * ARGON2_HUGE_PAGE_SIZE)
+#define ARGON2_PREFAULT_MAX_THREADS 8
+
+typedef struct {
+    uint8_t *memory;
+    size_t size;
+} argon2_prefault_range;
+
+static size_t huge_page_mapping_size(size_t memory_size) {
+    return (memory_size + ARGON2_HUGE_PAGE_SIZE - 1) &
+           ~(ARGON2_HUGE_PAGE_SIZE - 1);
+}
+
+static void *prefault_range_thr(void *thread_data) {
+    argon2_prefault_range *range = (argon2_prefault_range *)thread_data;
+    volatile uint8_t *p = range->memory;
+    size_t offset;
+
+#if defined(MADV_POPULATE_WRITE)
+    if (madvise(range->memory, range->size, MADV_POPULATE_WRITE) == 0) {
+        return NULL;
+    }
+#endif
+    /* Writing one byte faults in the whole page, huge or not */
+    for (offset = 0; offset < range->size; offset += 4096) {
+        p[offset] = 0;
+    }
+    return NULL;
+}
+
+/*
+ * Faults in the whole mapping before hashing. The kernel clears the pages
+ * while they are faulted in, so this is split between several threads.
+ */
+static void prefault_memory(uint8_t *memory, size_t size) {
+    pthread_t thread[ARGON2_PREFAULT_MAX_THREADS];
+    argon2_prefault_range range[ARGON2_PREFAULT_MAX_THREADS];
+    int created[ARGON2_PREFAULT_MAX_THREADS];
+    size_t pages = size / ARGON2_HUGE_PAGE_SIZE;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t count, t;
+
+    count = (cpus > 1) ? (size_t)cpus : 1;
+    if (count > ARGON2_PREFAULT_MAX_THREADS) {
+        count = ARGON2_PREFAULT_MAX_THREADS;
+    }
+    if (count > pages) {
+        count = pages;
+    }
+
+    for (t = 0; t < count; ++t) {
+        range[t].memory = memory + (pages * t / count) * ARGON2_HUGE_PAGE_SIZE;
+        range[t].size = (pages * (t + 1) / count - pages * t / count) *
+                        ARGON2_HUGE_PAGE_SIZE;
+        created[t] = 0;
+    }
+
+    /* The first range is done by the calling thread, as is any range whose
+       thread could not be created */
+    for (t = 1; t < count; ++t) {
+        created[t] = pthread_create(&thread[t], NULL, &prefault_range_thr,
+                                    &range[t]) == 0;
+    }
+    for (t = 0; t < count; ++t) {
+        if (!created[t]) {
+            prefault_range_thr(&range[t]);
+        }
+    }
+    for (t = 1; t < count; ++t) {
+        if (created[t]) {
+            pthread_join(thread[t], NULL);
+        }
+    }
+}
+
+static uint8_t *allocate_huge_pages(size_t memory_size) {
+    size_t mapping_size = huge_page_mapping_size(memory_size);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    uint8_t *memory = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+    /* Explicit huge pages are only available if the administrator reserved
+       them (vm.nr_hugepages) */
+    {
+        int huge_flags = flags | MAP_HUGETLB;
+#if defined(MAP_HUGE_SHIFT)
+        huge_flags |= 21 << MAP_HUGE_SHIFT; /* 2 MiB, whatever the default size */
+#endif
+        memory = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, huge_flags,
+                      -1, 0);
+    }
+#endif
+
+    if (memory == MAP_FAILED) {
+        /* Otherwise, ask for transparent huge pages on a mapping aligned on a
+           huge page boundary */
+        size_t size = mapping_size + ARGON2_HUGE_PAGE_SIZE;
+        uint8_t *base = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        size_t head;
+
+        if (base == MAP_FAILED) {
+            return NULL;
+        }
+
+        head = (ARGON2_HUGE_PAGE_SIZE -
+                ((uintptr_t)base & (ARGON2_HUGE_PAGE_SIZE - 1))) &
+               (ARGON2_HUGE_PAGE_SIZE - 1);
+        if (head) {
+            munmap(base, head);
+        }
+        memory = base + head;
+        munmap(memory + mapping_size, size - head - mapping_size);
+
+#if defined(MADV_HUGEPAGE)
+        madvise(memory, mapping_size, MADV_HUGEPAGE);
+#endif
+    }
+
+    prefault_memory(memory, mapping_size);
+    return memory;
+}
+#endif
+
 int allocate_memory(const argon2_context *context, uint8_t **memory,
                     size_t num, size_t size) {
     size_t memory_size = num*size;
@@ -76,6 +211,10 @@ int allocate_memory(const argon2_context *context, uint8_t **memory,
     /* 2. Try to allocate with appropriate allocator */
     if (context->allocate_cbk) {
         (context->allocate_cbk)(memory, memory_size);
+#if defined(TC_LINUX)
+    } else if (memory_size >= ARGON2_HUGE_PAGE_MIN_SIZE) {
+        *memory = allocate_huge_pages(memory_size);
+#endif
     } else {
         *memory = TCalloc(memory_size);
     }
@@ -93,6 +232,13 @@ void free_memory(const argon2_context *context, uint8_t *memory,
     clear_internal_memory(memory, memory_size);
     if (context->free_cbk) {
         (context->free_cbk)(memory, memory_size);
+#if defined(TC_LINUX)
+    } else if (memory_size >= ARGON2_HUGE_PAGE_MIN_SIZE) {
+        /* The pages were wiped above before they are returned to the kernel */
+        if (memory) {
+            munmap(memory, huge_page_mapping_size(memory_size));
+        }
+#endif
     } else {
         TCfree(memory);
     }
@@ -206,11 +206,22 @@ extern int fill_segment_sse2(const argon2_instance_t* instance,
 	argon2_position_t position);
 extern int fill_segment_avx2(const argon2_instance_t* instance,
 	argon2_position_t position);
+extern int fill_segment_avx512(const argon2_instance_t* instance,
+	argon2_position_t position);
 #endif
 
 int fill_segment(const argon2_instance_t* instance,
     argon2_position_t position) {
 #if CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32
+#if !defined(TC_WINDOWS_DRIVER)
+	if (HasSAVX512())
+	{
+		int result = fill_segment_avx512(instance, position);
+		/* ARGON2_INCORRECT_PARAMETER is also returned when AVX-512 support was not compiled in */
+		if (result != ARGON2_INCORRECT_PARAMETER)
+			return result;
+	}
+#endif
 	if (HasSAVX2())
 	{
 		return fill_segment_avx2(instance, position);
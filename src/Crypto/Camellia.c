@@ -58,6 +58,10 @@ void camellia_dec_blk2(const uint8 *ctx, uint8 *dst, const uint8 *src);
 void camellia_ecb_enc_16way(const uint8 *ctx, uint8 *dst, const uint8 *src);
 void camellia_ecb_dec_16way(const uint8 *ctx, uint8 *dst, const uint8 *src);
 
+/* VAES versions processing 32 blocks at a time. They return the number of blocks processed, 0 if VAES support was not compiled in */
+uint32 camellia_vaes_encrypt_blocks_32 (const uint8 *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount);
+uint32 camellia_vaes_decrypt_blocks_32 (const uint8 *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount);
+
 /* key constants */
 
 #define CAMELLIA_SIGMA1L (0xA09E667FL)
@@ -1096,6 +1100,16 @@ void camellia_decrypt(const unsigned __int8 *inBlock,  unsigned __int8 *outBlock
 void camellia_encrypt_blocks(unsigned __int8 *instance, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
 {
 #if !defined (_UEFI)
+#if !defined (TC_WINDOWS_DRIVER)
+	if ((blockCount >= 32) && IsAesHwCpuSupported () && HasVAES ())
+	{
+		uint32 processed = camellia_vaes_encrypt_blocks_32 (instance, in_blk, out_blk, blockCount);
+		out_blk += processed * 16;
+		in_blk += processed * 16;
+		blockCount -= processed;
+	}
+#endif
+
 	if ((blockCount >= 16) && IsCpuIntel() && IsAesHwCpuSupported () && HasSAVX()) /* on AMD cpu, AVX is too slow */
 	{
 #if defined (TC_WINDOWS_DRIVER)
@@ -1132,6 +1146,16 @@ void camellia_encrypt_blocks(unsigned __int8 *instance, const uint8* in_blk, uin
 void camellia_decrypt_blocks(unsigned __int8 *instance, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
 {
 #if !defined (_UEFI)
+#if !defined (TC_WINDOWS_DRIVER)
+	if ((blockCount >= 32) && IsAesHwCpuSupported () && HasVAES ())
+	{
+		uint32 processed = camellia_vaes_decrypt_blocks_32 (instance, in_blk, out_blk, blockCount);
+		out_blk += processed * 16;
+		in_blk += processed * 16;
+		blockCount -= processed;
+	}
+#endif
+
 	if ((blockCount >= 16) && IsCpuIntel() && IsAesHwCpuSupported () && HasSAVX()) /* on AMD cpu, AVX is too slow */
 	{
 #if defined (TC_WINDOWS_DRIVER)
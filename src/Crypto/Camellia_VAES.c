@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2013-2025 AM Crypto
+ * Governed by the Apache License 2.0 the full text of which is contained
+ * in the file License.txt included in VeraCrypt binary and source
+ * code distribution packages.
+ */
+
+/* Camellia processing 32 blocks in parallel using VAES and AVX2, based on the byte-sliced design of Camellia_aesni_x64.S.
+   Each AVX2 register holds the same byte of 32 blocks and the S-boxes are computed with VAESENCLAST between
+   affine filters implemented as 4-bit table lookups. The key schedule is the one built by camellia_set_key. */
+
+#include "Camellia.h"
+#include "Crypto/config.h"
+#include "Crypto/cpu.h"
+#include "Crypto/misc.h"
+
+#if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM)
+
+#if (defined(__AVX2__) && defined(__VAES__)) || (defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64))
+
+#include <immintrin.h>
+
+/* Affine filters mapping the Camellia S-boxes to the AES S-box, applied to the low and high nibbles */
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_pre_tf_lo_s1[16] = {
+	0x45, 0xe8, 0x40, 0xed, 0x2e, 0x83, 0x2b, 0x86, 0x4b, 0xe6, 0x4e, 0xe3, 0x20, 0x8d, 0x25, 0x88 };
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_pre_tf_hi_s1[16] = {
+	0x00, 0x51, 0xf1, 0xa0, 0x8a, 0xdb, 0x7b, 0x2a, 0x09, 0x58, 0xf8, 0xa9, 0x83, 0xd2, 0x72, 0x23 };
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_pre_tf_lo_s4[16] = {
+	0x45, 0x40, 0x2e, 0x2b, 0x4b, 0x4e, 0x20, 0x25, 0x14, 0x11, 0x7f, 0x7a, 0x1a, 0x1f, 0x71, 0x74 };
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_pre_tf_hi_s4[16] = {
+	0x00, 0xf1, 0x8a, 0x7b, 0x09, 0xf8, 0x83, 0x72, 0xad, 0x5c, 0x27, 0xd6, 0xa4, 0x55, 0x2e, 0xdf };
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_post_tf_lo_s1[16] = {
+	0x3c, 0xcc, 0xcf, 0x3f, 0x32, 0xc2, 0xc1, 0x31, 0xdc, 0x2c, 0x2f, 0xdf, 0xd2, 0x22, 0x21, 0xd1 };
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_post_tf_hi_s1[16] = {
+	0x00, 0xf9, 0x86, 0x7f, 0xd7, 0x2e, 0x51, 0xa8, 0xa4, 0x5d, 0x22, 0xdb, 0x73, 0x8a, 0xf5, 0x0c };
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_post_tf_lo_s2[16] = {
+	0x78, 0x99, 0x9f, 0x7e, 0x64, 0x85, 0x83, 0x62, 0xb9, 0x58, 0x5e, 0xbf, 0xa5, 0x44, 0x42, 0xa3 };
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_post_tf_hi_s2[16] = {
+	0x00, 0xf3, 0x0d, 0xfe, 0xaf, 0x5c, 0xa2, 0x51, 0x49, 0xba, 0x44, 0xb7, 0xe6, 0x15, 0xeb, 0x18 };
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_post_tf_lo_s3[16] = {
+	0x1e, 0x66, 0xe7, 0x9f, 0x19, 0x61, 0xe0, 0x98, 0x6e, 0x16, 0x97, 0xef, 0x69, 0x11, 0x90, 0xe8 };
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_post_tf_hi_s3[16] = {
+	0x00, 0xfc, 0x43, 0xbf, 0xeb, 0x17, 0xa8, 0x54, 0x52, 0xae, 0x11, 0xed, 0xb9, 0x45, 0xfa, 0x06 };
+
+/* Cancels the ShiftRows step of VAESENCLAST */
+static const CRYPTOPP_ALIGN_DATA(16) uint8 camellia_inv_shift_row[16] = {
+	0x00, 0x0d, 0x0a, 0x07, 0x04, 0x01, 0x0e, 0x0b, 0x08, 0x05, 0x02, 0x0f, 0x0c, 0x09, 0x06, 0x03 };
+
+typedef struct
+{
+	__m256i mask4;
+	__m256i invShiftRow;
+	__m256i preLo1, preHi1, preLo4, preHi4;
+	__m256i postLo1, postHi1, postLo2, postHi2, postLo3, postHi3;
+} camellia_vaes_tables;
+
+#define LOAD_TABLE(t)	_mm256_broadcastsi128_si256 (_mm_load_si128 ((const __m128i *) (t)))
+
+#define XOR256(a,b)		_mm256_xor_si256 ((a), (b))
+#define AND256(a,b)		_mm256_and_si256 ((a), (b))
+#define OR256(a,b)		_mm256_or_si256 ((a), (b))
+
+/* Byte j of the 64-bit subkey idx, the two 32-bit halves being stored in native byte order */
+#define KEY_BYTE(ks, idx, j)	_mm256_set1_epi8 ((char) (ks)[(idx) * 8 + ((j) & 4) + 3 - ((j) & 3)])
+
+/* Affine transformation of each byte as the XOR of the lookups of its two nibbles */
+#define FILTER(x, lo, hi) \
+	XOR256 (_mm256_shuffle_epi8 ((lo), AND256 ((x), t->mask4)), _mm256_shuffle_epi8 ((hi), AND256 (_mm256_srli_epi16 ((x), 4), t->mask4)))
+
+#define SBOX(x, preLo, preHi, postLo, postHi) \
+	FILTER (_mm256_aesenclast_epi128 (FILTER (_mm256_shuffle_epi8 ((x), t->invShiftRow), preLo, preHi), _mm256_setzero_si256 ()), postLo, postHi)
+
+#define SBOX1(x)	SBOX (x, t->preLo1, t->preHi1, t->postLo1, t->postHi1)
+#define SBOX2(x)	SBOX (x, t->preLo1, t->preHi1, t->postLo2, t->postHi2)
+#define SBOX3(x)	SBOX (x, t->preLo1, t->preHi1, t->postLo3, t->postHi3)
+#define SBOX4(x)	SBOX (x, t->preLo4, t->preHi4, t->postLo1, t->postHi1)
+
+/* Rotation by one bit of the 32-bit word held in 4 byte slices, most significant byte first */
+#define MSB_TO_LSB(x)	AND256 (_mm256_srli_epi16 ((x), 7), one)
+#define ROL1(x0, x1, x2, x3, y0, y1, y2, y3) \
+	y0 = OR256 (_mm256_add_epi8 (x0, x0), MSB_TO_LSB (x1)); \
+	y1 = OR256 (_mm256_add_epi8 (x1, x1), MSB_TO_LSB (x2)); \
+	y2 = OR256 (_mm256_add_epi8 (x2, x2), MSB_TO_LSB (x3)); \
+	y3 = OR256 (_mm256_add_epi8 (x3, x3), MSB_TO_LSB (x0));
+
+/* Round function of camellia_set_key subkeys: x holds the 8 slices of the half processed by F and y those of the other half */
+VC_INLINE void camellia_vaes_round (const __m256i *x, __m256i *y, const uint8 *ks, int idx, const camellia_vaes_tables *t)
+{
+	__m256i s0 = SBOX1 (x[0]);
+	__m256i s1 = SBOX2 (x[1]);
+	__m256i s2 = SBOX3 (x[2]);
+	__m256i s3 = SBOX4 (x[3]);
+	__m256i s4 = SBOX2 (x[4]);
+	__m256i s5 = SBOX3 (x[5]);
+	__m256i s6 = SBOX4 (x[6]);
+	__m256i s7 = SBOX1 (x[7]);
+	__m256i l0, l1, l2, l3, r0, r1, r2, r3;
+
+	l0 = XOR256 (XOR256 (s0, s2), s3);
+	l1 = XOR256 (XOR256 (s0, s1), s3);
+	l2 = XOR256 (XOR256 (s0, s1), s2);
+	l3 = XOR256 (XOR256 (s1, s2), s3);
+
+	r0 = XOR256 (XOR256 (s7, s5), s6);
+	r1 = XOR256 (XOR256 (s7, s4), s6);
+	r2 = XOR256 (XOR256 (s7, s4), s5);
+	r3 = XOR256 (XOR256 (s4, s5), s6);
+
+	r0 = XOR256 (r0, l0);
+	r1 = XOR256 (r1, l1);
+	r2 = XOR256 (r2, l2);
+	r3 = XOR256 (r3, l3);
+
+	/* As in Camellia_x64.S, the subkeys of camellia_set_key are added after the P-function */
+	y[0] = XOR256 (y[0], XOR256 (r0, KEY_BYTE (ks, idx, 0)));
+	y[1] = XOR256 (y[1], XOR256 (r1, KEY_BYTE (ks, idx, 1)));
+	y[2] = XOR256 (y[2], XOR256 (r2, KEY_BYTE (ks, idx, 2)));
+	y[3] = XOR256 (y[3], XOR256 (r3, KEY_BYTE (ks, idx, 3)));
+	y[4] = XOR256 (y[4], XOR256 (XOR256 (r0, l3), KEY_BYTE (ks, idx, 4)));
+	y[5] = XOR256 (y[5], XOR256 (XOR256 (r1, l0), KEY_BYTE (ks, idx, 5)));
+	y[6] = XOR256 (y[6], XOR256 (XOR256 (r2, l1), KEY_BYTE (ks, idx, 6)));
+	y[7] = XOR256 (y[7], XOR256 (XOR256 (r3, l2), KEY_BYTE (ks, idx, 7)));
+}
+
+/* FL applied to the left half with subkey kl and FL^-1 to the right half with subkey kr */
+VC_INLINE void camellia_vaes_fls (__m256i *x, const uint8 *ks, int kl, int kr)
+{
+	const __m256i one = _mm256_set1_epi8 (1);
+	__m256i t0, t1, t2, t3, r0, r1, r2, r3;
+
+	t0 = AND256 (x[0], KEY_BYTE (ks, kl, 0));
+	t1 = AND256 (x[1], KEY_BYTE (ks, kl, 1));
+	t2 = AND256 (x[2], KEY_BYTE (ks, kl, 2));
+	t3 = AND256 (x[3], KEY_BYTE (ks, kl, 3));
+	ROL1 (t0, t1, t2, t3, r0, r1, r2, r3);
+	x[4] = XOR256 (x[4], r0);
+	x[5] = XOR256 (x[5], r1);
+	x[6] = XOR256 (x[6], r2);
+	x[7] = XOR256 (x[7], r3);
+
+	x[0] = XOR256 (x[0], OR256 (x[4], KEY_BYTE (ks, kl, 4)));
+	x[1] = XOR256 (x[1], OR256 (x[5], KEY_BYTE (ks, kl, 5)));
+	x[2] = XOR256 (x[2], OR256 (x[6], KEY_BYTE (ks, kl, 6)));
+	x[3] = XOR256 (x[3], OR256 (x[7], KEY_BYTE (ks, kl, 7)));
+
+	x[8] = XOR256 (x[8], OR256 (x[12], KEY_BYTE (ks, kr, 4)));
+	x[9] = XOR256 (x[9], OR256 (x[13], KEY_BYTE (ks, kr, 5)));
+	x[10] = XOR256 (x[10], OR256 (x[14], KEY_BYTE (ks, kr, 6)));
+	x[11] = XOR256 (x[11], OR256 (x[15], KEY_BYTE (ks, kr, 7)));
+
+	t0 = AND256 (x[8], KEY_BYTE (ks, kr, 0));
+	t1 = AND256 (x[9], KEY_BYTE (ks, kr, 1));
+	t2 = AND256 (x[10], KEY_BYTE (ks, kr, 2));
+	t3 = AND256 (x[11], KEY_BYTE (ks, kr, 3));
+	ROL1 (t0, t1, t2, t3, r0, r1, r2, r3);
+	x[12] = XOR256 (x[12], r0);
+	x[13] = XOR256 (x[13], r1);
+	x[14] = XOR256 (x[14], r2);
+	x[15] = XOR256 (x[15], r3);
+}
+
+/* XORs the 64-bit subkey idx into the 8 slices of a half */
+VC_INLINE void camellia_vaes_whiten (__m256i *x, const uint8 *ks, int idx)
+{
+	int j;
+
+	for (j = 0; j < 8; j++)
+		x[j] = XOR256 (x[j], KEY_BYTE (ks, idx, j));
+}
+
+/* Transposes the 16x16 byte matrix held in each 128-bit lane of x[0..15]: every pass rotates the 8-bit
+   (row, column) index left by one bit, so four passes exchange rows and columns */
+static void camellia_vaes_transpose (__m256i *x)
+{
+	__m256i y[16];
+	int pass, k;
+
+	for (pass = 0; pass < 4; pass++)
+	{
+		for (k = 0; k < 8; k++)
+		{
+			y[2 * k] = _mm256_unpacklo_epi8 (x[k], x[k + 8]);
+			y[2 * k + 1] = _mm256_unpackhi_epi8 (x[k], x[k + 8]);
+		}
+
+		for (k = 0; k < 16; k++)
+			x[k] = y[k];
+	}
+}
+
+static void camellia_vaes_load_tables (camellia_vaes_tables *t)
+{
+	t->mask4 = _mm256_set1_epi8 (0x0f);
+	t->invShiftRow = LOAD_TABLE (camellia_inv_shift_row);
+	t->preLo1 = LOAD_TABLE (camellia_pre_tf_lo_s1);
+	t->preHi1 = LOAD_TABLE (camellia_pre_tf_hi_s1);
+	t->preLo4 = LOAD_TABLE (camellia_pre_tf_lo_s4);
+	t->preHi4 = LOAD_TABLE (camellia_pre_tf_hi_s4);
+	t->postLo1 = LOAD_TABLE (camellia_post_tf_lo_s1);
+	t->postHi1 = LOAD_TABLE (camellia_post_tf_hi_s1);
+	t->postLo2 = LOAD_TABLE (camellia_post_tf_lo_s2);
+	t->postHi2 = LOAD_TABLE (camellia_post_tf_hi_s2);
+	t->postLo3 = LOAD_TABLE (camellia_post_tf_lo_s3);
+	t->postHi3 = LOAD_TABLE (camellia_post_tf_hi_s3);
+}
+
+/* Loads 32 blocks so that x[j] holds byte j of each block, the first 8 slices being the left half */
+VC_INLINE void camellia_vaes_load (__m256i *x, const uint8 *in_blk)
+{
+	int j;
+
+	for (j = 0; j < 16; j++)
+		x[j] = _mm256_loadu_si256 ((const __m256i *) (in_blk + j * 32));
+
+	camellia_vaes_transpose (x);
+}
+
+/* Stores the halves in swapped order, as done by the last round of Camellia */
+VC_INLINE void camellia_vaes_store (__m256i *x, uint8 *out_blk)
+{
+	__m256i y[16];
+	int j;
+
+	for (j = 0; j < 8; j++)
+	{
+		y[j] = x[j + 8];
+		y[j + 8] = x[j];
+	}
+
+	camellia_vaes_transpose (y);
+
+	for (j = 0; j < 16; j++)
+		_mm256_storeu_si256 ((__m256i *) (out_blk + j * 32), y[j]);
+}
+
+#define ENC_ROUNDS6(k) \
+	camellia_vaes_round (x, x + 8, ks, (k), &t); \
+	camellia_vaes_round (x + 8, x, ks, (k) + 1, &t); \
+	camellia_vaes_round (x, x + 8, ks, (k) + 2, &t); \
+	camellia_vaes_round (x + 8, x, ks, (k) + 3, &t); \
+	camellia_vaes_round (x, x + 8, ks, (k) + 4, &t); \
+	camellia_vaes_round (x + 8, x, ks, (k) + 5, &t);
+
+#define DEC_ROUNDS6(k) \
+	camellia_vaes_round (x, x + 8, ks, (k), &t); \
+	camellia_vaes_round (x + 8, x, ks, (k) - 1, &t); \
+	camellia_vaes_round (x, x + 8, ks, (k) - 2, &t); \
+	camellia_vaes_round (x + 8, x, ks, (k) - 3, &t); \
+	camellia_vaes_round (x, x + 8, ks, (k) - 4, &t); \
+	camellia_vaes_round (x + 8, x, ks, (k) - 5, &t);
+
+uint32 camellia_vaes_encrypt_blocks_32 (const uint8 *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount)
+{
+	camellia_vaes_tables t;
+	__m256i x[16];
+	uint32 processed = 0;
+
+	camellia_vaes_load_tables (&t);
+
+	while (blockCount - processed >= 32)
+	{
+		camellia_vaes_load (x, in_blk);
+
+		camellia_vaes_whiten (x, ks, 0);
+		ENC_ROUNDS6 (2);
+		camellia_vaes_fls (x, ks, 8, 9);
+		ENC_ROUNDS6 (10);
+		camellia_vaes_fls (x, ks, 16, 17);
+		ENC_ROUNDS6 (18);
+		camellia_vaes_fls (x, ks, 24, 25);
+		ENC_ROUNDS6 (26);
+		camellia_vaes_whiten (x + 8, ks, 32);
+
+		camellia_vaes_store (x, out_blk);
+
+		in_blk += 32 * 16;
+		out_blk += 32 * 16;
+		processed += 32;
+	}
+
+	return processed;
+}
+
+uint32 camellia_vaes_decrypt_blocks_32 (const uint8 *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount)
+{
+	camellia_vaes_tables t;
+	__m256i x[16];
+	uint32 processed = 0;
+
+	camellia_vaes_load_tables (&t);
+
+	while (blockCount - processed >= 32)
+	{
+		camellia_vaes_load (x, in_blk);
+
+		camellia_vaes_whiten (x, ks, 32);
+		DEC_ROUNDS6 (31);
+		camellia_vaes_fls (x, ks, 25, 24);
+		DEC_ROUNDS6 (23);
+		camellia_vaes_fls (x, ks, 17, 16);
+		DEC_ROUNDS6 (15);
+		camellia_vaes_fls (x, ks, 9, 8);
+		DEC_ROUNDS6 (7);
+		camellia_vaes_whiten (x + 8, ks, 0);
+
+		camellia_vaes_store (x, out_blk);
+
+		in_blk += 32 * 16;
+		out_blk += 32 * 16;
+		processed += 32;
+	}
+
+	return processed;
+}
+
+#else
+
+uint32 camellia_vaes_encrypt_blocks_32 (const uint8 *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount)
+{
+	(void) ks;
+	(void) in_blk;
+	(void) out_blk;
+	(void) blockCount;
+	return 0; /* VAES not available */
+}
+
+uint32 camellia_vaes_decrypt_blocks_32 (const uint8 *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount)
+{
+	(void) ks;
+	(void) in_blk;
+	(void) out_blk;
+	(void) blockCount;
+	return 0; /* VAES not available */
+}
+
+#endif
+
+#endif // CRYPTOPP_BOOL_X64 && !CRYPTOPP_DISABLE_ASM
@@ -36,6 +36,12 @@
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
 extern void serpent_simd_encrypt_blocks_4(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key);
 extern void serpent_simd_decrypt_blocks_4(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key);
+/* AVX2 versions processing 8 blocks at a time. They return the number of blocks processed, 0 if AVX2 support was not compiled in */
+extern size_t serpent_avx2_encrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key);
+extern size_t serpent_avx2_decrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key);
+/* AVX-512 versions processing 16 blocks at a time, 0 if AVX-512 support was not compiled in */
+extern size_t serpent_avx512_encrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key);
+extern size_t serpent_avx512_decrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key);
 #endif
 
 /*
@@ -81,6 +87,24 @@ void serpent_encrypt_blocks(const unsigned __int8* in, unsigned __int8* out, siz
    unsigned __int32* round_key = ((unsigned __int32*) ks) + 8;
    size_t i;
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
+#if !defined (TC_WINDOWS_DRIVER)
+   if(HasSAVX512() && (blocks >= 16))
+   {
+      size_t processed = serpent_avx512_encrypt_blocks_16(in, out, blocks, round_key);
+      in += processed * 16;
+      out += processed * 16;
+      blocks -= processed;
+   }
+
+   if(HasSAVX2() && (blocks >= 8))
+   {
+      size_t processed = serpent_avx2_encrypt_blocks_8(in, out, blocks, round_key);
+      in += processed * 16;
+      out += processed * 16;
+      blocks -= processed;
+   }
+#endif
+
    if(HasSSE2() && (blocks >= 4))
    {
       while(blocks >= 4)
@@ -160,6 +184,24 @@ void serpent_decrypt_blocks(const unsigned __int8* in, unsigned __int8* out, siz
    unsigned __int32* round_key = ((unsigned __int32*) ks) + 8;
    size_t i;
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
+#if !defined (TC_WINDOWS_DRIVER)
+   if(HasSAVX512() && (blocks >= 16))
+   {
+      size_t processed = serpent_avx512_decrypt_blocks_16(in, out, blocks, round_key);
+      in += processed * 16;
+      out += processed * 16;
+      blocks -= processed;
+   }
+
+   if(HasSAVX2() && (blocks >= 8))
+   {
+      size_t processed = serpent_avx2_decrypt_blocks_8(in, out, blocks, round_key);
+      in += processed * 16;
+      out += processed * 16;
+      blocks -= processed;
+   }
+#endif
+
    if(HasSSE2() && (blocks >= 4))
    {
       while(blocks >= 4)
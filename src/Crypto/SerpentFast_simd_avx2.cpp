@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2013-2025 AM Crypto
+ * Governed by the Apache License 2.0 the full text of which is contained
+ * in the file License.txt included in VeraCrypt binary and source
+ * code distribution packages.
+ */
+
+/* Serpent encryption and decryption of 8 blocks in parallel using AVX2.
+   Same bitsliced evaluation as SerpentFast_simd.cpp, each 256-bit register
+   holding one word of 8 blocks. */
+
+#include "SerpentFast.h"
+#include "SerpentFast_sbox.h"
+#if !defined(_UEFI)
+#include <memory.h>
+#include <stdlib.h>
+#endif
+#include "cpu.h"
+#include "misc.h"
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+
+#if defined(__AVX2__) && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
+
+#include <immintrin.h>
+
+class SIMD_8x32
+{
+public:
+
+    SIMD_8x32() // zero initialized
+        {
+        m_reg = _mm256_setzero_si256();
+        }
+
+    explicit SIMD_8x32(unsigned __int32 B)
+        {
+        m_reg = _mm256_set1_epi32(B);
+        }
+
+    static SIMD_8x32 load_le(const void* in)
+        {
+        return SIMD_8x32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)));
+        }
+
+    void store_le(unsigned __int8 out[]) const
+        {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), m_reg);
+        }
+
+    void rotate_left(size_t rot)
+        {
+        m_reg = _mm256_or_si256(_mm256_slli_epi32(m_reg, static_cast<int>(rot)),
+                               _mm256_srli_epi32(m_reg, static_cast<int>(32-rot)));
+        }
+
+    void rotate_right(size_t rot)
+        {
+        rotate_left(32 - rot);
+        }
+
+    void operator^=(const SIMD_8x32& other)
+        {
+        m_reg = _mm256_xor_si256(m_reg, other.m_reg);
+        }
+
+    SIMD_8x32 operator^(const SIMD_8x32& other) const
+        {
+        return SIMD_8x32(_mm256_xor_si256(m_reg, other.m_reg));
+        }
+
+    void operator|=(const SIMD_8x32& other)
+        {
+        m_reg = _mm256_or_si256(m_reg, other.m_reg);
+        }
+
+    void operator&=(const SIMD_8x32& other)
+        {
+        m_reg = _mm256_and_si256(m_reg, other.m_reg);
+        }
+
+    SIMD_8x32 operator<<(size_t shift) const
+        {
+        return SIMD_8x32(_mm256_slli_epi32(m_reg, static_cast<int>(shift)));
+        }
+
+    SIMD_8x32 operator~() const
+        {
+        return SIMD_8x32(_mm256_xor_si256(m_reg, _mm256_set1_epi32(0xFFFFFFFF)));
+        }
+
+    /* 4x4 transpose of the 32-bit words within each 128-bit half: with two
+       blocks per register, Bi then holds word i of the 8 blocks */
+    static void transpose(SIMD_8x32& B0, SIMD_8x32& B1,
+                        SIMD_8x32& B2, SIMD_8x32& B3)
+        {
+        __m256i T0 = _mm256_unpacklo_epi32(B0.m_reg, B1.m_reg);
+        __m256i T1 = _mm256_unpacklo_epi32(B2.m_reg, B3.m_reg);
+        __m256i T2 = _mm256_unpackhi_epi32(B0.m_reg, B1.m_reg);
+        __m256i T3 = _mm256_unpackhi_epi32(B2.m_reg, B3.m_reg);
+        B0.m_reg = _mm256_unpacklo_epi64(T0, T1);
+        B1.m_reg = _mm256_unpackhi_epi64(T0, T1);
+        B2.m_reg = _mm256_unpacklo_epi64(T2, T3);
+        B3.m_reg = _mm256_unpackhi_epi64(T2, T3);
+        }
+
+private:
+
+    explicit SIMD_8x32(__m256i in) { m_reg = in; }
+
+    __m256i m_reg;
+
+};
+
+typedef SIMD_8x32 SIMD_32;
+
+#define key_xor(round, B0, B1, B2, B3)                             \
+   do {                                                            \
+      B0 ^= SIMD_32(round_key[4*round  ]);                       \
+      B1 ^= SIMD_32(round_key[4*round+1]);                       \
+      B2 ^= SIMD_32(round_key[4*round+2]);                       \
+      B3 ^= SIMD_32(round_key[4*round+3]);                       \
+   } while(0);
+
+/*
+* Serpent's linear transformations
+*/
+#define transform(B0, B1, B2, B3)                                  \
+   do {                                                            \
+      B0.rotate_left(13);                                          \
+      B2.rotate_left(3);                                           \
+      B1 ^= B0 ^ B2;                                               \
+      B3 ^= B2 ^ (B0 << 3);                                        \
+      B1.rotate_left(1);                                           \
+      B3.rotate_left(7);                                           \
+      B0 ^= B1 ^ B3;                                               \
+      B2 ^= B3 ^ (B1 << 7);                                        \
+      B0.rotate_left(5);                                           \
+      B2.rotate_left(22);                                          \
+   } while(0);
+
+#define i_transform(B0, B1, B2, B3)                                \
+   do {                                                            \
+      B2.rotate_right(22);                                         \
+      B0.rotate_right(5);                                          \
+      B2 ^= B3 ^ (B1 << 7);                                        \
+      B0 ^= B1 ^ B3;                                               \
+      B3.rotate_right(7);                                          \
+      B1.rotate_right(1);                                          \
+      B3 ^= B2 ^ (B0 << 3);                                        \
+      B1 ^= B0 ^ B2;                                               \
+      B2.rotate_right(3);                                          \
+      B0.rotate_right(13);                                         \
+   } while(0);
+
+
+/*
+* SIMD Serpent Encryption of 8 blocks in parallel, repeated while at least 8 blocks
+* remain. Returns the number of blocks processed.
+*/
+extern "C" size_t serpent_avx2_encrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key)
+{
+   size_t processed = 0;
+
+   while(blocks >= 8)
+   {
+      SIMD_32 B0 = SIMD_32::load_le(in);
+      SIMD_32 B1 = SIMD_32::load_le(in + 32);
+      SIMD_32 B2 = SIMD_32::load_le(in + 64);
+      SIMD_32 B3 = SIMD_32::load_le(in + 96);
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      key_xor( 0,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 1,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 2,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 3,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 4,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 5,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 6,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 7,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+
+      key_xor( 8,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 9,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(10,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(11,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(12,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(13,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(14,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(15,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+
+      key_xor(16,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(17,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(18,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(19,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(20,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(21,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(22,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(23,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+
+      key_xor(24,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(25,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(26,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(27,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(28,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(29,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(30,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(31,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); key_xor(32,B0,B1,B2,B3);
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      B0.store_le(out);
+      B1.store_le(out + 32);
+      B2.store_le(out + 64);
+      B3.store_le(out + 96);
+
+      in += 8 * 16;
+      out += 8 * 16;
+      blocks -= 8;
+      processed += 8;
+   }
+
+   return processed;
+}
+
+/*
+* SIMD Serpent Decryption of 8 blocks in parallel, repeated while at least 8 blocks
+* remain. Returns the number of blocks processed.
+*/
+extern "C" size_t serpent_avx2_decrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key)
+{
+   size_t processed = 0;
+
+   while(blocks >= 8)
+   {
+      SIMD_32 B0 = SIMD_32::load_le(in);
+      SIMD_32 B1 = SIMD_32::load_le(in + 32);
+      SIMD_32 B2 = SIMD_32::load_le(in + 64);
+      SIMD_32 B3 = SIMD_32::load_le(in + 96);
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      key_xor(32,B0,B1,B2,B3);  SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor(31,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor(30,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor(29,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor(28,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor(27,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor(26,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor(25,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor(24,B0,B1,B2,B3);
+
+      i_transform(B0,B1,B2,B3); SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor(23,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor(22,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor(21,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor(20,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor(19,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor(18,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor(17,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor(16,B0,B1,B2,B3);
+
+      i_transform(B0,B1,B2,B3); SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor(15,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor(14,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor(13,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor(12,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor(11,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor(10,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor( 9,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor( 8,B0,B1,B2,B3);
+
+      i_transform(B0,B1,B2,B3); SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor( 7,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor( 6,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor( 5,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor( 4,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor( 3,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor( 2,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor( 1,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor( 0,B0,B1,B2,B3);
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      B0.store_le(out);
+      B1.store_le(out + 32);
+      B2.store_le(out + 64);
+      B3.store_le(out + 96);
+
+      in += 8 * 16;
+      out += 8 * 16;
+      blocks -= 8;
+      processed += 8;
+   }
+
+   return processed;
+}
+
+#undef key_xor
+#undef transform
+#undef i_transform
+
+#else
+
+extern "C" size_t serpent_avx2_encrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key)
+{
+   return 0; /* AVX2 not available */
+}
+
+extern "C" size_t serpent_avx2_decrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key)
+{
+   return 0; /* AVX2 not available */
+}
+
+#endif
+
+#endif
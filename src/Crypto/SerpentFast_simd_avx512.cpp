@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2013-2025 AM Crypto
+ * Governed by the Apache License 2.0 the full text of which is contained
+ * in the file License.txt included in VeraCrypt binary and source
+ * code distribution packages.
+ */
+
+/* Serpent encryption and decryption of 16 blocks in parallel using AVX-512F.
+   Same bitsliced evaluation as SerpentFast_simd_avx2.cpp, each 512-bit register
+   holding one word of 16 blocks. */
+
+#include "SerpentFast.h"
+#include "SerpentFast_sbox.h"
+#if !defined(_UEFI)
+#include <memory.h>
+#include <stdlib.h>
+#endif
+#include "cpu.h"
+#include "misc.h"
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+
+#if defined(__AVX512F__) && !defined (TC_WINDOWS_DRIVER)
+
+#include <immintrin.h>
+
+class SIMD_16x32
+{
+public:
+
+    SIMD_16x32() // zero initialized
+        {
+        m_reg = _mm512_setzero_si512();
+        }
+
+    explicit SIMD_16x32(unsigned __int32 B)
+        {
+        m_reg = _mm512_set1_epi32(B);
+        }
+
+    static SIMD_16x32 load_le(const void* in)
+        {
+        return SIMD_16x32(_mm512_loadu_si512(reinterpret_cast<const __m512i*>(in)));
+        }
+
+    void store_le(unsigned __int8 out[]) const
+        {
+        _mm512_storeu_si512(reinterpret_cast<__m512i*>(out), m_reg);
+        }
+
+    void rotate_left(size_t rot)
+        {
+        m_reg = _mm512_rolv_epi32(m_reg, _mm512_set1_epi32(static_cast<int>(rot)));
+        }
+
+    void rotate_right(size_t rot)
+        {
+        rotate_left(32 - rot);
+        }
+
+    void operator^=(const SIMD_16x32& other)
+        {
+        m_reg = _mm512_xor_si512(m_reg, other.m_reg);
+        }
+
+    SIMD_16x32 operator^(const SIMD_16x32& other) const
+        {
+        return SIMD_16x32(_mm512_xor_si512(m_reg, other.m_reg));
+        }
+
+    void operator|=(const SIMD_16x32& other)
+        {
+        m_reg = _mm512_or_si512(m_reg, other.m_reg);
+        }
+
+    void operator&=(const SIMD_16x32& other)
+        {
+        m_reg = _mm512_and_si512(m_reg, other.m_reg);
+        }
+
+    SIMD_16x32 operator<<(size_t shift) const
+        {
+        return SIMD_16x32(_mm512_slli_epi32(m_reg, static_cast<int>(shift)));
+        }
+
+    SIMD_16x32 operator~() const
+        {
+        return SIMD_16x32(_mm512_xor_si512(m_reg, _mm512_set1_epi32(0xFFFFFFFF)));
+        }
+
+    /* 4x4 transpose of the 32-bit words within each 128-bit lane: with four
+       blocks per register, Bi then holds word i of the 16 blocks */
+    static void transpose(SIMD_16x32& B0, SIMD_16x32& B1,
+                        SIMD_16x32& B2, SIMD_16x32& B3)
+        {
+        __m512i T0 = _mm512_unpacklo_epi32(B0.m_reg, B1.m_reg);
+        __m512i T1 = _mm512_unpacklo_epi32(B2.m_reg, B3.m_reg);
+        __m512i T2 = _mm512_unpackhi_epi32(B0.m_reg, B1.m_reg);
+        __m512i T3 = _mm512_unpackhi_epi32(B2.m_reg, B3.m_reg);
+        B0.m_reg = _mm512_unpacklo_epi64(T0, T1);
+        B1.m_reg = _mm512_unpackhi_epi64(T0, T1);
+        B2.m_reg = _mm512_unpacklo_epi64(T2, T3);
+        B3.m_reg = _mm512_unpackhi_epi64(T2, T3);
+        }
+
+private:
+
+    explicit SIMD_16x32(__m512i in) { m_reg = in; }
+
+    __m512i m_reg;
+
+};
+
+typedef SIMD_16x32 SIMD_32;
+
+#define key_xor(round, B0, B1, B2, B3)                             \
+   do {                                                            \
+      B0 ^= SIMD_32(round_key[4*round  ]);                       \
+      B1 ^= SIMD_32(round_key[4*round+1]);                       \
+      B2 ^= SIMD_32(round_key[4*round+2]);                       \
+      B3 ^= SIMD_32(round_key[4*round+3]);                       \
+   } while(0);
+
+/*
+* Serpent's linear transformations
+*/
+#define transform(B0, B1, B2, B3)                                  \
+   do {                                                            \
+      B0.rotate_left(13);                                          \
+      B2.rotate_left(3);                                           \
+      B1 ^= B0 ^ B2;                                               \
+      B3 ^= B2 ^ (B0 << 3);                                        \
+      B1.rotate_left(1);                                           \
+      B3.rotate_left(7);                                           \
+      B0 ^= B1 ^ B3;                                               \
+      B2 ^= B3 ^ (B1 << 7);                                        \
+      B0.rotate_left(5);                                           \
+      B2.rotate_left(22);                                          \
+   } while(0);
+
+#define i_transform(B0, B1, B2, B3)                                \
+   do {                                                            \
+      B2.rotate_right(22);                                         \
+      B0.rotate_right(5);                                          \
+      B2 ^= B3 ^ (B1 << 7);                                        \
+      B0 ^= B1 ^ B3;                                               \
+      B3.rotate_right(7);                                          \
+      B1.rotate_right(1);                                          \
+      B3 ^= B2 ^ (B0 << 3);                                        \
+      B1 ^= B0 ^ B2;                                               \
+      B2.rotate_right(3);                                          \
+      B0.rotate_right(13);                                         \
+   } while(0);
+
+
+/*
+* SIMD Serpent Encryption of 16 blocks in parallel, repeated while at least 16 blocks
+* remain. Returns the number of blocks processed.
+*/
+extern "C" size_t serpent_avx512_encrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key)
+{
+   size_t processed = 0;
+
+   while(blocks >= 16)
+   {
+      SIMD_32 B0 = SIMD_32::load_le(in);
+      SIMD_32 B1 = SIMD_32::load_le(in + 64);
+      SIMD_32 B2 = SIMD_32::load_le(in + 128);
+      SIMD_32 B3 = SIMD_32::load_le(in + 192);
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      key_xor( 0,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 1,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 2,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 3,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 4,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 5,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 6,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 7,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+
+      key_xor( 8,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor( 9,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(10,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(11,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(12,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(13,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(14,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(15,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+
+      key_xor(16,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(17,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(18,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(19,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(20,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(21,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(22,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(23,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+
+      key_xor(24,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(25,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(26,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(27,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(28,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(29,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(30,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
+      key_xor(31,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); key_xor(32,B0,B1,B2,B3);
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      B0.store_le(out);
+      B1.store_le(out + 64);
+      B2.store_le(out + 128);
+      B3.store_le(out + 192);
+
+      in += 16 * 16;
+      out += 16 * 16;
+      blocks -= 16;
+      processed += 16;
+   }
+
+   return processed;
+}
+
+/*
+* SIMD Serpent Decryption of 16 blocks in parallel, repeated while at least 16 blocks
+* remain. Returns the number of blocks processed.
+*/
+extern "C" size_t serpent_avx512_decrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key)
+{
+   size_t processed = 0;
+
+   while(blocks >= 16)
+   {
+      SIMD_32 B0 = SIMD_32::load_le(in);
+      SIMD_32 B1 = SIMD_32::load_le(in + 64);
+      SIMD_32 B2 = SIMD_32::load_le(in + 128);
+      SIMD_32 B3 = SIMD_32::load_le(in + 192);
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      key_xor(32,B0,B1,B2,B3);  SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor(31,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor(30,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor(29,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor(28,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor(27,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor(26,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor(25,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor(24,B0,B1,B2,B3);
+
+      i_transform(B0,B1,B2,B3); SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor(23,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor(22,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor(21,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor(20,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor(19,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor(18,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor(17,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor(16,B0,B1,B2,B3);
+
+      i_transform(B0,B1,B2,B3); SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor(15,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor(14,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor(13,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor(12,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor(11,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor(10,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor( 9,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor( 8,B0,B1,B2,B3);
+
+      i_transform(B0,B1,B2,B3); SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor( 7,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor( 6,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor( 5,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor( 4,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor( 3,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor( 2,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor( 1,B0,B1,B2,B3);
+      i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor( 0,B0,B1,B2,B3);
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      B0.store_le(out);
+      B1.store_le(out + 64);
+      B2.store_le(out + 128);
+      B3.store_le(out + 192);
+
+      in += 16 * 16;
+      out += 16 * 16;
+      blocks -= 16;
+      processed += 16;
+   }
+
+   return processed;
+}
+
+#undef key_xor
+#undef transform
+#undef i_transform
+
+#else
+
+extern "C" size_t serpent_avx512_encrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key)
+{
+   return 0; /* AVX-512 not available */
+}
+
+extern "C" size_t serpent_avx512_decrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], size_t blocks, unsigned __int32* round_key)
+{
+   return 0; /* AVX-512 not available */
+}
+
+#endif
+
+#endif
@@ -63,6 +63,26 @@ void sha256_hash(const unsigned char * source, uint_32t sourceLen, sha256_ctx *c
 void sha256_end(unsigned char * result, sha256_ctx* ctx);
 void sha256(unsigned char * result, const unsigned char* source, uint_32t sourceLen);
 
+#if !defined(WOLFCRYPT_BACKEND) && !defined(_UEFI) && !defined(TC_WINDOWS_DRIVER) && !defined(CRYPTOPP_DISABLE_ASM) && (CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32)
+/* PBKDF2-HMAC blocks computed in parallel by sha256_pbkdf2_x8 and sha512_pbkdf2_x4 (AVX2) */
+#define SHA256_PBKDF2_LANES	8
+#define SHA512_PBKDF2_LANES	4
+
+/* u holds U1 of each lane as native words on input and the XOR of U1..Uc on output.
+   innerState and outerState are the states after compressing the padded HMAC key.
+   Returns 0 if the AVX2 implementation was not compiled in. */
+int sha256_pbkdf2_x8 (const uint_32t innerState[8], const uint_32t outerState[8], uint_32t u[SHA256_PBKDF2_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation);
+int sha512_pbkdf2_x4 (const uint_64t innerState[8], const uint_64t outerState[8], uint_64t u[SHA512_PBKDF2_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation);
+
+/* Same as sha512_pbkdf2_x4 with eight lanes of AVX-512 registers. Returns 0 if the AVX-512 implementation was not compiled in. */
+#define SHA512_PBKDF2_AVX512_LANES	8
+int sha512_pbkdf2_x8 (const uint_64t innerState[8], const uint_64t outerState[8], uint_64t u[SHA512_PBKDF2_AVX512_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation);
+
+/* Same as sha256_pbkdf2_x8, using two interleaved SHA-NI streams. Returns 0 if SHA-NI support was not compiled in. */
+#define SHA256_PBKDF2_SHANI_LANES	2
+int sha256_pbkdf2_shani_x2 (const uint_32t innerState[8], const uint_32t outerState[8], uint_32t u[SHA256_PBKDF2_SHANI_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation);
+#endif
+
 #if defined(__cplusplus)
 }
 #endif
@@ -274,5 +274,167 @@ void sha256_intel(void *mp, uint_32t state[8], uint_64t num_blks)
     _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(STATE1, STATE0, 8));     // HGFE
 }
 
+#ifdef SHA256_PBKDF2_SHANI_LANES
+
+CRYPTOPP_ALIGN_DATA(64) static const uint_32t SHA256_PBKDF2_K[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+// Four rounds of both streams. The instructions of the two streams are interleaved to hide the latency of sha256rnds2.
+#define SHANI_X2_ROUNDS(i, w) \
+    { \
+        __m128i MSGA = _mm_add_epi32(WA##w, _mm_load_si128(K_mm + (i))); \
+        __m128i MSGB = _mm_add_epi32(WB##w, _mm_load_si128(K_mm + (i))); \
+        CDGHA = _mm_sha256rnds2_epu32(CDGHA, ABEFA, MSGA); \
+        CDGHB = _mm_sha256rnds2_epu32(CDGHB, ABEFB, MSGB); \
+        ABEFA = _mm_sha256rnds2_epu32(ABEFA, CDGHA, _mm_shuffle_epi32(MSGA, 0x0E)); \
+        ABEFB = _mm_sha256rnds2_epu32(ABEFB, CDGHB, _mm_shuffle_epi32(MSGB, 0x0E)); \
+    }
+
+// Next four message words of both streams: W[w0] = msg2(msg1(W[w0], W[w1]) + alignr(W[w3], W[w2]), W[w3])
+#define SHANI_X2_SCHEDULE(w0, w1, w2, w3) \
+    WA##w0 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(WA##w0, WA##w1), _mm_alignr_epi8(WA##w3, WA##w2, 4)), WA##w3); \
+    WB##w0 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(WB##w0, WB##w1), _mm_alignr_epi8(WB##w3, WB##w2, 4)), WB##w3)
+
+// Converts between the word order of the state (A..H) and the ABEF/CDGH order used by sha256rnds2
+#define SHANI_TO_ABEF_CDGH(lo, hi) \
+    { \
+        __m128i TMP; \
+        lo = _mm_shuffle_epi32(lo, 0xB1); \
+        hi = _mm_shuffle_epi32(hi, 0x1B); \
+        TMP = _mm_alignr_epi8(lo, hi, 8); \
+        hi = _mm_blend_epi16(hi, lo, 0xF0); \
+        lo = TMP; \
+    }
+
+#define SHANI_FROM_ABEF_CDGH(abef, cdgh) \
+    { \
+        __m128i TMP; \
+        abef = _mm_shuffle_epi32(abef, 0x1B); \
+        cdgh = _mm_shuffle_epi32(cdgh, 0xB1); \
+        TMP = _mm_blend_epi16(abef, cdgh, 0xF0); \
+        cdgh = _mm_alignr_epi8(cdgh, abef, 8); \
+        abef = TMP; \
+    }
+
+/* Compresses one 64-byte block of each stream. The message words are in native order and are overwritten. */
+VC_INLINE void sha256_shani_compress_x2(__m128i *ABEF_A, __m128i *CDGH_A, __m128i *ABEF_B, __m128i *CDGH_B, __m128i WA[4], __m128i WB[4])
+{
+    const __m128i* K_mm = (const __m128i*)SHA256_PBKDF2_K;
+    __m128i ABEFA = *ABEF_A, CDGHA = *CDGH_A, ABEFB = *ABEF_B, CDGHB = *CDGH_B;
+    __m128i WA0 = WA[0], WA1 = WA[1], WA2 = WA[2], WA3 = WA[3];
+    __m128i WB0 = WB[0], WB1 = WB[1], WB2 = WB[2], WB3 = WB[3];
+
+    SHANI_X2_ROUNDS(0, 0);
+    SHANI_X2_ROUNDS(1, 1);
+    SHANI_X2_ROUNDS(2, 2);
+    SHANI_X2_ROUNDS(3, 3);
+
+    SHANI_X2_SCHEDULE(0, 1, 2, 3); SHANI_X2_ROUNDS(4, 0);
+    SHANI_X2_SCHEDULE(1, 2, 3, 0); SHANI_X2_ROUNDS(5, 1);
+    SHANI_X2_SCHEDULE(2, 3, 0, 1); SHANI_X2_ROUNDS(6, 2);
+    SHANI_X2_SCHEDULE(3, 0, 1, 2); SHANI_X2_ROUNDS(7, 3);
+    SHANI_X2_SCHEDULE(0, 1, 2, 3); SHANI_X2_ROUNDS(8, 0);
+    SHANI_X2_SCHEDULE(1, 2, 3, 0); SHANI_X2_ROUNDS(9, 1);
+    SHANI_X2_SCHEDULE(2, 3, 0, 1); SHANI_X2_ROUNDS(10, 2);
+    SHANI_X2_SCHEDULE(3, 0, 1, 2); SHANI_X2_ROUNDS(11, 3);
+    SHANI_X2_SCHEDULE(0, 1, 2, 3); SHANI_X2_ROUNDS(12, 0);
+    SHANI_X2_SCHEDULE(1, 2, 3, 0); SHANI_X2_ROUNDS(13, 1);
+    SHANI_X2_SCHEDULE(2, 3, 0, 1); SHANI_X2_ROUNDS(14, 2);
+    SHANI_X2_SCHEDULE(3, 0, 1, 2); SHANI_X2_ROUNDS(15, 3);
+
+    *ABEF_A = _mm_add_epi32(*ABEF_A, ABEFA);
+    *CDGH_A = _mm_add_epi32(*CDGH_A, CDGHA);
+    *ABEF_B = _mm_add_epi32(*ABEF_B, ABEFB);
+    *CDGH_B = _mm_add_epi32(*CDGH_B, CDGHB);
+}
+
+// PBKDF2-HMAC-SHA256 iterations 2..c of two blocks, computed as two interleaved SHA-NI streams
+int sha256_pbkdf2_shani_x2(const uint_32t innerState[8], const uint_32t outerState[8], uint_32t u[SHA256_PBKDF2_SHANI_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation)
+{
+    // Padding of a 32-byte message following the 64-byte key block
+    const __m128i PAD0 = _mm_setr_epi32((int) 0x80000000, 0, 0, 0);
+    const __m128i PAD1 = _mm_setr_epi32(0, 0, 0, (SHA256_BLOCK_SIZE + SHA256_DIGEST_SIZE) * 8);
+    __m128i INNER_ABEF = _mm_loadu_si128((const __m128i*)&innerState[0]);
+    __m128i INNER_CDGH = _mm_loadu_si128((const __m128i*)&innerState[4]);
+    __m128i OUTER_ABEF = _mm_loadu_si128((const __m128i*)&outerState[0]);
+    __m128i OUTER_CDGH = _mm_loadu_si128((const __m128i*)&outerState[4]);
+    __m128i UA0 = _mm_loadu_si128((const __m128i*)&u[0][0]);
+    __m128i UA1 = _mm_loadu_si128((const __m128i*)&u[0][4]);
+    __m128i UB0 = _mm_loadu_si128((const __m128i*)&u[1][0]);
+    __m128i UB1 = _mm_loadu_si128((const __m128i*)&u[1][4]);
+    __m128i TA0 = UA0, TA1 = UA1, TB0 = UB0, TB1 = UB1;
+    __m128i ABEFA, CDGHA, ABEFB, CDGHB;
+    __m128i WA[4], WB[4];
+    uint_32t c;
+
+    SHANI_TO_ABEF_CDGH(INNER_ABEF, INNER_CDGH);
+    SHANI_TO_ABEF_CDGH(OUTER_ABEF, OUTER_CDGH);
+
+    for (c = 1; c < iterations; c++)
+    {
+        // CANCELLATION CHECK: Check every 1024 iterations
+        if (pAbortKeyDerivation && (c & 1023) == 0 && *pAbortKeyDerivation == 1)
+            break;
+
+        // Inner hash of the previous U
+        ABEFA = ABEFB = INNER_ABEF;
+        CDGHA = CDGHB = INNER_CDGH;
+        WA[0] = UA0; WA[1] = UA1; WA[2] = PAD0; WA[3] = PAD1;
+        WB[0] = UB0; WB[1] = UB1; WB[2] = PAD0; WB[3] = PAD1;
+
+        sha256_shani_compress_x2(&ABEFA, &CDGHA, &ABEFB, &CDGHB, WA, WB);
+
+        SHANI_FROM_ABEF_CDGH(ABEFA, CDGHA);
+        SHANI_FROM_ABEF_CDGH(ABEFB, CDGHB);
+
+        // Outer hash of the inner digest
+        WA[0] = ABEFA; WA[1] = CDGHA; WA[2] = PAD0; WA[3] = PAD1;
+        WB[0] = ABEFB; WB[1] = CDGHB; WB[2] = PAD0; WB[3] = PAD1;
+        ABEFA = ABEFB = OUTER_ABEF;
+        CDGHA = CDGHB = OUTER_CDGH;
+
+        sha256_shani_compress_x2(&ABEFA, &CDGHA, &ABEFB, &CDGHB, WA, WB);
+
+        SHANI_FROM_ABEF_CDGH(ABEFA, CDGHA);
+        SHANI_FROM_ABEF_CDGH(ABEFB, CDGHB);
+
+        UA0 = ABEFA; UA1 = CDGHA;
+        UB0 = ABEFB; UB1 = CDGHB;
+
+        TA0 = _mm_xor_si128(TA0, UA0);
+        TA1 = _mm_xor_si128(TA1, UA1);
+        TB0 = _mm_xor_si128(TB0, UB0);
+        TB1 = _mm_xor_si128(TB1, UB1);
+    }
+
+    _mm_storeu_si128((__m128i*)&u[0][0], TA0);
+    _mm_storeu_si128((__m128i*)&u[0][4], TA1);
+    _mm_storeu_si128((__m128i*)&u[1][0], TB0);
+    _mm_storeu_si128((__m128i*)&u[1][4], TB1);
+
+    // Prevent leaks
+    burn(WA, sizeof(WA));
+    burn(WB, sizeof(WB));
+
+    return 1;
+}
+
+#endif // SHA256_PBKDF2_SHANI_LANES
+
+#endif
 #endif
+
+#if defined(SHA256_PBKDF2_SHANI_LANES) && (defined(NO_OPTIMIZED_VERSIONS) || !CRYPTOPP_SHANI_AVAILABLE)
+int sha256_pbkdf2_shani_x2(const uint_32t innerState[8], const uint_32t outerState[8], uint_32t u[SHA256_PBKDF2_SHANI_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation)
+{
+    return 0; // SHA-NI not available
+}
 #endif
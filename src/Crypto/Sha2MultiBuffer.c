@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2013-2025 AM Crypto
+ * Governed by the Apache License 2.0 the full text of which is contained
+ * in the file License.txt included in VeraCrypt binary and source
+ * code distribution packages.
+ */
+
+/* Multi-buffer SHA-2 used by PBKDF2: independent HMAC chains are computed in the lanes of AVX2 registers.
+   Each iteration hashes a single block whose padding is fixed, so the compression function is called directly. */
+
+#include "Sha2.h"
+#include "Crypto/config.h"
+#include "Crypto/cpu.h"
+#include "Crypto/misc.h"
+
+#if defined(SHA256_PBKDF2_LANES) && defined(SHA512_PBKDF2_LANES)
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+static const uint_32t K256[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint_64t K512[80] = {
+	LL(0x428a2f98d728ae22), LL(0x7137449123ef65cd), LL(0xb5c0fbcfec4d3b2f), LL(0xe9b5dba58189dbbc),
+	LL(0x3956c25bf348b538), LL(0x59f111f1b605d019), LL(0x923f82a4af194f9b), LL(0xab1c5ed5da6d8118),
+	LL(0xd807aa98a3030242), LL(0x12835b0145706fbe), LL(0x243185be4ee4b28c), LL(0x550c7dc3d5ffb4e2),
+	LL(0x72be5d74f27b896f), LL(0x80deb1fe3b1696b1), LL(0x9bdc06a725c71235), LL(0xc19bf174cf692694),
+	LL(0xe49b69c19ef14ad2), LL(0xefbe4786384f25e3), LL(0x0fc19dc68b8cd5b5), LL(0x240ca1cc77ac9c65),
+	LL(0x2de92c6f592b0275), LL(0x4a7484aa6ea6e483), LL(0x5cb0a9dcbd41fbd4), LL(0x76f988da831153b5),
+	LL(0x983e5152ee66dfab), LL(0xa831c66d2db43210), LL(0xb00327c898fb213f), LL(0xbf597fc7beef0ee4),
+	LL(0xc6e00bf33da88fc2), LL(0xd5a79147930aa725), LL(0x06ca6351e003826f), LL(0x142929670a0e6e70),
+	LL(0x27b70a8546d22ffc), LL(0x2e1b21385c26c926), LL(0x4d2c6dfc5ac42aed), LL(0x53380d139d95b3df),
+	LL(0x650a73548baf63de), LL(0x766a0abb3c77b2a8), LL(0x81c2c92e47edaee6), LL(0x92722c851482353b),
+	LL(0xa2bfe8a14cf10364), LL(0xa81a664bbc423001), LL(0xc24b8b70d0f89791), LL(0xc76c51a30654be30),
+	LL(0xd192e819d6ef5218), LL(0xd69906245565a910), LL(0xf40e35855771202a), LL(0x106aa07032bbd1b8),
+	LL(0x19a4c116b8d2d0c8), LL(0x1e376c085141ab53), LL(0x2748774cdf8eeb99), LL(0x34b0bcb5e19b48a8),
+	LL(0x391c0cb3c5c95a63), LL(0x4ed8aa4ae3418acb), LL(0x5b9cca4f7763e373), LL(0x682e6ff3d6b2b8a3),
+	LL(0x748f82ee5defb2fc), LL(0x78a5636f43172f60), LL(0x84c87814a1f0ab72), LL(0x8cc702081a6439ec),
+	LL(0x90befffa23631e28), LL(0xa4506cebde82bde9), LL(0xbef9a3f7b2c67915), LL(0xc67178f2e372532b),
+	LL(0xca273eceea26619c), LL(0xd186b8c721c0c207), LL(0xeada7dd6cde0eb1e), LL(0xf57d4f7fee6ed178),
+	LL(0x06f067aa72176fba), LL(0x0a637dc5a2c898a6), LL(0x113f9804bef90dae), LL(0x1b710b35131c471b),
+	LL(0x28db77f523047d84), LL(0x32caab7b40c72493), LL(0x3c9ebe0a15c9bebc), LL(0x431d67c49c100d4c),
+	LL(0x4cc5d4becb3e42b6), LL(0x597f299cfc657e2a), LL(0x5fcb6fab3ad6faec), LL(0x6c44198c4a475817)
+};
+
+#define XOR256(a,b)		_mm256_xor_si256 ((a), (b))
+#define CH256(x,y,z)	XOR256 ((z), _mm256_and_si256 ((x), XOR256 ((y), (z))))
+#define MAJ256(x,y,z)	_mm256_or_si256 (_mm256_and_si256 ((x), (y)), _mm256_and_si256 ((z), _mm256_or_si256 ((x), (y))))
+
+#define ADD64(a,b)		_mm256_add_epi64 ((a), (b))
+#define ROTR64(x,n)		_mm256_or_si256 (_mm256_srli_epi64 ((x), (n)), _mm256_slli_epi64 ((x), 64 - (n)))
+
+#define SUM0_64(x)		XOR256 (XOR256 (ROTR64 ((x), 28), ROTR64 ((x), 34)), ROTR64 ((x), 39))
+#define SUM1_64(x)		XOR256 (XOR256 (ROTR64 ((x), 14), ROTR64 ((x), 18)), ROTR64 ((x), 41))
+#define SIGMA0_64(x)	XOR256 (XOR256 (ROTR64 ((x), 1), ROTR64 ((x), 8)), _mm256_srli_epi64 ((x), 7))
+#define SIGMA1_64(x)	XOR256 (XOR256 (ROTR64 ((x), 19), ROTR64 ((x), 61)), _mm256_srli_epi64 ((x), 6))
+
+#define ROUND64(a,b,c,d,e,f,g,h,i) \
+	{ \
+		__m256i t1, t2; \
+		if (i >= 16) \
+			W[(i) & 15] = ADD64 (ADD64 (W[(i) & 15], SIGMA1_64 (W[((i) + 14) & 15])), ADD64 (W[((i) + 9) & 15], SIGMA0_64 (W[((i) + 1) & 15]))); \
+		t1 = ADD64 (ADD64 (ADD64 (h, SUM1_64 (e)), ADD64 (CH256 (e, f, g), _mm256_set1_epi64x (K512[i]))), W[(i) & 15]); \
+		t2 = ADD64 (SUM0_64 (a), MAJ256 (a, b, c)); \
+		d = ADD64 (d, t1); \
+		h = ADD64 (t1, t2); \
+	}
+
+/* Compresses one block of each lane. W holds the message words and is overwritten. */
+VC_INLINE void sha512_compress_x4 (__m256i S[8], __m256i W[16])
+{
+	__m256i a = S[0], b = S[1], c = S[2], d = S[3], e = S[4], f = S[5], g = S[6], h = S[7];
+	int i;
+
+	for (i = 0; i < 80; i += 8)
+	{
+		ROUND64 (a, b, c, d, e, f, g, h, i + 0);
+		ROUND64 (h, a, b, c, d, e, f, g, i + 1);
+		ROUND64 (g, h, a, b, c, d, e, f, i + 2);
+		ROUND64 (f, g, h, a, b, c, d, e, i + 3);
+		ROUND64 (e, f, g, h, a, b, c, d, i + 4);
+		ROUND64 (d, e, f, g, h, a, b, c, i + 5);
+		ROUND64 (c, d, e, f, g, h, a, b, i + 6);
+		ROUND64 (b, c, d, e, f, g, h, a, i + 7);
+	}
+
+	S[0] = ADD64 (S[0], a);
+	S[1] = ADD64 (S[1], b);
+	S[2] = ADD64 (S[2], c);
+	S[3] = ADD64 (S[3], d);
+	S[4] = ADD64 (S[4], e);
+	S[5] = ADD64 (S[5], f);
+	S[6] = ADD64 (S[6], g);
+	S[7] = ADD64 (S[7], h);
+}
+
+int sha512_pbkdf2_x4 (const uint_64t innerState[8], const uint_64t outerState[8], uint_64t u[SHA512_PBKDF2_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation)
+{
+	CRYPTOPP_ALIGN_DATA(32) __m256i U[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i T[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i S[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i W[16];
+	uint_32t c;
+	int i;
+
+	for (i = 0; i < 8; i++)
+	{
+		U[i] = _mm256_set_epi64x ((long long) u[3][i], (long long) u[2][i], (long long) u[1][i], (long long) u[0][i]);
+		T[i] = U[i];
+	}
+
+	for (c = 1; c < iterations; c++)
+	{
+		// CANCELLATION CHECK: Check every 1024 iterations
+		if (pAbortKeyDerivation && (c & 1023) == 0 && *pAbortKeyDerivation == 1)
+			break;
+
+		/* Inner hash of the previous U: a 64-byte message following the 128-byte key block */
+		for (i = 0; i < 8; i++)
+		{
+			S[i] = _mm256_set1_epi64x ((long long) innerState[i]);
+			W[i] = U[i];
+		}
+
+		W[8] = _mm256_set1_epi64x ((long long) LL(0x8000000000000000));
+		for (i = 9; i < 15; i++)
+			W[i] = _mm256_setzero_si256 ();
+		W[15] = _mm256_set1_epi64x ((SHA512_BLOCK_SIZE + SHA512_DIGEST_SIZE) * 8);
+
+		sha512_compress_x4 (S, W);
+
+		/* Outer hash of the inner digest */
+		for (i = 0; i < 8; i++)
+		{
+			W[i] = S[i];
+			S[i] = _mm256_set1_epi64x ((long long) outerState[i]);
+		}
+
+		W[8] = _mm256_set1_epi64x ((long long) LL(0x8000000000000000));
+		for (i = 9; i < 15; i++)
+			W[i] = _mm256_setzero_si256 ();
+		W[15] = _mm256_set1_epi64x ((SHA512_BLOCK_SIZE + SHA512_DIGEST_SIZE) * 8);
+
+		sha512_compress_x4 (S, W);
+
+		for (i = 0; i < 8; i++)
+		{
+			U[i] = S[i];
+			T[i] = XOR256 (T[i], U[i]);
+		}
+	}
+
+	for (i = 0; i < 8; i++)
+	{
+		CRYPTOPP_ALIGN_DATA(32) uint_64t lanes[4];
+		_mm256_store_si256 ((__m256i *) lanes, T[i]);
+
+		u[0][i] = lanes[0];
+		u[1][i] = lanes[1];
+		u[2][i] = lanes[2];
+		u[3][i] = lanes[3];
+
+		burn (lanes, sizeof (lanes));
+	}
+
+	/* Prevent leaks */
+	burn (U, sizeof (U));
+	burn (T, sizeof (T));
+	burn (S, sizeof (S));
+	burn (W, sizeof (W));
+
+	return 1;
+}
+
+
+#define ADD32(a,b)		_mm256_add_epi32 ((a), (b))
+#define ROTR32(x,n)		_mm256_or_si256 (_mm256_srli_epi32 ((x), (n)), _mm256_slli_epi32 ((x), 32 - (n)))
+
+#define SUM0_32(x)		XOR256 (XOR256 (ROTR32 ((x), 2), ROTR32 ((x), 13)), ROTR32 ((x), 22))
+#define SUM1_32(x)		XOR256 (XOR256 (ROTR32 ((x), 6), ROTR32 ((x), 11)), ROTR32 ((x), 25))
+#define SIGMA0_32(x)	XOR256 (XOR256 (ROTR32 ((x), 7), ROTR32 ((x), 18)), _mm256_srli_epi32 ((x), 3))
+#define SIGMA1_32(x)	XOR256 (XOR256 (ROTR32 ((x), 17), ROTR32 ((x), 19)), _mm256_srli_epi32 ((x), 10))
+
+#define ROUND32(a,b,c,d,e,f,g,h,i) \
+	{ \
+		__m256i t1, t2; \
+		if (i >= 16) \
+			W[(i) & 15] = ADD32 (ADD32 (W[(i) & 15], SIGMA1_32 (W[((i) + 14) & 15])), ADD32 (W[((i) + 9) & 15], SIGMA0_32 (W[((i) + 1) & 15]))); \
+		t1 = ADD32 (ADD32 (ADD32 (h, SUM1_32 (e)), ADD32 (CH256 (e, f, g), _mm256_set1_epi32 ((int) K256[i]))), W[(i) & 15]); \
+		t2 = ADD32 (SUM0_32 (a), MAJ256 (a, b, c)); \
+		d = ADD32 (d, t1); \
+		h = ADD32 (t1, t2); \
+	}
+
+/* Compresses one block of each lane. W holds the message words and is overwritten. */
+VC_INLINE void sha256_compress_x8 (__m256i S[8], __m256i W[16])
+{
+	__m256i a = S[0], b = S[1], c = S[2], d = S[3], e = S[4], f = S[5], g = S[6], h = S[7];
+	int i;
+
+	for (i = 0; i < 64; i += 8)
+	{
+		ROUND32 (a, b, c, d, e, f, g, h, i + 0);
+		ROUND32 (h, a, b, c, d, e, f, g, i + 1);
+		ROUND32 (g, h, a, b, c, d, e, f, i + 2);
+		ROUND32 (f, g, h, a, b, c, d, e, i + 3);
+		ROUND32 (e, f, g, h, a, b, c, d, i + 4);
+		ROUND32 (d, e, f, g, h, a, b, c, i + 5);
+		ROUND32 (c, d, e, f, g, h, a, b, i + 6);
+		ROUND32 (b, c, d, e, f, g, h, a, i + 7);
+	}
+
+	S[0] = ADD32 (S[0], a);
+	S[1] = ADD32 (S[1], b);
+	S[2] = ADD32 (S[2], c);
+	S[3] = ADD32 (S[3], d);
+	S[4] = ADD32 (S[4], e);
+	S[5] = ADD32 (S[5], f);
+	S[6] = ADD32 (S[6], g);
+	S[7] = ADD32 (S[7], h);
+}
+
+int sha256_pbkdf2_x8 (const uint_32t innerState[8], const uint_32t outerState[8], uint_32t u[SHA256_PBKDF2_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation)
+{
+	CRYPTOPP_ALIGN_DATA(32) __m256i U[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i T[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i S[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i W[16];
+	uint_32t c;
+	int i, lane;
+
+	for (i = 0; i < 8; i++)
+	{
+		U[i] = _mm256_set_epi32 ((int) u[7][i], (int) u[6][i], (int) u[5][i], (int) u[4][i], (int) u[3][i], (int) u[2][i], (int) u[1][i], (int) u[0][i]);
+		T[i] = U[i];
+	}
+
+	for (c = 1; c < iterations; c++)
+	{
+		// CANCELLATION CHECK: Check every 1024 iterations
+		if (pAbortKeyDerivation && (c & 1023) == 0 && *pAbortKeyDerivation == 1)
+			break;
+
+		/* Inner hash of the previous U: a 32-byte message following the 64-byte key block */
+		for (i = 0; i < 8; i++)
+		{
+			S[i] = _mm256_set1_epi32 ((int) innerState[i]);
+			W[i] = U[i];
+		}
+
+		W[8] = _mm256_set1_epi32 ((int) 0x80000000);
+		for (i = 9; i < 15; i++)
+			W[i] = _mm256_setzero_si256 ();
+		W[15] = _mm256_set1_epi32 ((SHA256_BLOCK_SIZE + SHA256_DIGEST_SIZE) * 8);
+
+		sha256_compress_x8 (S, W);
+
+		/* Outer hash of the inner digest */
+		for (i = 0; i < 8; i++)
+		{
+			W[i] = S[i];
+			S[i] = _mm256_set1_epi32 ((int) outerState[i]);
+		}
+
+		W[8] = _mm256_set1_epi32 ((int) 0x80000000);
+		for (i = 9; i < 15; i++)
+			W[i] = _mm256_setzero_si256 ();
+		W[15] = _mm256_set1_epi32 ((SHA256_BLOCK_SIZE + SHA256_DIGEST_SIZE) * 8);
+
+		sha256_compress_x8 (S, W);
+
+		for (i = 0; i < 8; i++)
+		{
+			U[i] = S[i];
+			T[i] = XOR256 (T[i], U[i]);
+		}
+	}
+
+	for (i = 0; i < 8; i++)
+	{
+		CRYPTOPP_ALIGN_DATA(32) uint_32t lanes[8];
+		_mm256_store_si256 ((__m256i *) lanes, T[i]);
+
+		for (lane = 0; lane < SHA256_PBKDF2_LANES; lane++)
+			u[lane][i] = lanes[lane];
+
+		burn (lanes, sizeof (lanes));
+	}
+
+	/* Prevent leaks */
+	burn (U, sizeof (U));
+	burn (T, sizeof (T));
+	burn (S, sizeof (S));
+	burn (W, sizeof (W));
+
+	return 1;
+}
+
+#else
+
+int sha512_pbkdf2_x4 (const uint_64t innerState[8], const uint_64t outerState[8], uint_64t u[SHA512_PBKDF2_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation)
+{
+	(void) innerState;
+	(void) outerState;
+	(void) u;
+	(void) iterations;
+	(void) pAbortKeyDerivation;
+	return 0; /* AVX2 not available */
+}
+
+
+int sha256_pbkdf2_x8 (const uint_32t innerState[8], const uint_32t outerState[8], uint_32t u[SHA256_PBKDF2_LANES][8], uint_32t iterations, long volatile *pAbortKeyDerivation)
+{
+	(void) innerState;
+	(void) outerState;
+	(void) u;
+	(void) iterations;
+	(void) pAbortKeyDerivation;
+	return 0; /* AVX2 not available */
+}
+
+#endif
+
+#endif // SHA256_PBKDF2_LANES && SHA512_PBKDF2_LANES
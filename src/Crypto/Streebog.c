@@ -2214,6 +2214,94 @@ g(unsigned long long *h, const unsigned long long *N, const unsigned char *m)
 	}
 }
 
+/* Round keys of E() for a fixed chaining value h and counter N */
+static void
+keySchedule(unsigned long long K[13][8], const unsigned long long *h, const unsigned long long *N)
+{
+	unsigned int i;
+
+	XLPS(h, N, (K[0]));
+
+	for (i = 0; i < 12; i++)
+		XLPS((K[i]), (C[i]), (K[i + 1]));
+}
+
+/* Same as g() using the round keys precomputed by keySchedule() for chaining value hk. The result is stored in h */
+static void
+gKeyed(unsigned long long *h, const unsigned long long *hk, const unsigned long long K[13][8], const unsigned char *m)
+{
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+#if CRYPTOPP_BOOL_SSE41_INTRINSICS_AVAILABLE
+	if (HasSSE41()) {
+		__m128i xmm0, xmm2, xmm4, xmm6; /* XMMR0-quadruple */
+		__m128i xmm1, xmm3, xmm5, xmm7; /* XMMR1-quadruple */
+		unsigned int i;
+
+		LOAD(m, xmm1, xmm3, xmm5, xmm7);
+
+		for (i = 0; i < 12; i++)
+		{
+			LOAD(K[i], xmm0, xmm2, xmm4, xmm6);
+			XLPS128RSSE4(xmm0, xmm2, xmm4, xmm6, xmm1, xmm3, xmm5, xmm7);
+		}
+
+		LOAD(K[12], xmm0, xmm2, xmm4, xmm6);
+		X128R(xmm0, xmm2, xmm4, xmm6, xmm1, xmm3, xmm5, xmm7);
+
+		X128M(hk, xmm0, xmm2, xmm4, xmm6);
+		X128M(m, xmm0, xmm2, xmm4, xmm6);
+
+		UNLOAD(h, xmm0, xmm2, xmm4, xmm6);
+
+		/* Restore the Floating-point status on the CPU */
+#if CRYPTOPP_BOOL_X86
+		_mm_empty();
+#endif
+	} else
+#endif
+	if (HasSSE2()) {
+		__m128i xmm0, xmm2, xmm4, xmm6; /* XMMR0-quadruple */
+		__m128i xmm1, xmm3, xmm5, xmm7; /* XMMR1-quadruple */
+		unsigned int i;
+
+		LOAD(m, xmm1, xmm3, xmm5, xmm7);
+
+		for (i = 0; i < 12; i++)
+		{
+			LOAD(K[i], xmm0, xmm2, xmm4, xmm6);
+			XLPS128R(xmm0, xmm2, xmm4, xmm6, xmm1, xmm3, xmm5, xmm7);
+		}
+
+		LOAD(K[12], xmm0, xmm2, xmm4, xmm6);
+		X128R(xmm0, xmm2, xmm4, xmm6, xmm1, xmm3, xmm5, xmm7);
+
+		X128M(hk, xmm0, xmm2, xmm4, xmm6);
+		X128M(m, xmm0, xmm2, xmm4, xmm6);
+
+		UNLOAD(h, xmm0, xmm2, xmm4, xmm6);
+
+		/* Restore the Floating-point status on the CPU */
+#if CRYPTOPP_BOOL_X86
+		_mm_empty();
+#endif
+	}	else 
+#endif
+	{
+		STREEBOG_ALIGN(16) unsigned long long data[8];
+		unsigned int i;
+
+		XLPS((K[0]), ((const unsigned long long *) m), (data));
+
+		for (i = 1; i < 12; i++)
+			XLPS((K[i]), (data), (data));
+
+		X((K[12]), (data), (data));
+
+		X((data), hk, (data));
+		X((data), ((const unsigned long long *) m), h);
+	}
+}
+
 static void
 stage2(STREEBOG_CTX *CTX, const unsigned char *data)
 {
@@ -2297,3 +2385,90 @@ void STREEBOG_finalize(STREEBOG_CTX *CTX, uint8 *digest)
 	else
 		memcpy(digest, CTX->hash, 64);
 }
+
+/* HMAC half precomputed from a context holding only the 64-byte padded key */
+typedef struct
+{
+	STREEBOG_ALIGN(16) unsigned long long K[13][8];
+	STREEBOG_ALIGN(16) unsigned long long h[8];
+	STREEBOG_ALIGN(16) unsigned long long N[8];
+	STREEBOG_ALIGN(16) unsigned long long Sigma[8];
+} STREEBOG_HMAC_KEY;
+
+static void
+hmacKeyInit(STREEBOG_HMAC_KEY *key, const STREEBOG_CTX *CTX)
+{
+	memcpy(key->h, CTX->h, sizeof(key->h));
+	memcpy(key->Sigma, CTX->Sigma, sizeof(key->Sigma));
+
+	/* The 64-byte message block is compressed with the counter of the key context */
+	keySchedule(key->K, CTX->h, CTX->N);
+
+	add512(CTX->N, buffer512, key->N);
+}
+
+/* Streebog-512 of the key block followed by the 64-byte message m: same steps as stage2() and stage3() */
+static void
+hmacHash(const STREEBOG_HMAC_KEY *key, const unsigned char *m, unsigned long long *h)
+{
+	STREEBOG_ALIGN(16) unsigned long long Sigma[8];
+	STREEBOG_ALIGN(16) unsigned long long padding[8];
+
+	/* m may alias h */
+	add512(key->Sigma, (const unsigned long long *) m, Sigma);
+	gKeyed(h, key->h, key->K, m);
+
+	/* Empty final block */
+	memset(padding, 0x00, sizeof padding);
+	((unsigned char *) padding)[0] = 0x01;
+
+	g(h, key->N, (const unsigned char *) padding);
+	add512(Sigma, padding, Sigma);
+
+	g(h, buffer0, (const unsigned char *) key->N);
+	g(h, buffer0, (const unsigned char *) Sigma);
+
+	burn(Sigma, sizeof(Sigma));
+}
+
+int STREEBOG_pbkdf2(const STREEBOG_CTX *inner, const STREEBOG_CTX *outer, uint8 *u, uint32 iterations, long volatile *pAbortKeyDerivation)
+{
+	STREEBOG_HMAC_KEY innerKey, outerKey;
+	STREEBOG_ALIGN(16) unsigned long long U[8], T[8];
+	uint32 c;
+	unsigned int i;
+
+	/* Only Streebog-512 contexts holding exactly the padded key block are supported */
+	if (inner->digest_size != 512 || inner->bufsize != 0 || inner->N[0] != buffer512[0]
+		|| outer->digest_size != 512 || outer->bufsize != 0 || outer->N[0] != buffer512[0])
+		return 0;
+
+	hmacKeyInit(&innerKey, inner);
+	hmacKeyInit(&outerKey, outer);
+
+	memcpy(U, u, sizeof(U));
+	memcpy(T, u, sizeof(T));
+
+	for (c = 1; c < iterations; c++)
+	{
+		// CANCELLATION CHECK: Check every 1024 iterations
+		if (pAbortKeyDerivation && (c & 1023) == 0 && *pAbortKeyDerivation)
+			break;
+
+		hmacHash(&innerKey, (const unsigned char *) U, U);
+		hmacHash(&outerKey, (const unsigned char *) U, U);
+
+		for (i = 0; i < 8; i++)
+			T[i] ^= U[i];
+	}
+
+	memcpy(u, T, sizeof(T));
+
+	/* Prevent leaks */
+	burn(&innerKey, sizeof(innerKey));
+	burn(&outerKey, sizeof(outerKey));
+	burn(U, sizeof(U));
+	burn(T, sizeof(T));
+
+	return 1;
+}
@@ -34,6 +34,10 @@ void STREEBOG_init256(STREEBOG_CTX *ctx);
 void STREEBOG_add(STREEBOG_CTX *ctx, const uint8 *msg, size_t len);
 void STREEBOG_finalize(STREEBOG_CTX *ctx, uint8 *out);
 
+/* PBKDF2-HMAC-Streebog iterations. inner and outer are HMAC contexts after the padded key block was passed to STREEBOG_add.
+   u holds U1 on input and the XOR of U1..Uc on output. Returns 0 if the contexts are not supported. */
+int STREEBOG_pbkdf2(const STREEBOG_CTX *inner, const STREEBOG_CTX *outer, uint8 *u, uint32 iterations, long volatile *pAbortKeyDerivation);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,7 @@
 
 #include "Twofish.h"
 #include "Common/Endian.h"
+#include "Crypto/cpu.h"
 
 #ifndef TC_MINIMIZE_CODE_SIZE
 
@@ -71,12 +72,26 @@ void twofish_dec_blk2(TwofishInstance *ks, uint8 *dst, const uint8 *src);
 void twofish_enc_blk3(TwofishInstance *ks, uint8 *dst, const uint8 *src);
 void twofish_dec_blk3(TwofishInstance *ks, uint8 *dst, const uint8 *src);
 
+/* AVX2 versions processing 8 blocks at a time. They return the number of blocks processed, 0 if AVX2 support was not compiled in */
+uint32 twofish_avx2_encrypt_blocks_8 (TwofishInstance *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount);
+uint32 twofish_avx2_decrypt_blocks_8 (TwofishInstance *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount);
+
 #if defined(__cplusplus)
 }
 #endif
 
 void twofish_encrypt_blocks(TwofishInstance *instance, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
 {
+#if !defined (TC_WINDOWS_DRIVER)
+	if (HasSAVX2 () && blockCount >= 8)
+	{
+		uint32 processed = twofish_avx2_encrypt_blocks_8 (instance, in_blk, out_blk, blockCount);
+		out_blk += processed * 16;
+		in_blk += processed * 16;
+		blockCount -= processed;
+	}
+#endif
+
 	while (blockCount >= 3)
 	{
 		twofish_enc_blk3 (instance, out_blk, in_blk);
@@ -89,7 +104,7 @@ void twofish_encrypt_blocks(TwofishInstance *instance, const uint8* in_blk, uint
 	{
 		twofish_enc_blk2 (instance, out_blk, in_blk);
 	}
-	else
+	else if (blockCount == 1)
 	{
 		twofish_enc_blk (instance, out_blk, in_blk);
 	}
@@ -98,6 +113,16 @@ void twofish_encrypt_blocks(TwofishInstance *instance, const uint8* in_blk, uint
 
 void twofish_decrypt_blocks(TwofishInstance *instance, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
 {
+#if !defined (TC_WINDOWS_DRIVER)
+	if (HasSAVX2 () && blockCount >= 8)
+	{
+		uint32 processed = twofish_avx2_decrypt_blocks_8 (instance, in_blk, out_blk, blockCount);
+		out_blk += processed * 16;
+		in_blk += processed * 16;
+		blockCount -= processed;
+	}
+#endif
+
 	while (blockCount >= 3)
 	{
 		twofish_dec_blk3 (instance, out_blk, in_blk);
@@ -110,7 +135,7 @@ void twofish_decrypt_blocks(TwofishInstance *instance, const uint8* in_blk, uint
 	{
 		twofish_dec_blk2 (instance, out_blk, in_blk);
 	}
-	else
+	else if (blockCount == 1)
 	{
 		twofish_dec_blk (instance, out_blk, in_blk);
 	}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2013-2025 AM Crypto
+ * Governed by the Apache License 2.0 the full text of which is contained
+ * in the file License.txt included in VeraCrypt binary and source
+ * code distribution packages.
+ */
+
+/* Twofish processing 8 blocks in parallel: each 32-bit lane of the AVX2 registers holds one word of a block
+   and the key-dependent S-box lookups are done with gathers from the mk_tab tables of the key schedule. */
+
+#include "Twofish.h"
+#include "Crypto/config.h"
+#include "Crypto/cpu.h"
+
+#if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM)
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#define XOR256(a,b)		_mm256_xor_si256 ((a), (b))
+#define ADD32(a,b)		_mm256_add_epi32 ((a), (b))
+#define ROTL32(x,n)		_mm256_or_si256 (_mm256_slli_epi32 ((x), (n)), _mm256_srli_epi32 ((x), 32 - (n)))
+#define ROTR32(x,n)		ROTL32 ((x), 32 - (n))
+
+#define BYTE0(x)		_mm256_and_si256 ((x), mask)
+#define BYTE1(x)		_mm256_and_si256 (_mm256_srli_epi32 ((x), 8), mask)
+#define BYTE2(x)		_mm256_and_si256 (_mm256_srli_epi32 ((x), 16), mask)
+#define BYTE3(x)		_mm256_srli_epi32 ((x), 24)
+
+#define GATHER(t,i)		_mm256_i32gather_epi32 ((const int *) ks->mk_tab[t], (i), 4)
+
+#define ROUNDT(x0, x1, r) \
+	f0 = XOR256 (XOR256 (GATHER (0, BYTE0 (x0)), GATHER (1, BYTE1 (x0))), XOR256 (GATHER (2, BYTE2 (x0)), GATHER (3, BYTE3 (x0)))); \
+	f1 = XOR256 (XOR256 (GATHER (0, BYTE3 (x1)), GATHER (1, BYTE0 (x1))), XOR256 (GATHER (2, BYTE1 (x1)), GATHER (3, BYTE2 (x1)))); \
+	f0 = ADD32 (f0, f1); \
+	f1 = ADD32 (f1, ADD32 (f0, _mm256_set1_epi32 ((int) ks->k[2 * (r) + 1]))); \
+	f0 = ADD32 (f0, _mm256_set1_epi32 ((int) ks->k[2 * (r)]));
+
+#define ROUNDA(r) \
+	ROUNDT (x0, x1, r) \
+	x2 = ROTR32 (XOR256 (x2, f0), 1); \
+	x3 = XOR256 (ROTL32 (x3, 1), f1);
+
+#define ROUNDB(r) \
+	ROUNDT (x2, x3, r) \
+	x0 = ROTR32 (XOR256 (x0, f0), 1); \
+	x1 = XOR256 (ROTL32 (x1, 1), f1);
+
+#define RROUNDA(r) \
+	ROUNDT (x0, x1, r) \
+	x2 = XOR256 (ROTL32 (x2, 1), f0); \
+	x3 = ROTR32 (XOR256 (x3, f1), 1);
+
+#define RROUNDB(r) \
+	ROUNDT (x2, x3, r) \
+	x0 = XOR256 (ROTL32 (x0, 1), f0); \
+	x1 = ROTR32 (XOR256 (x1, f1), 1);
+
+/* Converts 4 registers of 2 blocks each into 4 registers holding the same word of the 8 blocks, and back.
+   This is a 4x4 transpose of each 128-bit half, so the lanes hold blocks 0, 2, 4, 6, 1, 3, 5, 7 and the same macro restores the layout. */
+#define TRANSPOSE(a, b, c, d) \
+	{ \
+		__m256i t0 = _mm256_unpacklo_epi32 (a, b); \
+		__m256i t1 = _mm256_unpacklo_epi32 (c, d); \
+		__m256i t2 = _mm256_unpackhi_epi32 (a, b); \
+		__m256i t3 = _mm256_unpackhi_epi32 (c, d); \
+		a = _mm256_unpacklo_epi64 (t0, t1); \
+		b = _mm256_unpackhi_epi64 (t0, t1); \
+		c = _mm256_unpacklo_epi64 (t2, t3); \
+		d = _mm256_unpackhi_epi64 (t2, t3); \
+	}
+
+#define LOAD8(in, x0, x1, x2, x3) \
+	x0 = _mm256_loadu_si256 ((const __m256i *) (in)); \
+	x1 = _mm256_loadu_si256 ((const __m256i *) ((in) + 32)); \
+	x2 = _mm256_loadu_si256 ((const __m256i *) ((in) + 64)); \
+	x3 = _mm256_loadu_si256 ((const __m256i *) ((in) + 96)); \
+	TRANSPOSE (x0, x1, x2, x3)
+
+#define STORE8(out, x0, x1, x2, x3) \
+	TRANSPOSE (x0, x1, x2, x3) \
+	_mm256_storeu_si256 ((__m256i *) (out), x0); \
+	_mm256_storeu_si256 ((__m256i *) ((out) + 32), x1); \
+	_mm256_storeu_si256 ((__m256i *) ((out) + 64), x2); \
+	_mm256_storeu_si256 ((__m256i *) ((out) + 96), x3);
+
+uint32 twofish_avx2_encrypt_blocks_8 (TwofishInstance *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount)
+{
+	const __m256i mask = _mm256_set1_epi32 (0xFF);
+	__m256i x0, x1, x2, x3, f0, f1;
+	uint32 processed = 0;
+
+	while (blockCount - processed >= 8)
+	{
+		LOAD8 (in_blk, x0, x1, x2, x3);
+
+		x0 = XOR256 (x0, _mm256_set1_epi32 ((int) ks->w[0]));
+		x1 = XOR256 (x1, _mm256_set1_epi32 ((int) ks->w[1]));
+		x2 = XOR256 (x2, _mm256_set1_epi32 ((int) ks->w[2]));
+		x3 = XOR256 (x3, _mm256_set1_epi32 ((int) ks->w[3]));
+
+		ROUNDA (0); ROUNDB (1); ROUNDA (2); ROUNDB (3); ROUNDA (4); ROUNDB (5); ROUNDA (6); ROUNDB (7);
+		ROUNDA (8); ROUNDB (9); ROUNDA (10); ROUNDB (11); ROUNDA (12); ROUNDB (13); ROUNDA (14); ROUNDB (15);
+
+		f0 = XOR256 (x2, _mm256_set1_epi32 ((int) ks->w[4]));
+		f1 = XOR256 (x3, _mm256_set1_epi32 ((int) ks->w[5]));
+		x2 = XOR256 (x0, _mm256_set1_epi32 ((int) ks->w[6]));
+		x3 = XOR256 (x1, _mm256_set1_epi32 ((int) ks->w[7]));
+
+		STORE8 (out_blk, f0, f1, x2, x3);
+
+		in_blk += 8 * 16;
+		out_blk += 8 * 16;
+		processed += 8;
+	}
+
+	return processed;
+}
+
+uint32 twofish_avx2_decrypt_blocks_8 (TwofishInstance *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount)
+{
+	const __m256i mask = _mm256_set1_epi32 (0xFF);
+	__m256i x0, x1, x2, x3, f0, f1;
+	uint32 processed = 0;
+
+	while (blockCount - processed >= 8)
+	{
+		LOAD8 (in_blk, x0, x1, x2, x3);
+
+		x0 = XOR256 (x0, _mm256_set1_epi32 ((int) ks->w[4]));
+		x1 = XOR256 (x1, _mm256_set1_epi32 ((int) ks->w[5]));
+		x2 = XOR256 (x2, _mm256_set1_epi32 ((int) ks->w[6]));
+		x3 = XOR256 (x3, _mm256_set1_epi32 ((int) ks->w[7]));
+
+		RROUNDA (15); RROUNDB (14); RROUNDA (13); RROUNDB (12); RROUNDA (11); RROUNDB (10); RROUNDA (9); RROUNDB (8);
+		RROUNDA (7); RROUNDB (6); RROUNDA (5); RROUNDB (4); RROUNDA (3); RROUNDB (2); RROUNDA (1); RROUNDB (0);
+
+		f0 = XOR256 (x2, _mm256_set1_epi32 ((int) ks->w[0]));
+		f1 = XOR256 (x3, _mm256_set1_epi32 ((int) ks->w[1]));
+		x2 = XOR256 (x0, _mm256_set1_epi32 ((int) ks->w[2]));
+		x3 = XOR256 (x1, _mm256_set1_epi32 ((int) ks->w[3]));
+
+		STORE8 (out_blk, f0, f1, x2, x3);
+
+		in_blk += 8 * 16;
+		out_blk += 8 * 16;
+		processed += 8;
+	}
+
+	return processed;
+}
+
+#else
+
+uint32 twofish_avx2_encrypt_blocks_8 (TwofishInstance *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount)
+{
+	(void) ks;
+	(void) in_blk;
+	(void) out_blk;
+	(void) blockCount;
+	return 0; /* AVX2 not available */
+}
+
+uint32 twofish_avx2_decrypt_blocks_8 (TwofishInstance *ks, const uint8 *in_blk, uint8 *out_blk, uint32 blockCount)
+{
+	(void) ks;
+	(void) in_blk;
+	(void) out_blk;
+	(void) blockCount;
+	return 0; /* AVX2 not available */
+}
+
+#endif
+
+#endif // CRYPTOPP_BOOL_X64 && !CRYPTOPP_DISABLE_ASM
@@ -1103,3 +1103,180 @@ void WHIRLPOOL_finalize(WHIRLPOOL_CTX * const ctx,
 #endif
 	memcpy(result, stateBuf, 64);
 }
+
+/*
+ * Row i of one round of the dedicated block cipher applied to the
+ * native 64-bit words of s. The bytes are extracted by shifting so that
+ * the same code serves both byte orders.
+ */
+#define WHIRLPOOL_ROW(s, i) \
+	(Whirlpool_C[0*256 + (uint8) (s[i] >> 56)] ^ \
+	 Whirlpool_C[1*256 + (uint8) (s[((i) - 1) & 7] >> 48)] ^ \
+	 Whirlpool_C[2*256 + (uint8) (s[((i) - 2) & 7] >> 40)] ^ \
+	 Whirlpool_C[3*256 + (uint8) (s[((i) - 3) & 7] >> 32)] ^ \
+	 Whirlpool_C[4*256 + (uint8) (s[((i) - 4) & 7] >> 24)] ^ \
+	 Whirlpool_C[5*256 + (uint8) (s[((i) - 5) & 7] >> 16)] ^ \
+	 Whirlpool_C[6*256 + (uint8) (s[((i) - 6) & 7] >> 8)] ^ \
+	 Whirlpool_C[7*256 + (uint8) (s[((i) - 7) & 7])])
+
+/*
+ * Round keys derived from a chaining value, as computed at the start of
+ * WhirlpoolTransform.
+ */
+static void WhirlpoolKeySchedule(uint64 K[R + 1][8], const uint64 *digest)
+{
+	int r, i;
+
+	memcpy(K[0], digest, sizeof(K[0]));
+
+	for (r = 0; r < R; r++)
+	{
+		for (i = 0; i < 8; i++)
+			K[r + 1][i] = WHIRLPOOL_ROW(K[r], i);
+		K[r + 1][0] ^= Whirlpool_C[2048 + r];
+	}
+}
+
+/*
+ * Same as WhirlpoolTransform for the chaining value digest whose round keys
+ * were precomputed by WhirlpoolKeySchedule. The result is stored in out,
+ * which may alias block.
+ */
+static void WhirlpoolTransformKeyed(uint64 *out, const uint64 K[R + 1][8], const uint64 *digest, const uint64 *block)
+{
+	uint64 s[8], L[8];
+	int r, i;
+
+	for (i = 0; i < 8; i++)
+		s[i] = K[0][i] ^ block[i];
+
+	for (r = 0; r < R; r++)
+	{
+		for (i = 0; i < 8; i++)
+			L[i] = WHIRLPOOL_ROW(s, i) ^ K[r + 1][i];
+
+		memcpy(s, L, sizeof(L));
+	}
+
+	for (i = 0; i < 8; i++)
+		out[i] = digest[i] ^ s[i] ^ block[i];
+}
+
+/*
+ * Same as WhirlpoolTransformKeyed for two blocks and the chaining value
+ * digest whose round keys were precomputed by WhirlpoolKeySchedule.
+ * The two blocks are processed together to overlap their table lookups.
+ * The results are stored in out0 and out1, which may alias block0 and block1.
+ */
+static void WhirlpoolTransformKeyedX2(uint64 *out0, uint64 *out1, const uint64 K[R + 1][8], const uint64 *digest, const uint64 *block0, const uint64 *block1)
+{
+	uint64 s0[8], s1[8], L0[8], L1[8];
+	int r, i;
+
+	for (i = 0; i < 8; i++)
+	{
+		s0[i] = K[0][i] ^ block0[i];
+		s1[i] = K[0][i] ^ block1[i];
+	}
+
+	for (r = 0; r < R; r++)
+	{
+		for (i = 0; i < 8; i++)
+		{
+			L0[i] = WHIRLPOOL_ROW(s0, i) ^ K[r + 1][i];
+			L1[i] = WHIRLPOOL_ROW(s1, i) ^ K[r + 1][i];
+		}
+
+		memcpy(s0, L0, sizeof(L0));
+		memcpy(s1, L1, sizeof(L1));
+	}
+
+	for (i = 0; i < 8; i++)
+	{
+		out0[i] = digest[i] ^ s0[i] ^ block0[i];
+		out1[i] = digest[i] ^ s1[i] ^ block1[i];
+	}
+}
+
+/*
+ * Final block of a message made of the 64-byte HMAC key block and a 64-byte
+ * digest: padding bit and bit length 1024, as produced by WHIRLPOOL_finalize.
+ */
+CRYPTOPP_ALIGN_DATA(16) static const uint64 WhirlpoolHmacFinalBlock[8] = {
+	0x8000000000000000ULL, 0, 0, 0, 0, 0, 0, 1024
+};
+
+/*
+ * One HMAC half: hashes the 64-byte digest of each lane, held as native
+ * words in U, after the key block whose state is digest.
+ */
+static void WhirlpoolHmacHash(uint64 U[WHIRLPOOL_PBKDF2_LANES][8], int lanes, const uint64 K[R + 1][8], const uint64 *digest)
+{
+	int lane;
+
+	if (lanes == 2)
+		WhirlpoolTransformKeyedX2(U[0], U[1], K, digest, U[0], U[1]);
+	else
+		WhirlpoolTransformKeyed(U[0], K, digest, U[0]);
+
+	for (lane = 0; lane < lanes; lane++)
+		WhirlpoolTransform(U[lane], WhirlpoolHmacFinalBlock);
+}
+
+int WHIRLPOOL_pbkdf2(const WHIRLPOOL_CTX * const inner, const WHIRLPOOL_CTX * const outer, unsigned char u[WHIRLPOOL_PBKDF2_LANES][64], int lanes, uint32 iterations, long volatile *pAbortKeyDerivation)
+{
+	uint64 innerK[R + 1][8], outerK[R + 1][8];
+	CRYPTOPP_ALIGN_DATA(16) uint64 U[WHIRLPOOL_PBKDF2_LANES][8];
+	uint64 T[WHIRLPOOL_PBKDF2_LANES][8];
+	uint32 c;
+	int lane, i;
+
+	/* Only contexts holding exactly the padded key block are supported */
+	if (lanes < 1 || lanes > WHIRLPOOL_PBKDF2_LANES
+		|| inner->countLo != 64 || inner->countHi || outer->countLo != 64 || outer->countHi)
+		return 0;
+
+	WhirlpoolKeySchedule(innerK, inner->state);
+	WhirlpoolKeySchedule(outerK, outer->state);
+
+	for (lane = 0; lane < lanes; lane++)
+	{
+		memcpy(U[lane], u[lane], sizeof(U[lane]));
+#if BYTE_ORDER == LITTLE_ENDIAN
+		CorrectEndianness(U[lane], U[lane], 64);
+#endif
+		memcpy(T[lane], U[lane], sizeof(T[lane]));
+	}
+
+	for (c = 1; c < iterations; c++)
+	{
+		// CANCELLATION CHECK: Check every 1024 iterations
+		if (pAbortKeyDerivation && (c & 1023) == 0 && *pAbortKeyDerivation)
+			break;
+
+		WhirlpoolHmacHash(U, lanes, innerK, inner->state);
+		WhirlpoolHmacHash(U, lanes, outerK, outer->state);
+
+		for (lane = 0; lane < lanes; lane++)
+		{
+			for (i = 0; i < 8; i++)
+				T[lane][i] ^= U[lane][i];
+		}
+	}
+
+	for (lane = 0; lane < lanes; lane++)
+	{
+#if BYTE_ORDER == LITTLE_ENDIAN
+		CorrectEndianness(T[lane], T[lane], 64);
+#endif
+		memcpy(u[lane], T[lane], sizeof(T[lane]));
+	}
+
+	/* Prevent leaks */
+	burn(innerK, sizeof(innerK));
+	burn(outerK, sizeof(outerK));
+	burn(U, sizeof(U));
+	burn(T, sizeof(T));
+
+	return 1;
+}
@@ -20,6 +20,14 @@ void WHIRLPOOL_add(const unsigned char * source, unsigned __int32 sourceBytes, W
 void WHIRLPOOL_finalize(WHIRLPOOL_CTX* const ctx, unsigned char * result);
 void WHIRLPOOL_init(WHIRLPOOL_CTX* const ctx);
 
+/* Maximum number of PBKDF2-HMAC-Whirlpool blocks computed together by WHIRLPOOL_pbkdf2 */
+#define WHIRLPOOL_PBKDF2_LANES 2
+
+/* inner and outer are HMAC contexts after the padded key block was passed to WHIRLPOOL_add.
+   u holds U1 of each of the first lanes blocks on input and the XOR of U1..Uc on output.
+   Returns 0 if the contexts are not supported. */
+int WHIRLPOOL_pbkdf2(const WHIRLPOOL_CTX * const inner, const WHIRLPOOL_CTX * const outer, unsigned char u[WHIRLPOOL_PBKDF2_LANES][64], int lanes, uint32 iterations, long volatile *pAbortKeyDerivation);
+
 #if defined(__cplusplus)
 }
 #endif
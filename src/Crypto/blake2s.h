@@ -18,6 +18,9 @@
 #ifndef BLAKE2_H
 #define BLAKE2_H
 #include "Common/Tcdefs.h"
+#if !defined(TC_WINDOWS_BOOT) && !defined(_UEFI)
+#include "Crypto/config.h"
+#endif
 
 #if defined(_MSC_VER)
 #ifdef TC_WINDOWS_BOOT
@@ -95,6 +98,16 @@ extern "C" {
   /* Simple API */
   int blake2s( void *out, const void *in, size_t inlen );
 
+#if !defined(TC_WINDOWS_BOOT) && !defined(_UEFI) && !defined(TC_WINDOWS_DRIVER) && !defined(CRYPTOPP_DISABLE_ASM) && (CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32)
+  /* PBKDF2-HMAC-BLAKE2s blocks computed in parallel by blake2s_pbkdf2_x8 (AVX2) */
+  #define BLAKE2S_PBKDF2_LANES 8
+
+  /* inner and outer are HMAC contexts after the padded key block was passed to blake2s_update.
+     u holds U1 of each lane on input and the XOR of U1..Uc on output.
+     Returns 0 if the AVX2 implementation was not compiled in or the contexts are not supported. */
+  int blake2s_pbkdf2_x8( const blake2s_state *inner, const blake2s_state *outer, uint32 u[BLAKE2S_PBKDF2_LANES][8], uint32 iterations, long volatile *pAbortKeyDerivation );
+#endif
+
 #if defined(__cplusplus)
 }
 #endif
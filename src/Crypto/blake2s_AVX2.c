@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2013-2025 AM Crypto
+ * Governed by the Apache License 2.0 the full text of which is contained
+ * in the file License.txt included in VeraCrypt binary and source
+ * code distribution packages.
+ */
+
+/* Multi-buffer BLAKE2s used by PBKDF2: independent HMAC chains are computed in the 32-bit lanes of AVX2 registers.
+   The state words are transposed so that each G function operates on all lanes at once. */
+
+#include "blake2s.h"
+#include "Common/Endian.h"
+#include "Crypto/config.h"
+#include "Crypto/cpu.h"
+#include "Crypto/misc.h"
+
+#ifdef BLAKE2S_PBKDF2_LANES
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+extern const uint32 blake2s_IV[8];
+
+static const uint8 blake2s_avx2_sigma[10][16] =
+{
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 } ,
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 } ,
+  { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 } ,
+  {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 } ,
+  {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 } ,
+  {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 } ,
+  { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 } ,
+  { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 } ,
+  {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 } ,
+  { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13 , 0 } ,
+};
+
+#define ADD32(a,b)		_mm256_add_epi32 ((a), (b))
+#define XOR256(a,b)		_mm256_xor_si256 ((a), (b))
+#define ROTR32(x,n)		_mm256_or_si256 (_mm256_srli_epi32 ((x), (n)), _mm256_slli_epi32 ((x), 32 - (n)))
+
+/* Rotations by 16 and 8 are byte shuffles */
+#define ROTR32_16(x)	_mm256_shuffle_epi8 ((x), r16)
+#define ROTR32_8(x)		_mm256_shuffle_epi8 ((x), r8)
+
+#define G(r,i,a,b,c,d) \
+	{ \
+		a = ADD32 (ADD32 (a, b), m[blake2s_avx2_sigma[r][2*i+0]]); \
+		d = ROTR32_16 (XOR256 (d, a)); \
+		c = ADD32 (c, d); \
+		b = ROTR32 (XOR256 (b, c), 12); \
+		a = ADD32 (ADD32 (a, b), m[blake2s_avx2_sigma[r][2*i+1]]); \
+		d = ROTR32_8 (XOR256 (d, a)); \
+		c = ADD32 (c, d); \
+		b = ROTR32 (XOR256 (b, c), 7); \
+	}
+
+#define ROUND(r) \
+	{ \
+		G (r, 0, v0, v4, v8, v12); \
+		G (r, 1, v1, v5, v9, v13); \
+		G (r, 2, v2, v6, v10, v14); \
+		G (r, 3, v3, v7, v11, v15); \
+		G (r, 4, v0, v5, v10, v15); \
+		G (r, 5, v1, v6, v11, v12); \
+		G (r, 6, v2, v7, v8, v13); \
+		G (r, 7, v3, v4, v9, v14); \
+	}
+
+/* Compresses one block of each lane. t is the byte counter including the block and f0 the last block flag. */
+VC_INLINE void blake2s_compress_x8 (__m256i h[8], const __m256i m[16], uint32 t, uint32 f0)
+{
+	const __m256i r16 = _mm256_setr_epi8 (2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+	const __m256i r8 = _mm256_setr_epi8 (1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12, 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+	__m256i v0 = h[0], v1 = h[1], v2 = h[2], v3 = h[3], v4 = h[4], v5 = h[5], v6 = h[6], v7 = h[7];
+	__m256i v8 = _mm256_set1_epi32 ((int) blake2s_IV[0]);
+	__m256i v9 = _mm256_set1_epi32 ((int) blake2s_IV[1]);
+	__m256i v10 = _mm256_set1_epi32 ((int) blake2s_IV[2]);
+	__m256i v11 = _mm256_set1_epi32 ((int) blake2s_IV[3]);
+	__m256i v12 = _mm256_set1_epi32 ((int) (blake2s_IV[4] ^ t));
+	__m256i v13 = _mm256_set1_epi32 ((int) blake2s_IV[5]);
+	__m256i v14 = _mm256_set1_epi32 ((int) (blake2s_IV[6] ^ f0));
+	__m256i v15 = _mm256_set1_epi32 ((int) blake2s_IV[7]);
+	int r;
+
+	for (r = 0; r < 10; r++)
+		ROUND (r);
+
+	h[0] = XOR256 (h[0], XOR256 (v0, v8));
+	h[1] = XOR256 (h[1], XOR256 (v1, v9));
+	h[2] = XOR256 (h[2], XOR256 (v2, v10));
+	h[3] = XOR256 (h[3], XOR256 (v3, v11));
+	h[4] = XOR256 (h[4], XOR256 (v4, v12));
+	h[5] = XOR256 (h[5], XOR256 (v5, v13));
+	h[6] = XOR256 (h[6], XOR256 (v6, v14));
+	h[7] = XOR256 (h[7], XOR256 (v7, v15));
+}
+
+/* Compresses the key block left pending in the buffer of a precomputed HMAC context */
+static void blake2s_compress_key_x8 (__m256i h[8], const blake2s_state *S)
+{
+	CRYPTOPP_ALIGN_DATA(32) __m256i m[16];
+	uint32 w;
+	int i;
+
+	for (i = 0; i < 16; i++)
+	{
+		memcpy (&w, S->buf + i * 4, sizeof (w));
+		m[i] = _mm256_set1_epi32 ((int) w);
+	}
+
+	for (i = 0; i < 8; i++)
+		h[i] = _mm256_set1_epi32 ((int) S->h[i]);
+
+	blake2s_compress_x8 (h, m, BLAKE2S_BLOCKBYTES, 0);
+
+	burn (m, sizeof (m));
+	burn (&w, sizeof (w));
+}
+
+int blake2s_pbkdf2_x8 (const blake2s_state *inner, const blake2s_state *outer, uint32 u[BLAKE2S_PBKDF2_LANES][8], uint32 iterations, long volatile *pAbortKeyDerivation)
+{
+	CRYPTOPP_ALIGN_DATA(32) __m256i innerState[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i outerState[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i U[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i T[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i h[8];
+	CRYPTOPP_ALIGN_DATA(32) __m256i m[16];
+	uint32 c;
+	int i, lane;
+
+	/* Only contexts holding exactly the padded key block are supported */
+	if (inner->buflen != BLAKE2S_BLOCKBYTES || inner->t[0] || inner->t[1] || inner->f[0]
+		|| outer->buflen != BLAKE2S_BLOCKBYTES || outer->t[0] || outer->t[1] || outer->f[0])
+		return 0;
+
+	blake2s_compress_key_x8 (innerState, inner);
+	blake2s_compress_key_x8 (outerState, outer);
+
+	for (i = 0; i < 8; i++)
+	{
+		U[i] = _mm256_set_epi32 ((int) u[7][i], (int) u[6][i], (int) u[5][i], (int) u[4][i], (int) u[3][i], (int) u[2][i], (int) u[1][i], (int) u[0][i]);
+		T[i] = U[i];
+	}
+
+	/* The 32-byte messages are zero-padded to a full block */
+	for (i = 8; i < 16; i++)
+		m[i] = _mm256_setzero_si256 ();
+
+	for (c = 1; c < iterations; c++)
+	{
+		// CANCELLATION CHECK: Check every 1024 iterations
+		if (pAbortKeyDerivation && (c & 1023) == 0 && *pAbortKeyDerivation)
+			break;
+
+		/* Inner hash of the previous U */
+		for (i = 0; i < 8; i++)
+		{
+			h[i] = innerState[i];
+			m[i] = U[i];
+		}
+
+		blake2s_compress_x8 (h, m, BLAKE2S_BLOCKBYTES + BLAKE2S_OUTBYTES, (uint32) -1);
+
+		/* Outer hash of the inner digest */
+		for (i = 0; i < 8; i++)
+		{
+			m[i] = h[i];
+			h[i] = outerState[i];
+		}
+
+		blake2s_compress_x8 (h, m, BLAKE2S_BLOCKBYTES + BLAKE2S_OUTBYTES, (uint32) -1);
+
+		for (i = 0; i < 8; i++)
+		{
+			U[i] = h[i];
+			T[i] = XOR256 (T[i], U[i]);
+		}
+	}
+
+	for (i = 0; i < 8; i++)
+	{
+		CRYPTOPP_ALIGN_DATA(32) uint32 lanes[8];
+		_mm256_store_si256 ((__m256i *) lanes, T[i]);
+
+		for (lane = 0; lane < BLAKE2S_PBKDF2_LANES; lane++)
+			u[lane][i] = lanes[lane];
+
+		burn (lanes, sizeof (lanes));
+	}
+
+	/* Prevent leaks */
+	burn (innerState, sizeof (innerState));
+	burn (outerState, sizeof (outerState));
+	burn (U, sizeof (U));
+	burn (T, sizeof (T));
+	burn (h, sizeof (h));
+	burn (m, sizeof (m));
+
+	return 1;
+}
+
+#else
+
+int blake2s_pbkdf2_x8 (const blake2s_state *inner, const blake2s_state *outer, uint32 u[BLAKE2S_PBKDF2_LANES][8], uint32 iterations, long volatile *pAbortKeyDerivation)
+{
+	(void) inner;
+	(void) outer;
+	(void) u;
+	(void) iterations;
+	(void) pAbortKeyDerivation;
+	return 0; /* AVX2 not available */
+}
+
+#endif
+
+#endif // BLAKE2S_PBKDF2_LANES
@@ -15,6 +15,7 @@ Public domain.
 #include "misc.h"
 
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+#if CRYPTOPP_BOOL_SSSE3_INTRINSICS_AVAILABLE
 
 #ifndef _M_X64
 #ifdef _MSC_VER
@@ -82,6 +83,11 @@ static void salsa20_wordtobyte(uint8 output[64],const uint32 input[16], unsigned
 }
 
 
+int chacha_has_ssse3(void)
+{
+    return 1;
+}
+
 void chacha_ECRYPT_encrypt_bytes(size_t bytes, uint32* x, const uint8* m, uint8* out, uint8* output, unsigned int r)
 {
   unsigned int i;
@@ -110,4 +116,15 @@ void chacha_ECRYPT_encrypt_bytes(size_t bytes, uint32* x, const uint8* m, uint8*
   for (i = 0;i < bytes;++i) out[i] = m[i] ^ output[i];
 }
 
+#else
+int chacha_has_ssse3(void)
+{
+    return 0;
+}
+
+/* never called since chacha_has_ssse3 returns 0 */
+void chacha_ECRYPT_encrypt_bytes(size_t bytes, uint32* x, const uint8* m, uint8* out, uint8* output, unsigned int r)
+{
+}
+#endif
 #endif
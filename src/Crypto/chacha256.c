@@ -11,14 +11,22 @@ and released into public domain.
 
 
 
+/* VC_INLINE already implies internal linkage except with MSVC */
+#if !defined(__GNUC__) && defined(_MSC_VER)
+#define CHACHA_INLINE static VC_INLINE
+#else
+#define CHACHA_INLINE VC_INLINE
+#endif
+
 #define rotater32(x,n)	rotr32(x, n)
 #define rotatel32(x,n)	rotl32(x, n)
 
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+int chacha_has_ssse3(void);
 void chacha_ECRYPT_encrypt_bytes(size_t bytes, uint32* x, const unsigned char* m, unsigned char* out, unsigned char* output, unsigned int r);
 #endif
 
-static VC_INLINE void xor_block_512(const unsigned char* in, const unsigned char* prev, unsigned char* out)
+CHACHA_INLINE void xor_block_512(const unsigned char* in, const unsigned char* prev, unsigned char* out)
 {
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(_UEFI) && (!defined (TC_WINDOWS_DRIVER) || (!defined (DEBUG)))
     if (HasSSE2())
@@ -50,7 +58,7 @@ static VC_INLINE void xor_block_512(const unsigned char* in, const unsigned char
 
 }
 
-static VC_INLINE void chacha_core(uint32* x, int r)
+CHACHA_INLINE void chacha_core(uint32* x, int r)
 {
 	int i;
     for (i = 0; i < r; i++)
@@ -129,7 +137,7 @@ static VC_INLINE void chacha_core(uint32* x, int r)
     }
 }
 
-static VC_INLINE void chacha_hash(const uint32* in, uint32* out, int r)
+CHACHA_INLINE void chacha_hash(const uint32* in, uint32* out, int r)
 {
     uint32 x[16];
 	int i;
@@ -139,14 +147,14 @@ static VC_INLINE void chacha_hash(const uint32* in, uint32* out, int r)
         out[i] = x[i] + in[i];
 }
 
-static VC_INLINE void incrementSalsaCounter(uint32* input, uint32* block, int r)
+CHACHA_INLINE void incrementSalsaCounter(uint32* input, uint32* block, int r)
 {
     chacha_hash(input, block, r);
     if (!++input[12])
         ++input[13];
 }
 
-static VC_INLINE void do_encrypt(const unsigned char* in, size_t len, unsigned char* out, int r, size_t* posPtr, uint32* input, uint32* block)
+CHACHA_INLINE void do_encrypt(const unsigned char* in, size_t len, unsigned char* out, int r, size_t* posPtr, uint32* input, uint32* block)
 {
     size_t i = 0, pos = *posPtr;
     if (pos)
@@ -162,7 +170,7 @@ static VC_INLINE void do_encrypt(const unsigned char* in, size_t len, unsigned c
         pos = 0;
 
 #if CRYPTOPP_SSSE3_AVAILABLE && !defined(_UEFI) && (!defined (TC_WINDOWS_DRIVER) || (!defined (DEBUG)))
-    if (HasSSSE3())
+    if (HasSSSE3() && chacha_has_ssse3())
     {
         size_t fullblocks = len - len % 64;
         if (fullblocks)
@@ -32,7 +32,14 @@
 #include "misc.h"
 #include <string.h>
 
-static VC_INLINE void ChaCha20RngReKey (ChaCha20RngCtx* pCtx, int useCallBack)
+/* VC_INLINE already implies internal linkage except with MSVC */
+#if !defined(__GNUC__) && defined(_MSC_VER)
+#define CHACHA_INLINE static VC_INLINE
+#else
+#define CHACHA_INLINE VC_INLINE
+#endif
+
+CHACHA_INLINE void ChaCha20RngReKey (ChaCha20RngCtx* pCtx, int useCallBack)
 {
 	/* fill rs_buf with the keystream */
 	if (pCtx->m_rs_have)
@@ -58,7 +65,7 @@ static VC_INLINE void ChaCha20RngReKey (ChaCha20RngCtx* pCtx, int useCallBack)
 	pCtx->m_rs_have = sizeof (pCtx->m_rs_buf) - CHACHA20RNG_KEYSZ - CHACHA20RNG_IVSZ;
 }
 
-static VC_INLINE void ChaCha20RngStir(ChaCha20RngCtx* pCtx)
+CHACHA_INLINE void ChaCha20RngStir(ChaCha20RngCtx* pCtx)
 {
 	ChaCha20RngReKey (pCtx, 1);
 
@@ -69,7 +76,7 @@ static VC_INLINE void ChaCha20RngStir(ChaCha20RngCtx* pCtx)
 	pCtx->m_rs_count = 1600000;
 }
 
-static VC_INLINE void ChaCha20RngStirIfNeeded(ChaCha20RngCtx* pCtx, size_t len)
+CHACHA_INLINE void ChaCha20RngStirIfNeeded(ChaCha20RngCtx* pCtx, size_t len)
 {
 	if (pCtx->m_rs_count <= len) {
 		ChaCha20RngStir(pCtx);
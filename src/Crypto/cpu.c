@@ -199,6 +199,7 @@ static uint64 xgetbv()
 volatile int g_x86DetectionDone = 0;
 volatile int g_hasISSE = 0, g_hasSSE2 = 0, g_hasSSSE3 = 0, g_hasMMX = 0, g_hasAESNI = 0, g_hasCLMUL = 0, g_isP4 = 0;
 volatile int g_hasAVX = 0, g_hasAVX2 = 0, g_hasBMI2 = 0, g_hasSSE42 = 0, g_hasSSE41 = 0, g_isIntel = 0, g_isAMD = 0;
+volatile int g_hasAVX512 = 0, g_hasAVX512VBMI = 0, g_hasGFNI = 0, g_hasVAES = 0;
 volatile int g_hasRDRAND = 0, g_hasRDSEED = 0;
 volatile int g_hasSHA256 = 0;
 volatile uint32 g_cacheLineSize = CRYPTOPP_L1_CACHE_LINE_SIZE;
@@ -325,7 +326,8 @@ static BOOL CheckSHA256Support() {
 
 void DetectX86Features()
 {
-	uint32 cpuid[4] = {0}, cpuid1[4] = {0}, cpuid2[4] = {0};
+	uint32 cpuid[4] = {0}, cpuid1[4] = {0}, cpuid2[4] = {0}, cpuid7[4] = {0};
+	uint64 xcrFeatureMask = 0;
 	if (!CpuId(0, cpuid))
 		return;
 	if (!CpuId(1, cpuid1))
@@ -339,7 +341,7 @@ void DetectX86Features()
 		g_hasSSE2 = (cpuid1[2] & (1 << 27)) || TrySSE2();
 	if (g_hasSSE2 && (cpuid1[2] & (1 << 28)) && (cpuid1[2] & (1 << 27)) && (cpuid1[2] & (1 << 26))) /* CPU has AVX and OS supports XSAVE/XRSTORE */
 	{
-      uint64 xcrFeatureMask = xgetbv();
+      xcrFeatureMask = xgetbv();
       g_hasAVX = (xcrFeatureMask & 0x6) == 0x6;
 	}
 	g_hasAVX2 = g_hasAVX && (cpuid1[1] & (1 << 5));
@@ -369,6 +371,15 @@ void DetectX86Features()
 	}
 #endif
 
+	// AVX-512 (F and BW) also requires the OS to save the opmask and ZMM registers (XCR0 bits 5 to 7)
+	if (g_hasAVX && cpuid[0] >= 7 && CpuId(7, cpuid7))
+	{
+		g_hasAVX512 = ((xcrFeatureMask & 0xE6) == 0xE6) && (cpuid7[1] & (1 << 16)) && (cpuid7[1] & (1 << 30));
+		g_hasAVX512VBMI = g_hasAVX512 && (cpuid7[2] & (1 << 1));
+		g_hasGFNI = (cpuid7[2] & (1 << 8)) != 0;
+		g_hasVAES = g_hasAESNI && (cpuid7[1] & (1 << 5)) && (cpuid7[2] & (1 << 9));
+	}
+
 	if ((cpuid1[3] & (1 << 25)) != 0)
 		g_hasISSE = 1;
 	else
@@ -458,6 +469,10 @@ void DisableCPUExtendedFeatures ()
 	g_hasMMX = 0;
 	g_hasAVX = 0;
 	g_hasAVX2 = 0;
+	g_hasAVX512 = 0;
+	g_hasAVX512VBMI = 0;
+	g_hasGFNI = 0;
+	g_hasVAES = 0;
 	g_hasBMI2 = 0;
 	g_hasSSE42 = 0;
 	g_hasSSE41 = 0;
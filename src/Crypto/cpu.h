@@ -247,6 +247,10 @@ extern volatile int g_hasISSE;
 extern volatile int g_hasMMX;
 extern volatile int g_hasAVX;
 extern volatile int g_hasAVX2;
+extern volatile int g_hasAVX512;
+extern volatile int g_hasAVX512VBMI;
+extern volatile int g_hasGFNI;
+extern volatile int g_hasVAES;
 extern volatile int g_hasBMI2;
 extern volatile int g_hasSSE42;
 extern volatile int g_hasSSE41;
@@ -278,6 +282,10 @@ void DisableCPUExtendedFeatures ();
 #define HasSSE41() g_hasSSE41
 #define HasSAVX() g_hasAVX
 #define HasSAVX2() g_hasAVX2
+#define HasSAVX512() g_hasAVX512
+#define HasSAVX512VBMI() g_hasAVX512VBMI
+#define HasGFNI() g_hasGFNI
+#define HasVAES() g_hasVAES
 #define HasSBMI2() g_hasBMI2
 #define HasSSSE3() g_hasSSSE3
 #define HasAESNI() g_hasAESNI
@@ -324,6 +332,10 @@ void DetectArmFeatures();
 #define HasSSE41() 0
 #define HasSAVX() 0
 #define HasSAVX2() 0
+#define HasSAVX512() 0
+#define HasSAVX512VBMI() 0
+#define HasGFNI() 0
+#define HasVAES() 0
 #define HasSBMI2() 0
 #define HasSSSE3() 0
 #define HasAESNI() 0
@@ -17,6 +17,9 @@ void kuznyechik_encrypt_block_simd(uint8* out, const uint8* in, kuznyechik_kds*
 void kuznyechik_encrypt_blocks_simd(uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds);
 void kuznyechik_decrypt_block_simd(uint8* out, const uint8* in, kuznyechik_kds* kds);
 void kuznyechik_decrypt_blocks_simd(uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds);
+/* AVX-512 VBMI and GFNI versions processing multiples of 4 blocks. They return the number of blocks processed, 0 if support was not compiled in */
+size_t kuznyechik_encrypt_blocks_avx512(uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds);
+size_t kuznyechik_decrypt_blocks_avx512(uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds);
 #endif
 
 //#define CPPCRYPTO_DEBUG
@@ -2310,6 +2313,16 @@ void kuznyechik_decrypt_blocks_simd(uint8* out, const uint8* in, size_t blocks,
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(_UEFI) && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
 		if(HasSSE2())
 		{
+#if !defined (TC_WINDOWS_DRIVER)
+			if (HasSAVX512() && HasSAVX512VBMI() && HasGFNI() && (blocks >= 4))
+			{
+				size_t processed = kuznyechik_encrypt_blocks_avx512 (out, in, blocks, kds);
+				in += processed * 16;
+				out += processed * 16;
+				blocks -= processed;
+			}
+#endif
+
 			kuznyechik_encrypt_blocks_simd (out, in, blocks, kds);
 		}
 		else
@@ -2380,6 +2393,16 @@ void kuznyechik_decrypt_blocks_simd(uint8* out, const uint8* in, size_t blocks,
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(_UEFI) && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
 		if(HasSSE2())
 		{
+#if !defined (TC_WINDOWS_DRIVER)
+			if (HasSAVX512() && HasSAVX512VBMI() && HasGFNI() && (blocks >= 4))
+			{
+				size_t processed = kuznyechik_decrypt_blocks_avx512 (out, in, blocks, kds);
+				in += processed * 16;
+				out += processed * 16;
+				blocks -= processed;
+			}
+#endif
+
 			kuznyechik_decrypt_blocks_simd (out, in, blocks, kds);
 		}
 		else
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2013-2025 AM Crypto
+ * Governed by the Apache License 2.0 the full text of which is contained
+ * in the file License.txt included in VeraCrypt binary and source
+ * code distribution packages.
+ */
+
+/* Kuznyechik processing 4 blocks per 512-bit register with AVX-512 VBMI and GFNI.
+   The bytes are mapped from the Kuznyechik field (x^8 + x^7 + x^6 + x + 1) to the isomorphic AES field with GF2P8AFFINEQB,
+   so that the L transformation becomes a sum of GF2P8MULB products with the columns of its matrix.
+   The S-box, which is not affine equivalent to the field inversion, is a 256-byte lookup made of two VPERMI2B. */
+
+#include "kuznyechik.h"
+#include "Crypto/config.h"
+#include "Crypto/cpu.h"
+#include "Crypto/misc.h"
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+
+#if (defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VBMI__) && defined(__GFNI__)) || (defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64))
+
+#include <immintrin.h>
+
+/* Bit matrices of the field isomorphism and of its inverse */
+#define KUZNYECHIK_TO_AES_FIELD		0x5d0ce430cee6bcd0ULL
+#define KUZNYECHIK_FROM_AES_FIELD	0xc9248c8eb6be7c4aULL
+
+/* Pi and its inverse, expressed in the AES field */
+CRYPTOPP_ALIGN_DATA(64) static const uint8 kuznyechik_sbox_aes[256] = {
+	0xc0, 0x39, 0xd0, 0xa9, 0x25, 0x3a, 0xec, 0xa2, 0x5b, 0x45, 0x24, 0x53, 0x9c, 0x09, 0x85, 0x81,
+	0x95, 0x66, 0xa5, 0xe3, 0x77, 0x90, 0x0a, 0x79, 0x94, 0xa1, 0x58, 0x1d, 0xef, 0x9f, 0xf3, 0xf8,
+	0x9b, 0x80, 0xbb, 0x5a, 0x5d, 0x37, 0x2a, 0x68, 0xd6, 0x63, 0x6d, 0x38, 0x11, 0x6c, 0x20, 0x44,
+	0xad, 0xc8, 0xee, 0x35, 0x70, 0x74, 0xb3, 0xbc, 0x4c, 0xfd, 0xf9, 0x57, 0x15, 0x2d, 0xed, 0xf5,
+	0x2f, 0x46, 0x0b, 0xfc, 0xc7, 0x4b, 0x8e, 0xa4, 0x96, 0x01, 0x73, 0x4a, 0x14, 0x3b, 0x1a, 0x88,
+	0xc3, 0xbd, 0x36, 0x86, 0xa6, 0x6b, 0x04, 0x97, 0x19, 0x17, 0x49, 0x0e, 0xaf, 0x1f, 0x3f, 0x7c,
+	0x0d, 0xf2, 0xeb, 0x87, 0xda, 0xa7, 0xd3, 0xf1, 0x59, 0xb2, 0x52, 0x1e, 0xb6, 0x9a, 0xac, 0x7e,
+	0xb5, 0x60, 0xf4, 0x06, 0xfe, 0x8b, 0xcd, 0x54, 0xe0, 0xa0, 0x51, 0x75, 0x27, 0x10, 0x23, 0x5f,
+	0xff, 0x05, 0xcb, 0xb1, 0x7d, 0x48, 0x71, 0x8d, 0x2c, 0xab, 0xd5, 0x3c, 0x2b, 0xb4, 0x6f, 0x32,
+	0xc6, 0xc1, 0x93, 0x6a, 0x8c, 0x30, 0xa3, 0xcf, 0xde, 0x7b, 0x8f, 0xe2, 0x82, 0xd8, 0x5e, 0x07,
+	0x65, 0x55, 0x41, 0x26, 0x83, 0x76, 0x42, 0xce, 0xd9, 0x21, 0xe5, 0x33, 0x22, 0xdb, 0xc9, 0x72,
+	0xdc, 0xb9, 0x13, 0x84, 0xd2, 0x4f, 0x9e, 0x89, 0xc5, 0xe7, 0x43, 0xcc, 0xae, 0x28, 0x0c, 0x78,
+	0xf7, 0xd7, 0x4e, 0x12, 0x1b, 0xca, 0x08, 0x6e, 0x56, 0x7f, 0x02, 0xaa, 0x50, 0x61, 0xf0, 0xb7,
+	0x34, 0x5c, 0x1c, 0xba, 0x67, 0xb8, 0x8a, 0xa8, 0x99, 0xbf, 0x4d, 0xd1, 0x40, 0x69, 0xc2, 0xe9,
+	0x03, 0x31, 0xe1, 0x98, 0x2e, 0xdf, 0xd4, 0x0f, 0x3e, 0x7a, 0x3d, 0xfb, 0x64, 0xbe, 0x00, 0xdd,
+	0xe8, 0x16, 0xe6, 0xfa, 0x9d, 0x92, 0x47, 0x62, 0xea, 0xe4, 0xc4, 0xf6, 0x29, 0x18, 0xb0, 0x91,
+};
+
+CRYPTOPP_ALIGN_DATA(64) static const uint8 kuznyechik_inv_sbox_aes[256] = {
+	0xee, 0x49, 0xca, 0xe0, 0x56, 0x81, 0x73, 0x9f, 0xc6, 0x0d, 0x16, 0x42, 0xbe, 0x60, 0x5b, 0xe7,
+	0x7d, 0x2c, 0xc3, 0xb2, 0x4c, 0x3c, 0xf1, 0x59, 0xfd, 0x58, 0x4e, 0xc4, 0xd2, 0x1b, 0x6b, 0x5d,
+	0x2e, 0xa9, 0xac, 0x7e, 0x0a, 0x04, 0xa3, 0x7c, 0xbd, 0xfc, 0x26, 0x8c, 0x88, 0x3d, 0xe4, 0x40,
+	0x95, 0xe1, 0x8f, 0xab, 0xd0, 0x33, 0x52, 0x25, 0x2b, 0x01, 0x05, 0x4d, 0x8b, 0xea, 0xe8, 0x5e,
+	0xdc, 0xa2, 0xa6, 0xba, 0x2f, 0x09, 0x41, 0xf6, 0x85, 0x5a, 0x4b, 0x45, 0x38, 0xda, 0xc2, 0xb5,
+	0xcc, 0x7a, 0x6a, 0x0b, 0x77, 0xa1, 0xc8, 0x3b, 0x1a, 0x68, 0x23, 0x08, 0xd1, 0x24, 0x9e, 0x7f,
+	0x71, 0xcd, 0xf7, 0x29, 0xec, 0xa0, 0x11, 0xd4, 0x27, 0xdd, 0x93, 0x55, 0x2d, 0x2a, 0xc7, 0x8e,
+	0x34, 0x86, 0xaf, 0x4a, 0x35, 0x7b, 0xa5, 0x14, 0xbf, 0x17, 0xe9, 0x99, 0x5f, 0x84, 0x6f, 0xc9,
+	0x21, 0x0f, 0x9c, 0xa4, 0xb3, 0x0e, 0x53, 0x63, 0x4f, 0xb7, 0xd6, 0x75, 0x94, 0x87, 0x46, 0x9a,
+	0x15, 0xff, 0xf5, 0x92, 0x18, 0x10, 0x48, 0x57, 0xe3, 0xd8, 0x6d, 0x20, 0x0c, 0xf4, 0xb6, 0x1d,
+	0x79, 0x19, 0x07, 0x96, 0x47, 0x12, 0x54, 0x65, 0xd7, 0x03, 0xcb, 0x89, 0x6e, 0x30, 0xbc, 0x5c,
+	0xfe, 0x83, 0x69, 0x36, 0x8d, 0x70, 0x6c, 0xcf, 0xd5, 0xb1, 0xd3, 0x22, 0x37, 0x51, 0xed, 0xd9,
+	0x00, 0x91, 0xde, 0x50, 0xfa, 0xb8, 0x90, 0x44, 0x31, 0xae, 0xc5, 0x82, 0xbb, 0x76, 0xa7, 0x97,
+	0x02, 0xdb, 0xb4, 0x66, 0xe6, 0x8a, 0x28, 0xc1, 0x9d, 0xa8, 0x64, 0xad, 0xb0, 0xef, 0x98, 0xe5,
+	0x78, 0xe2, 0x9b, 0x13, 0xf9, 0xaa, 0xf2, 0xb9, 0xf0, 0xdf, 0xf8, 0x62, 0x06, 0x3e, 0x32, 0x1c,
+	0xce, 0x67, 0x61, 0x1e, 0x72, 0x3f, 0xfb, 0xc0, 0x1f, 0x3a, 0xf3, 0xeb, 0x43, 0x39, 0x74, 0x80,
+};
+
+/* Column i holds the image of byte i by L (and by its inverse), expressed in the AES field */
+CRYPTOPP_ALIGN_DATA(16) static const uint8 kuznyechik_l_columns_aes[16][16] = {
+	{0x54, 0xcd, 0xa8, 0x57, 0x20, 0xfd, 0xe6, 0x73, 0x02, 0x59, 0x2a, 0x74, 0xc9, 0xad, 0x83, 0x4a},
+	{0x6e, 0x6c, 0x12, 0x94, 0xd4, 0x57, 0xfe, 0x6a, 0xe7, 0xff, 0x28, 0x4b, 0x7f, 0x6f, 0x49, 0x6c},
+	{0x67, 0x06, 0xb2, 0xc9, 0xbb, 0x09, 0xe9, 0xa1, 0xb2, 0x02, 0x45, 0x68, 0x88, 0x66, 0x67, 0x82},
+	{0x44, 0xeb, 0x10, 0x24, 0x22, 0x24, 0x8f, 0xaa, 0xbe, 0x79, 0x8a, 0xa5, 0xda, 0x22, 0x7a, 0xc9},
+	{0x0c, 0x3d, 0x8a, 0xed, 0x6c, 0x37, 0x47, 0x33, 0x23, 0xd1, 0xaa, 0x7f, 0xd5, 0x7b, 0x59, 0x71},
+	{0xe0, 0xe6, 0x84, 0xc8, 0x4f, 0x75, 0x49, 0x78, 0xd1, 0xf9, 0x34, 0xd9, 0x4a, 0xc2, 0x56, 0x41},
+	{0xd4, 0xa6, 0xed, 0xcf, 0x30, 0x8d, 0x36, 0xe5, 0xfa, 0x39, 0xbd, 0x44, 0x80, 0x1f, 0xcc, 0x01},
+	{0xd5, 0x19, 0x0e, 0xba, 0xef, 0xcd, 0x6b, 0x45, 0xe7, 0xa3, 0x13, 0xc9, 0x8d, 0x2d, 0x9c, 0x86},
+	{0x63, 0x40, 0x99, 0xdf, 0xd1, 0xa9, 0xfe, 0xff, 0x52, 0x53, 0x83, 0x38, 0x72, 0xa5, 0x0b, 0x01},
+	{0x44, 0xae, 0xe8, 0xce, 0xff, 0x2c, 0x4f, 0x8d, 0xfd, 0x0b, 0x79, 0xf7, 0xf1, 0xdf, 0x26, 0x41},
+	{0xa3, 0x02, 0xa5, 0xa3, 0x36, 0x3d, 0x6f, 0xe3, 0x0f, 0x15, 0x4f, 0x09, 0xae, 0xa4, 0xd1, 0x71},
+	{0xca, 0x49, 0xbb, 0xe7, 0x01, 0x2f, 0x43, 0x50, 0x01, 0xd5, 0xf0, 0x3c, 0x3c, 0xb9, 0x89, 0xc9},
+	{0x4e, 0xb3, 0x28, 0x46, 0xaf, 0x14, 0x4c, 0xff, 0xd9, 0x6e, 0x06, 0x05, 0x4c, 0x9d, 0xc2, 0x82},
+	{0xe0, 0xc2, 0xa5, 0xbe, 0xad, 0x30, 0x92, 0x0f, 0xe0, 0x12, 0xe6, 0xe6, 0xb7, 0xe6, 0x81, 0x6c},
+	{0x90, 0x88, 0x1c, 0x7e, 0x91, 0x70, 0x8e, 0xcd, 0xd7, 0x05, 0xa8, 0xa6, 0x25, 0xae, 0xee, 0x4a},
+	{0xcd, 0xa8, 0x57, 0x20, 0xfd, 0xe6, 0x73, 0x02, 0x59, 0x2a, 0x74, 0xc9, 0xad, 0x83, 0x4a, 0x01},
+};
+
+CRYPTOPP_ALIGN_DATA(16) static const uint8 kuznyechik_inv_l_columns_aes[16][16] = {
+	{0x01, 0x4a, 0x83, 0xad, 0xc9, 0x74, 0x2a, 0x59, 0x02, 0x73, 0xe6, 0xfd, 0x20, 0x57, 0xa8, 0xcd},
+	{0x4a, 0xee, 0xae, 0x25, 0xa6, 0xa8, 0x05, 0xd7, 0xcd, 0x8e, 0x70, 0x91, 0x7e, 0x1c, 0x88, 0x90},
+	{0x6c, 0x81, 0xe6, 0xb7, 0xe6, 0xe6, 0x12, 0xe0, 0x0f, 0x92, 0x30, 0xad, 0xbe, 0xa5, 0xc2, 0xe0},
+	{0x82, 0xc2, 0x9d, 0x4c, 0x05, 0x06, 0x6e, 0xd9, 0xff, 0x4c, 0x14, 0xaf, 0x46, 0x28, 0xb3, 0x4e},
+	{0xc9, 0x89, 0xb9, 0x3c, 0x3c, 0xf0, 0xd5, 0x01, 0x50, 0x43, 0x2f, 0x01, 0xe7, 0xbb, 0x49, 0xca},
+	{0x71, 0xd1, 0xa4, 0xae, 0x09, 0x4f, 0x15, 0x0f, 0xe3, 0x6f, 0x3d, 0x36, 0xa3, 0xa5, 0x02, 0xa3},
+	{0x41, 0x26, 0xdf, 0xf1, 0xf7, 0x79, 0x0b, 0xfd, 0x8d, 0x4f, 0x2c, 0xff, 0xce, 0xe8, 0xae, 0x44},
+	{0x01, 0x0b, 0xa5, 0x72, 0x38, 0x83, 0x53, 0x52, 0xff, 0xfe, 0xa9, 0xd1, 0xdf, 0x99, 0x40, 0x63},
+	{0x86, 0x9c, 0x2d, 0x8d, 0xc9, 0x13, 0xa3, 0xe7, 0x45, 0x6b, 0xcd, 0xef, 0xba, 0x0e, 0x19, 0xd5},
+	{0x01, 0xcc, 0x1f, 0x80, 0x44, 0xbd, 0x39, 0xfa, 0xe5, 0x36, 0x8d, 0x30, 0xcf, 0xed, 0xa6, 0xd4},
+	{0x41, 0x56, 0xc2, 0x4a, 0xd9, 0x34, 0xf9, 0xd1, 0x78, 0x49, 0x75, 0x4f, 0xc8, 0x84, 0xe6, 0xe0},
+	{0x71, 0x59, 0x7b, 0xd5, 0x7f, 0xaa, 0xd1, 0x23, 0x33, 0x47, 0x37, 0x6c, 0xed, 0x8a, 0x3d, 0x0c},
+	{0xc9, 0x7a, 0x22, 0xda, 0xa5, 0x8a, 0x79, 0xbe, 0xaa, 0x8f, 0x24, 0x22, 0x24, 0x10, 0xeb, 0x44},
+	{0x82, 0x67, 0x66, 0x88, 0x68, 0x45, 0x02, 0xb2, 0xa1, 0xe9, 0x09, 0xbb, 0xc9, 0xb2, 0x06, 0x67},
+	{0x6c, 0x49, 0x6f, 0x7f, 0x4b, 0x28, 0xff, 0xe7, 0x6a, 0xfe, 0x57, 0xd4, 0x94, 0x12, 0x6c, 0x6e},
+	{0x4a, 0x83, 0xad, 0xc9, 0x74, 0x2a, 0x59, 0x02, 0x73, 0xe6, 0xfd, 0x20, 0x57, 0xa8, 0xcd, 0x54},
+};
+
+#define BROADCAST_BLOCK(p)		_mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i *) (p)))
+#define TO_AES_FIELD(x)			_mm512_gf2p8affine_epi64_epi8 ((x), _mm512_set1_epi64 ((long long) KUZNYECHIK_TO_AES_FIELD), 0)
+#define FROM_AES_FIELD(x)		_mm512_gf2p8affine_epi64_epi8 ((x), _mm512_set1_epi64 ((long long) KUZNYECHIK_FROM_AES_FIELD), 0)
+
+/* Byte i of each block broadcast to the whole block and multiplied by column i */
+#define MUL_COLUMN(x, i)		_mm512_gf2p8mul_epi8 (_mm512_shuffle_epi8 ((x), _mm512_set1_epi8 (i)), columns[i])
+
+VC_INLINE __m512i kuznyechik_sbox_x4 (__m512i x, const __m512i sbox[4])
+{
+	__m512i lo = _mm512_permutex2var_epi8 (sbox[0], x, sbox[1]);
+	__m512i hi = _mm512_permutex2var_epi8 (sbox[2], x, sbox[3]);
+	return _mm512_mask_blend_epi8 (_mm512_movepi8_mask (x), lo, hi);
+}
+
+VC_INLINE __m512i kuznyechik_linear_x4 (__m512i x, const __m512i columns[16])
+{
+	__m512i r = MUL_COLUMN (x, 0);
+	int i;
+
+	for (i = 1; i < 15; i += 2)
+		r = _mm512_ternarylogic_epi64 (r, MUL_COLUMN (x, i), MUL_COLUMN (x, i + 1), 0x96);
+
+	return _mm512_xor_si512 (r, MUL_COLUMN (x, 15));
+}
+
+static void kuznyechik_load_tables (__m512i sbox[4], __m512i columns[16], __m512i roundKeys[10], const uint8 *sboxTable, const uint8 columnTable[16][16], const kuznyechik_kds *kds)
+{
+	int i;
+
+	for (i = 0; i < 4; i++)
+		sbox[i] = _mm512_loadu_si512 (sboxTable + 64 * i);
+
+	for (i = 0; i < 16; i++)
+		columns[i] = BROADCAST_BLOCK (columnTable[i]);
+
+	for (i = 0; i < 10; i++)
+		roundKeys[i] = TO_AES_FIELD (BROADCAST_BLOCK (&kds->rke[2 * i]));
+}
+
+size_t kuznyechik_encrypt_blocks_avx512 (uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds)
+{
+	CRYPTOPP_ALIGN_DATA(64) __m512i roundKeys[10];
+	__m512i sbox[4], columns[16];
+	__m512i data1, data2, data3, data4;
+	size_t processed = 0;
+	int round;
+
+	kuznyechik_load_tables (sbox, columns, roundKeys, kuznyechik_sbox_aes, kuznyechik_l_columns_aes, kds);
+
+	while (blocks - processed >= 16)
+	{
+		data1 = TO_AES_FIELD (_mm512_loadu_si512 (in));
+		data2 = TO_AES_FIELD (_mm512_loadu_si512 (in + 64));
+		data3 = TO_AES_FIELD (_mm512_loadu_si512 (in + 128));
+		data4 = TO_AES_FIELD (_mm512_loadu_si512 (in + 192));
+
+		for (round = 0; round < 9; round++)
+		{
+			data1 = kuznyechik_linear_x4 (kuznyechik_sbox_x4 (_mm512_xor_si512 (data1, roundKeys[round]), sbox), columns);
+			data2 = kuznyechik_linear_x4 (kuznyechik_sbox_x4 (_mm512_xor_si512 (data2, roundKeys[round]), sbox), columns);
+			data3 = kuznyechik_linear_x4 (kuznyechik_sbox_x4 (_mm512_xor_si512 (data3, roundKeys[round]), sbox), columns);
+			data4 = kuznyechik_linear_x4 (kuznyechik_sbox_x4 (_mm512_xor_si512 (data4, roundKeys[round]), sbox), columns);
+		}
+
+		_mm512_storeu_si512 (out, FROM_AES_FIELD (_mm512_xor_si512 (data1, roundKeys[9])));
+		_mm512_storeu_si512 (out + 64, FROM_AES_FIELD (_mm512_xor_si512 (data2, roundKeys[9])));
+		_mm512_storeu_si512 (out + 128, FROM_AES_FIELD (_mm512_xor_si512 (data3, roundKeys[9])));
+		_mm512_storeu_si512 (out + 192, FROM_AES_FIELD (_mm512_xor_si512 (data4, roundKeys[9])));
+
+		in += 256;
+		out += 256;
+		processed += 16;
+	}
+
+	while (blocks - processed >= 4)
+	{
+		data1 = TO_AES_FIELD (_mm512_loadu_si512 (in));
+
+		for (round = 0; round < 9; round++)
+			data1 = kuznyechik_linear_x4 (kuznyechik_sbox_x4 (_mm512_xor_si512 (data1, roundKeys[round]), sbox), columns);
+
+		_mm512_storeu_si512 (out, FROM_AES_FIELD (_mm512_xor_si512 (data1, roundKeys[9])));
+
+		in += 64;
+		out += 64;
+		processed += 4;
+	}
+
+	FAST_ERASE64 (roundKeys, sizeof (roundKeys));
+	return processed;
+}
+
+size_t kuznyechik_decrypt_blocks_avx512 (uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds)
+{
+	CRYPTOPP_ALIGN_DATA(64) __m512i roundKeys[10];
+	__m512i sbox[4], columns[16];
+	__m512i data1, data2, data3, data4;
+	size_t processed = 0;
+	int round;
+
+	/* The encryption round keys are used in reverse order */
+	kuznyechik_load_tables (sbox, columns, roundKeys, kuznyechik_inv_sbox_aes, kuznyechik_inv_l_columns_aes, kds);
+
+	while (blocks - processed >= 16)
+	{
+		data1 = _mm512_xor_si512 (TO_AES_FIELD (_mm512_loadu_si512 (in)), roundKeys[9]);
+		data2 = _mm512_xor_si512 (TO_AES_FIELD (_mm512_loadu_si512 (in + 64)), roundKeys[9]);
+		data3 = _mm512_xor_si512 (TO_AES_FIELD (_mm512_loadu_si512 (in + 128)), roundKeys[9]);
+		data4 = _mm512_xor_si512 (TO_AES_FIELD (_mm512_loadu_si512 (in + 192)), roundKeys[9]);
+
+		for (round = 8; round >= 0; round--)
+		{
+			data1 = _mm512_xor_si512 (kuznyechik_sbox_x4 (kuznyechik_linear_x4 (data1, columns), sbox), roundKeys[round]);
+			data2 = _mm512_xor_si512 (kuznyechik_sbox_x4 (kuznyechik_linear_x4 (data2, columns), sbox), roundKeys[round]);
+			data3 = _mm512_xor_si512 (kuznyechik_sbox_x4 (kuznyechik_linear_x4 (data3, columns), sbox), roundKeys[round]);
+			data4 = _mm512_xor_si512 (kuznyechik_sbox_x4 (kuznyechik_linear_x4 (data4, columns), sbox), roundKeys[round]);
+		}
+
+		_mm512_storeu_si512 (out, FROM_AES_FIELD (data1));
+		_mm512_storeu_si512 (out + 64, FROM_AES_FIELD (data2));
+		_mm512_storeu_si512 (out + 128, FROM_AES_FIELD (data3));
+		_mm512_storeu_si512 (out + 192, FROM_AES_FIELD (data4));
+
+		in += 256;
+		out += 256;
+		processed += 16;
+	}
+
+	while (blocks - processed >= 4)
+	{
+		data1 = _mm512_xor_si512 (TO_AES_FIELD (_mm512_loadu_si512 (in)), roundKeys[9]);
+
+		for (round = 8; round >= 0; round--)
+			data1 = _mm512_xor_si512 (kuznyechik_sbox_x4 (kuznyechik_linear_x4 (data1, columns), sbox), roundKeys[round]);
+
+		_mm512_storeu_si512 (out, FROM_AES_FIELD (data1));
+
+		in += 64;
+		out += 64;
+		processed += 4;
+	}
+
+	FAST_ERASE64 (roundKeys, sizeof (roundKeys));
+	return processed;
+}
+
+#else
+
+size_t kuznyechik_encrypt_blocks_avx512 (uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds)
+{
+	(void) out;
+	(void) in;
+	(void) blocks;
+	(void) kds;
+	return 0; /* AVX-512 and GFNI not available */
+}
+
+size_t kuznyechik_decrypt_blocks_avx512 (uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds)
+{
+	(void) out;
+	(void) in;
+	(void) blocks;
+	(void) kds;
+	return 0; /* AVX-512 and GFNI not available */
+}
+
+#endif
+
+#endif // CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
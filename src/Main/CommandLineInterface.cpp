@@ -24,10 +24,16 @@ namespace VeraCrypt
 	CommandLineInterface::CommandLineInterface (int argc, wchar_t** argv, UserInterfaceType::Enum interfaceType) :
 		ArgCommand (CommandId::None),
 		ArgFilesystem (VolumeCreationOptions::FilesystemType::Unknown),
+		ArgFormatChunkSize (0),
+		ArgFormatDirectIO (false),
+		ArgFormatQueueDepth (0),
 		ArgNewPim (-1),
 		ArgNoHiddenVolumeProtection (false),
 		ArgPim (-1),
+		ArgPreallocate (false),
+		ArgResume (false),
 		ArgSize (0),
+		ArgSparse (false),
 		ArgVolumeType (VolumeType::Unknown),
 		ArgAllowScreencapture (false),
 		ArgDisableFileSizeCheck (false),
@@ -53,17 +59,24 @@ namespace VeraCrypt
 		parser.AddSwitch (L"",  L"cache",				_("Cache passwords and keyfiles"));
 #endif
 		parser.AddSwitch (L"C", L"change",				_("Change password or keyfiles"));
+		parser.AddOption (L"",	L"checksum",			_("Hash algorithm used to compute checksum of exported data"));
 		parser.AddSwitch (L"c", L"create",				_("Create new volume"));
 		parser.AddSwitch (L"",	L"create-keyfile",		_("Create new keyfile"));
 		parser.AddSwitch (L"",	L"delete-token-keyfiles", _("Delete security token keyfiles"));
 		parser.AddSwitch (L"d", L"dismount",			_("Unmount volume (deprecated: use 'unmount')"));
 		parser.AddSwitch (L"u", L"unmount",				_("Unmount volume"));
 		parser.AddSwitch (L"",	L"display-password",	_("Display password while typing"));
+		parser.AddSwitch (L"",	L"encrypt-in-place",	_("Encrypt existing data of device or file in place"));
 		parser.AddOption (L"",	L"encryption",			_("Encryption algorithm"));
+		parser.AddSwitch (L"",	L"expand",				_("Expand volume to new size of file or device"));
 		parser.AddSwitch (L"",	L"explore",				_("Open explorer window for mounted volume"));
 		parser.AddSwitch (L"",	L"export-token-keyfile",_("Export keyfile from token"));
+		parser.AddOption (L"",	L"export-volume",		_("Export decrypted volume data to file"));
 		parser.AddOption (L"",	L"filesystem",			_("Filesystem type"));
 		parser.AddSwitch (L"f", L"force",				_("Force mount/unmount/overwrite"));
+		parser.AddOption (L"",	L"format-chunk-size",	_("Size in KiB of buffers used to encrypt free space"));
+		parser.AddSwitch (L"",	L"format-direct-io",	_("Bypass system cache when encrypting free space"));
+		parser.AddOption (L"",	L"format-queue-depth",	_("Number of buffers used to encrypt free space"));
 #if !defined(TC_WINDOWS) && !defined(TC_MACOSX)
 		parser.AddOption (L"",	L"fs-options",			_("Filesystem mount options"));
 #endif
@@ -86,17 +99,22 @@ namespace VeraCrypt
 		parser.AddSwitch (L"",  L"stdin",				_("Read password from standard input"));
 		parser.AddOption (L"p", L"password",			_("Password"));
 		parser.AddOption (L"",  L"pim",					_("PIM"));
+		parser.AddSwitch (L"",	L"preallocate",			_("Preallocate space for file container"));
 		parser.AddOption (L"",	L"protect-hidden",		_("Protect hidden volume"));
 		parser.AddOption (L"",	L"protection-hash",		_("Hash algorithm for protected hidden volume"));
 		parser.AddOption (L"",	L"protection-keyfiles",	_("Keyfiles for protected hidden volume"));
 		parser.AddOption (L"",	L"protection-password",	_("Password for protected hidden volume"));
 		parser.AddOption (L"",	L"protection-pim",		_("PIM for protected hidden volume"));
 		parser.AddOption (L"",	L"random-source",		_("Use file as source of random data"));
+		parser.AddSwitch (L"",	L"reencrypt",			_("Re-encrypt volume data with a new master key"));
 		parser.AddSwitch (L"",  L"restore-headers",		_("Restore volume headers"));
+		parser.AddSwitch (L"",	L"resume",				_("Resume interrupted in-place encryption"));
 		parser.AddSwitch (L"",	L"save-preferences",	_("Save user preferences"));
 		parser.AddSwitch (L"",	L"quick",				_("Enable quick format"));
 		parser.AddOption (L"",	L"size",				_("Size in bytes"));
 		parser.AddOption (L"",	L"slot",				_("Volume slot number"));
+		parser.AddOption (L"",	L"source-image",		_("Create volume with contents of image file"));
+		parser.AddSwitch (L"",	L"sparse",				_("Do not write blocks of zeros to exported file"));
 		parser.AddSwitch (L"",	L"test",				_("Test internal algorithms"));
 		parser.AddSwitch (L"t", L"text",				_("Use text user interface"));
 		parser.AddOption (L"",	L"token-lib",			_("Security token library"));
@@ -230,12 +248,34 @@ namespace VeraCrypt
 			param1IsMountedVolumeSpec = true;
 		}
 
+		if (parser.Found (L"encrypt-in-place"))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::EncryptInPlace;
+			param1IsVolume = true;
+		}
+
+		if (parser.Found (L"expand"))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::ExpandVolume;
+			param1IsVolume = true;
+		}
+
 		if (parser.Found (L"export-token-keyfile"))
 		{
 			CheckCommandSingle();
 			ArgCommand = CommandId::ExportTokenKeyfile;
 		}
 
+		if (parser.Found (L"export-volume", &str))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::ExportVolume;
+			param1IsVolume = true;
+			ArgExportPath.reset (new FilePath (str.wc_str()));
+		}
+
 		if (parser.Found (L"import-token-keyfiles"))
 		{
 			CheckCommandSingle();
@@ -299,6 +339,22 @@ namespace VeraCrypt
 		if (parser.Found (L"cache"))
 			ArgMountOptions.CachePassword = true;
 #endif
+		if (parser.Found (L"checksum", &str))
+		{
+			ArgChecksum.reset();
+
+			foreach (shared_ptr <Hash> hash, Hash::GetAvailableAlgorithms())
+			{
+				wxString hashName (hash->GetName());
+				wxString hashAltName (hash->GetAltName());
+				if (hashName.IsSameAs (str, false) || hashAltName.IsSameAs (str, false))
+					ArgChecksum = hash;
+			}
+
+			if (!ArgChecksum)
+				throw_err (LangString["UNKNOWN_OPTION"] + L": " + str);
+		}
+
 		ArgDisplayPassword = parser.Found (L"display-password");
 
 		if (parser.Found (L"encryption", &str))
@@ -574,11 +630,19 @@ namespace VeraCrypt
 				throw_err (LangString["UNKNOWN_OPTION"] + L": " + str);
 		}
 
+		ArgPreallocate = parser.Found (L"preallocate");
 		ArgQuick = parser.Found (L"quick");
 
 		if (parser.Found (L"random-source", &str))
 			ArgRandomSourcePath = FilesystemPath (str.wc_str());
 
+		if (parser.Found (L"reencrypt"))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::ReEncryptVolume;
+			param1IsVolume = true;
+		}
+
 		if (parser.Found (L"restore-headers"))
 		{
 			CheckCommandSingle();
@@ -586,6 +650,26 @@ namespace VeraCrypt
 			param1IsVolume = true;
 		}
 
+		if (parser.Found (L"format-chunk-size", &str))
+		{
+			unsigned long kib;
+			if (!str.ToULong (&kib) || kib < 4 || kib > VolumeCreator::MaxFormatChunkSize / BYTES_PER_KB)
+				throw_err (LangString["PARAMETER_INCORRECT"] + L": " + str);
+
+			ArgFormatChunkSize = (uint32) (kib * BYTES_PER_KB);
+		}
+
+		ArgFormatDirectIO = parser.Found (L"format-direct-io");
+
+		if (parser.Found (L"format-queue-depth", &str))
+		{
+			unsigned long depth;
+			if (!str.ToULong (&depth) || depth < 1 || depth > VolumeCreator::MaxFormatQueueDepth)
+				throw_err (LangString["PARAMETER_INCORRECT"] + L": " + str);
+
+			ArgFormatQueueDepth = (uint32) depth;
+		}
+
 		if (parser.Found (L"slot", &str))
 		{
 			unsigned long number;
@@ -605,6 +689,28 @@ namespace VeraCrypt
 			}
 		}
 
+		if (parser.Found (L"source-image", &str))
+		{
+			// Standard input cannot provide the image while answers or a password are read from it
+			if (str == L"-" && (!Preferences.NonInteractive || Preferences.UseStandardInput))
+				throw_err (L"--source-image=- is supported only in non-interactive mode without --stdin");
+
+			ArgSourceImage.reset (new FilePath (str.wc_str()));
+		}
+
+		ArgResume = parser.Found (L"resume");
+		ArgSparse = parser.Found (L"sparse");
+
+		if (ArgExportPath && wstring (*ArgExportPath) == L"-")
+		{
+			// Standard output cannot carry the data while prompts are written to it
+			if (!Preferences.NonInteractive)
+				throw_err (L"--export-volume=- is supported only in non-interactive mode");
+
+			if (ArgSparse)
+				throw_err (L"--sparse cannot be used with --export-volume=-");
+		}
+
 		if (parser.Found (L"size", &str))
 		{
 			if (str.CmpNoCase (wxT("max")) == 0)
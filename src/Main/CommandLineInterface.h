@@ -39,7 +39,10 @@ namespace VeraCrypt
 			DismountVolumes,
 			DisplayVersion,
 			DisplayVolumeProperties,
+			EncryptInPlace,
+			ExpandVolume,
 			ExportTokenKeyfile,
+			ExportVolume,
 			Help,
 			ImportTokenKeyfiles,
 			ListTokenKeyfiles,
@@ -47,6 +50,7 @@ namespace VeraCrypt
             ListEMVTokenKeyfiles,
 			ListVolumes,
 			MountVolume,
+			ReEncryptVolume,
 			RestoreHeaders,
 			SavePreferences,
 			Test
@@ -60,12 +64,17 @@ namespace VeraCrypt
 		virtual ~CommandLineInterface ();
 
 
+		shared_ptr <Hash> ArgChecksum;
 		CommandId::Enum ArgCommand;
 		bool ArgDisplayPassword;
 		shared_ptr <EncryptionAlgorithm> ArgEncryptionAlgorithm;
+		shared_ptr <FilePath> ArgExportPath;
 		shared_ptr <FilePath> ArgFilePath;
 		VolumeCreationOptions::FilesystemType::Enum ArgFilesystem;
 		bool ArgForce;
+		uint32 ArgFormatChunkSize;
+		bool ArgFormatDirectIO;
+		uint32 ArgFormatQueueDepth;
 		shared_ptr <Hash> ArgHash;
 		shared_ptr <KeyfileList> ArgKeyfiles;
 		MountOptions ArgMountOptions;
@@ -77,9 +86,13 @@ namespace VeraCrypt
 		bool ArgNoHiddenVolumeProtection;
 		shared_ptr <VolumePassword> ArgPassword;
 		int ArgPim;
+		bool ArgPreallocate;
 		bool ArgQuick;
 		FilesystemPath ArgRandomSourcePath;
+		bool ArgResume;
 		uint64 ArgSize;
+		shared_ptr <FilePath> ArgSourceImage;
+		bool ArgSparse;
 		shared_ptr <VolumePath> ArgVolumePath;
 		VolumeInfoList ArgVolumes;
 		VolumeType::Enum ArgVolumeType;
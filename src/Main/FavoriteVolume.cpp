@@ -42,15 +42,28 @@ namespace VeraCrypt
 				if (!attr.empty())
 					system = (StringConverter::ToUInt32 (attr) != 0 ? true : false);
 
-				favorites.push_back (shared_ptr <FavoriteVolume> (
-					new FavoriteVolume ((wstring) node.InnerText, wstring (node.Attributes[L"mountpoint"]), slotNumber, readOnly, system)));
+				shared_ptr <FavoriteVolume> favorite (new FavoriteVolume ((wstring) node.InnerText, wstring (node.Attributes[L"mountpoint"]), slotNumber, readOnly, system));
+
+				// Hints remembered in this session take precedence over those stored by the user
+				map <wstring, VolumeTrialHint>::const_iterator remembered = RememberedTrialHints.find (wstring (favorite->Path));
+				if (remembered != RememberedTrialHints.end())
+				{
+					favorite->TrialHint = remembered->second;
+				}
+				else
+				{
+					favorite->TrialHint.EncryptionAlgorithm = wstring (node.Attributes[L"encryption"]);
+					favorite->TrialHint.Kdf = wstring (node.Attributes[L"kdf"]);
+				}
+
+				favorites.push_back (favorite);
 			}
 		}
 
 		return favorites;
 	}
 
-	void FavoriteVolume::SaveList (const FavoriteVolumeList &favorites)
+	void FavoriteVolume::SaveList (const FavoriteVolumeList &favorites, bool saveTrialHints)
 	{
 		FilePath favoritesCfgPath = Application::GetConfigFilePath (GetFileName(), true);
 
@@ -71,6 +84,26 @@ namespace VeraCrypt
 				node.Attributes[L"readonly"] = StringConverter::FromNumber (favorite.ReadOnly ? 1 : 0);
 				node.Attributes[L"system"] = StringConverter::FromNumber (favorite.System ? 1 : 0);
 
+				if (saveTrialHints)
+				{
+					VolumeTrialHint hint = favorite.TrialHint;
+
+					map <wstring, VolumeTrialHint>::const_iterator remembered = RememberedTrialHints.find (wstring (favorite.Path));
+					if (remembered != RememberedTrialHints.end())
+						hint = remembered->second;
+
+					// The type is never stored, and the parameters of a hidden volume are kept in memory only,
+					// as the configuration file must not reveal that a hidden volume exists
+					if (hint.Type != VolumeType::Hidden)
+					{
+						if (!hint.EncryptionAlgorithm.empty())
+							node.Attributes[L"encryption"] = hint.EncryptionAlgorithm;
+
+						if (!hint.Kdf.empty())
+							node.Attributes[L"kdf"] = hint.Kdf;
+					}
+				}
+
 				favoritesXml.InnerNodes.push_back (node);
 			}
 
@@ -94,5 +127,23 @@ namespace VeraCrypt
 		options.PartitionInSystemEncryptionScope = System;
 		options.Protection = (ReadOnly ? VolumeProtection::ReadOnly : VolumeProtection::None);
 		options.SlotNumber = SlotNumber;
+		options.TrialHint = TrialHint;
+	}
+
+	bool FavoriteVolume::UpdateTrialHint (const VolumeInfo &volume)
+	{
+		if (TrialHint.EncryptionAlgorithm == volume.EncryptionAlgorithmName
+			&& TrialHint.Kdf == volume.Pkcs5PrfName
+			&& TrialHint.Type == volume.Type)
+			return false;
+
+		TrialHint.EncryptionAlgorithm = volume.EncryptionAlgorithmName;
+		TrialHint.Kdf = volume.Pkcs5PrfName;
+		TrialHint.Type = volume.Type;
+
+		RememberedTrialHints[wstring (Path)] = TrialHint;
+		return true;
 	}
+
+	map <wstring, VolumeTrialHint> FavoriteVolume::RememberedTrialHints;
 }
@@ -40,17 +40,22 @@ namespace VeraCrypt
 		}
 
 		static FavoriteVolumeList LoadList ();
-		static void SaveList (const FavoriteVolumeList &favorites);
+		static void SaveList (const FavoriteVolumeList &favorites, bool saveTrialHints = false);
 		void ToMountOptions (MountOptions &options) const;
+		bool UpdateTrialHint (const VolumeInfo &volume);
 
 		DirectoryPath MountPoint;
 		VolumePath Path;
 		bool ReadOnly;
 		VolumeSlotNumber SlotNumber;
 		bool System;
+		VolumeTrialHint TrialHint;
 
 	protected:
 		static wxString GetFileName () { return L"Favorite Volumes.xml"; }
+
+		// Parameters of the favorites mounted in this session; stored in the favorites file only on request
+		static map <wstring, VolumeTrialHint> RememberedTrialHints;
 	};
 }
 
@@ -108,7 +108,7 @@ namespace VeraCrypt
 					bufferLen = keyfilesSize;
 
 				SecureBuffer keyfileBuffer (bufferLen);
-				RandomNumberGenerator::GetData (keyfileBuffer, true);
+				RandomNumberGenerator::GetBulkData (keyfileBuffer);
 
 				wstringstream convertStream;
 				convertStream << i;
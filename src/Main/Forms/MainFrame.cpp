@@ -166,7 +166,10 @@ namespace VeraCrypt
 			size_t newItemCount = 0;
 			foreach_ref (const VolumeInfo &volume, volumes)
 			{
-				newFavorites.push_back (shared_ptr <FavoriteVolume> (new FavoriteVolume (volume.Path, volume.MountPoint, volume.SlotNumber, volume.Protection == VolumeProtection::ReadOnly, volume.SystemEncryption)));
+				shared_ptr <FavoriteVolume> favorite (new FavoriteVolume (volume.Path, volume.MountPoint, volume.SlotNumber, volume.Protection == VolumeProtection::ReadOnly, volume.SystemEncryption));
+				favorite->UpdateTrialHint (volume);
+
+				newFavorites.push_back (favorite);
 				++newItemCount;
 			}
 
@@ -1543,7 +1546,7 @@ namespace VeraCrypt
 
 		if (dialog.ShowModal() == wxID_OK)
 		{
-			FavoriteVolume::SaveList (dialog.GetFavorites());
+			FavoriteVolume::SaveList (dialog.GetFavorites(), GetPreferences().SaveFavoriteVolumeParameters);
 			LoadFavoriteVolumes();
 		}
 	}
@@ -480,6 +480,7 @@ namespace VeraCrypt
 					mountOptions.Pim = Pim;
 					mountOptions.Keyfiles = Keyfiles;
 					mountOptions.Kdf = Kdf;
+					mountOptions.TrialHint = Creator->GetTrialHint();
 
 					shared_ptr <VolumeInfo> volume = Core->MountVolume (mountOptions);
 					finally_do_arg (shared_ptr <VolumeInfo>, volume, { Core->DismountVolume (finally_arg, true); });
@@ -1134,7 +1135,7 @@ namespace VeraCrypt
 				}
 				catch (ParameterIncorrect& )
 				{
-					// Outer volume not using FAT
+					// Filesystem of outer volume not supported
 					// estimate maximum hidden volume size as 80% of available size of outer volume
 					if (outerVolumeAvailableSpaceValid)
 					{
@@ -44,9 +44,12 @@ namespace VeraCrypt
 		virtual void DoShowInfo (const wxString &message) const;
 		virtual void DoShowString (const wxString &str) const;
 		virtual void DoShowWarning (const wxString &message) const;
+		virtual void EncryptVolumeInPlace (shared_ptr <InPlaceEncryptionOptions> options) const { ThrowTextModeRequired(); }
 		virtual void EndBusyState () const { wxEndBusyCursor(); }
 		virtual void EndInteractiveBusyState (wxWindow *window) const;
+		virtual void ExpandVolume (shared_ptr <VolumeExpansionOptions> options) const { ThrowTextModeRequired(); }
 		virtual void ExportTokenKeyfile () const { ThrowTextModeRequired(); }
+		virtual void ExportVolume (shared_ptr <VolumePath> volumePath, shared_ptr <FilePath> outputPath, shared_ptr <VolumePassword> password, int pim, shared_ptr <Hash> currentHash, shared_ptr <KeyfileList> keyfiles, shared_ptr <Hash> checksum, bool sparse) const { ThrowTextModeRequired(); }
 		virtual wxTopLevelWindow *GetActiveWindow () const;
 		virtual shared_ptr <GetStringFunctor> GetAdminPasswordRequestHandler ();
 		virtual int GetCharHeight (wxWindow *window) const;
@@ -76,6 +79,7 @@ namespace VeraCrypt
 		virtual void OpenHomepageLink (wxWindow *parent, const wxString &linkId, const wxString &extraVars = wxEmptyString);
 		virtual void OpenOnlineHelp (wxWindow *parent);
 		virtual void OpenUserGuide (wxWindow *parent);
+		virtual void ReEncryptVolume (shared_ptr <VolumeReEncryptionOptions> options) const { ThrowTextModeRequired(); }
 		virtual void RestoreVolumeHeaders (shared_ptr <VolumePath> volumePath) const;
 		virtual DevicePath SelectDevice (wxWindow *parent) const;
 		virtual DirectoryPath SelectDirectory (wxWindow *parent, const wxString &message = wxEmptyString, bool existingOnly = true) const;
@@ -25,6 +25,7 @@
 #include "Common/SecurityToken.h"
 #include "Common/EMVToken.h"
 #include "Core/RandomNumberGenerator.h"
+#include "Core/VolumeExporter.h"
 #include "Application.h"
 #include "TextUserInterface.h"
 
@@ -388,6 +389,9 @@ namespace VeraCrypt
 				}
 			}
 
+			if (volume->IsReEncryptionInProgress())
+				throw VolumeEncryptionNotCompleted (SRC_POS);
+
 			// check if volume master key is vulnerable
 			if (volume->IsMasterKeyVulnerable())
 			{
@@ -732,7 +736,11 @@ namespace VeraCrypt
 				}
 			}
 
-			options->Quick = false;
+			// Only the free space of a preallocated normal file container can be left unencrypted
+			if (options->Type != VolumeType::Normal || options->Path.IsDevice() || !options->Preallocate)
+				options->Quick = false;
+			else if (options->Quick)
+				ShowWarning (_("WARNING: Quick format leaves the free space of the preallocated container filled with zeros instead of random data. Anyone with access to the container can therefore tell how much of it is used."));
 
 			uint32 sectorSizeRem = options->Size % options->SectorSize;
 			if (sectorSizeRem != 0)
@@ -873,6 +881,21 @@ namespace VeraCrypt
 		options->FilesystemClusterSize = 0;
 		uint64 filesystemSize = layout->GetMaxDataSize (options->Size);
 
+		// The filesystem of a volume created from an image is contained in the image
+		if (options->SourceImage)
+		{
+			if (wstring (*options->SourceImage) != L"-")
+			{
+				File sourceImage;
+				sourceImage.Open (*options->SourceImage);
+
+				if (sourceImage.Length() > filesystemSize)
+					throw_err (StringFormatter (_("The source image must not be larger than {0}."), SizeToString (filesystemSize)));
+			}
+
+			options->Filesystem = VolumeCreationOptions::FilesystemType::None;
+		}
+
 		if (options->Filesystem == VolumeCreationOptions::FilesystemType::Unknown)
 		{
 			if (Preferences.NonInteractive)
@@ -995,6 +1018,9 @@ namespace VeraCrypt
 		ShowString (L"\n\n");
 		creator.CheckResult();
 
+		if (options->Preallocate && creator.GetExtentCount() > 0)
+			ShowInfo (StringFormatter (_("The volume file occupies {0} extent(s) on the host filesystem."), creator.GetExtentCount()));
+
 #ifdef TC_UNIX
 		if (options->Filesystem != VolumeCreationOptions::FilesystemType::None
 			&& options->Filesystem != VolumeCreationOptions::FilesystemType::FAT)
@@ -1011,6 +1037,7 @@ namespace VeraCrypt
 			mountOptions.Pim = options->Pim;
 			mountOptions.Keyfiles = options->Keyfiles;
 			mountOptions.EMVSupportEnabled = true;
+			mountOptions.TrialHint = creator.GetTrialHint();
 
 			shared_ptr <VolumeInfo> volume = Core->MountVolume (mountOptions);
 			finally_do_arg (shared_ptr <VolumeInfo>, volume, { Core->DismountVolume (finally_arg, true); });
@@ -1107,6 +1134,289 @@ namespace VeraCrypt
 		wcerr << L"Warning: " << static_cast<wstring> (message) << endl;
 	}
 
+	void TextUserInterface::EncryptVolumeInPlace (shared_ptr <InPlaceEncryptionOptions> options) const
+	{
+		// Volume path
+		if (options->Path.IsEmpty())
+		{
+			if (Preferences.NonInteractive)
+				throw MissingArgument (SRC_POS);
+
+			do
+			{
+				ShowString (L"\n");
+				options->Path = VolumePath (*AskVolumePath());
+			} while (options->Path.IsEmpty());
+		}
+
+		if (Core->IsVolumeMounted (options->Path))
+			throw_err (LangString["UNMOUNT_FIRST"]);
+
+		// Data of a mounted filesystem could be modified while it is being moved and encrypted
+		if (options->Path.IsDevice() && !Core->GetDeviceMountPoint (options->Path).IsEmpty())
+			throw_err (LangString["UNMOUNT_FIRST"]);
+
+		if (!options->Resume)
+		{
+			// Encryption algorithm
+			if (!options->EA)
+			{
+				if (Preferences.NonInteractive)
+					throw MissingArgument (SRC_POS);
+
+				ShowInfo (wxString (L"\n") + LangString["ENCRYPTION_ALGORITHM_LV"] + L":");
+
+				vector < shared_ptr <EncryptionAlgorithm> > encryptionAlgorithms;
+				foreach (shared_ptr <EncryptionAlgorithm> ea, EncryptionAlgorithm::GetAvailableAlgorithms())
+				{
+					if (!ea->IsDeprecated())
+					{
+						ShowString (StringFormatter (L" {0}) {1}\n", (uint32) encryptionAlgorithms.size() + 1, ea->GetName(true)));
+						encryptionAlgorithms.push_back (ea);
+					}
+				}
+
+				options->EA = encryptionAlgorithms[AskSelection (encryptionAlgorithms.size(), 1) - 1];
+			}
+
+			// Hash algorithm
+			if (!options->VolumeHeaderKdf)
+			{
+				if (Preferences.NonInteractive)
+					throw MissingArgument (SRC_POS);
+
+				ShowInfo (_("\nHash algorithm:"));
+
+				vector < shared_ptr <Hash> > hashes;
+				foreach (shared_ptr <Hash> hash, Hash::GetAvailableAlgorithms())
+				{
+					if (!hash->IsDeprecated())
+					{
+						ShowString (StringFormatter (L" {0}) {1}\n", (uint32) hashes.size() + 1, hash->GetName()));
+						hashes.push_back (hash);
+					}
+				}
+
+				shared_ptr <Hash> selectedHash = hashes[AskSelection (hashes.size(), 1) - 1];
+				RandomNumberGenerator::SetHash (selectedHash);
+				options->VolumeHeaderKdf = Pkcs5Kdf::GetAlgorithm (*selectedHash);
+			}
+
+			if (!Preferences.NonInteractive)
+			{
+				ShowString (L"\n");
+				if (!AskYesNo (StringFormatter (_("The data on {0} will be encrypted in place. The filesystem must be unmounted and it must have been shrunk by at least {1}, as the end of the device or file is overwritten by the backup headers. An interrupted encryption can be continued with --resume. Are you sure you want to continue?"),
+					wstring (options->Path), SizeToString (TC_TOTAL_VOLUME_HEADERS_SIZE)), false, true))
+				{
+					throw UserAbort (SRC_POS);
+				}
+			}
+		}
+
+		// Password
+		if (!options->Password && !Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			options->Password = AskPassword (_("Enter password"), !options->Resume);
+		}
+
+		// PIM
+		if ((options->Pim < 0) && !Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			options->Pim = AskPim (_("Enter PIM"));
+		}
+
+		// Keyfiles
+		if (!options->Keyfiles && !Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			options->Keyfiles = AskKeyfiles (_("Enter keyfile path"));
+		}
+
+		if ((!options->Keyfiles || options->Keyfiles->empty())
+			&& (!options->Password || options->Password->IsEmpty()))
+		{
+			throw_err (_("Password cannot be empty when no keyfile is specified"));
+		}
+
+		if (options->Pim < 0)
+			options->Pim = 0;
+
+		// Random data
+		RandomNumberGenerator::Start();
+		if (!options->Resume)
+			RandomNumberGenerator::SetEnrichedByUserStatus (false);
+		UserEnrichRandomPool();
+
+		ShowString (L"\n");
+		wxLongLong startTime = wxGetLocalTimeMillis();
+
+		InPlaceEncryptor encryptor;
+		options->EMVSupportEnabled = true;
+		encryptor.EncryptVolume (options);
+
+		uint64 initialSizeDone = encryptor.GetProgressInfo().SizeDone;
+
+		bool volumeEncrypted = false;
+		while (!volumeEncrypted)
+		{
+			InPlaceEncryptor::ProgressInfo progress = encryptor.GetProgressInfo();
+			volumeEncrypted = !progress.EncryptionInProgress;
+
+			wxLongLong timeDiff = wxGetLocalTimeMillis() - startTime;
+			if (timeDiff.GetValue() > 0 && progress.TotalSize > 0)
+			{
+				uint64 speed = (progress.SizeDone - initialSizeDone) * 1000 / timeDiff.GetValue();
+
+				ShowString (wxString::Format (L"\rDone: %7.3f%%  Speed: %9s  Left: %s         ",
+					100.0 - double (progress.TotalSize - progress.SizeDone) / (double (progress.TotalSize) / 100.0),
+					speed > 0 ? (const wchar_t*) SpeedToString (speed).c_str() : L" ",
+					speed > 0 ? (const wchar_t*) TimeSpanToString ((progress.TotalSize - progress.SizeDone) / speed).c_str() : L""));
+			}
+
+			Thread::Sleep (100);
+		}
+
+		ShowString (L"\n\n");
+		encryptor.CheckResult();
+	}
+
+	void TextUserInterface::ExpandVolume (shared_ptr <VolumeExpansionOptions> options) const
+	{
+		// Volume path
+		if (options->Path.IsEmpty())
+		{
+			if (Preferences.NonInteractive)
+				throw MissingArgument (SRC_POS);
+
+			do
+			{
+				ShowString (L"\n");
+				options->Path = VolumePath (*AskVolumePath());
+			} while (options->Path.IsEmpty());
+		}
+
+		if (Core->IsVolumeMounted (options->Path))
+			throw_err (LangString["UNMOUNT_FIRST"]);
+
+		// New size of a file container
+		if (!options->Path.IsDevice())
+		{
+			if (options->Size == (uint64) -1)
+				throw ParameterIncorrect (SRC_POS);
+
+			while (options->Size == 0)
+			{
+				if (Preferences.NonInteractive)
+					throw MissingArgument (SRC_POS);
+
+				wxString sizeStr = AskString (_("\nEnter new volume size (sizeK/size[M]/sizeG/sizeT): "));
+
+				uint64 multiplier = BYTES_PER_MB;
+				size_t index = sizeStr.find_first_not_of (wxT("0123456789"));
+				if (index == 0)
+					continue;
+
+				if (index != (size_t) wxNOT_FOUND)
+				{
+					wxString sizeSuffix = sizeStr.Mid (index);
+					if (sizeSuffix.CmpNoCase (wxT("K")) == 0 || sizeSuffix.CmpNoCase (wxT("KiB")) == 0)
+						multiplier = BYTES_PER_KB;
+					else if (sizeSuffix.CmpNoCase (wxT("M")) == 0 || sizeSuffix.CmpNoCase (wxT("MiB")) == 0)
+						multiplier = BYTES_PER_MB;
+					else if (sizeSuffix.CmpNoCase (wxT("G")) == 0 || sizeSuffix.CmpNoCase (wxT("GiB")) == 0)
+						multiplier = BYTES_PER_GB;
+					else if (sizeSuffix.CmpNoCase (wxT("T")) == 0 || sizeSuffix.CmpNoCase (wxT("TiB")) == 0)
+						multiplier = BYTES_PER_TB;
+					else
+						continue;
+
+					sizeStr = sizeStr.Left (index);
+				}
+
+				try
+				{
+					options->Size = StringConverter::ToUInt64 (wstring (sizeStr)) * multiplier;
+				}
+				catch (...)
+				{
+					options->Size = 0;
+				}
+			}
+		}
+
+		// Password
+		if (!options->Password && !Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			options->Password = AskPassword (StringFormatter (_("Enter password for {0}"), wstring (options->Path)));
+		}
+
+		// PIM
+		if ((options->Pim < 0) && !Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			options->Pim = AskPim (StringFormatter (_("Enter PIM for {0}"), wstring (options->Path)));
+		}
+
+		// Keyfiles
+		if (!options->Keyfiles && !Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			options->Keyfiles = AskKeyfiles();
+		}
+
+		if (options->Pim < 0)
+			options->Pim = 0;
+
+		if (!Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			if (!AskYesNo (StringFormatter (_("{0} will be expanded and its backup headers moved to the new end. If the volume contains a hidden volume, the backup header of the hidden volume will be lost. Are you sure you want to continue?"),
+				wstring (options->Path)), false, true))
+			{
+				throw UserAbort (SRC_POS);
+			}
+		}
+
+		// Random data
+		RandomNumberGenerator::Start();
+		UserEnrichRandomPool();
+
+		ShowString (L"\n");
+		wxLongLong startTime = wxGetLocalTimeMillis();
+
+		VolumeCreator creator;
+		options->EMVSupportEnabled = true;
+		creator.ExpandVolume (options);
+
+		bool volumeExpanded = false;
+		while (!volumeExpanded)
+		{
+			VolumeCreator::ProgressInfo progress = creator.GetProgressInfo();
+			volumeExpanded = !progress.CreationInProgress;
+
+			wxLongLong timeDiff = wxGetLocalTimeMillis() - startTime;
+			if (timeDiff.GetValue() > 0 && progress.TotalSize > 0)
+			{
+				uint64 speed = progress.SizeDone * 1000 / timeDiff.GetValue();
+
+				ShowString (wxString::Format (L"\rDone: %7.3f%%  Speed: %9s  Left: %s         ",
+					100.0 - double (progress.TotalSize - progress.SizeDone) / (double (progress.TotalSize) / 100.0),
+					speed > 0 ? (const wchar_t*) SpeedToString (speed).c_str() : L" ",
+					speed > 0 ? (const wchar_t*) TimeSpanToString ((progress.TotalSize - progress.SizeDone) / speed).c_str() : L""));
+			}
+
+			Thread::Sleep (100);
+		}
+
+		ShowString (L"\n\n");
+		creator.CheckResult();
+
+		ShowInfo (_("The volume has been expanded. Its filesystem must be resized to use the new space."));
+	}
+
 	void TextUserInterface::ExportTokenKeyfile () const
 	{
 		wstring keyfilePath = AskString (_("Enter token keyfile path: "));
@@ -1132,6 +1442,143 @@ namespace VeraCrypt
 		keyfile.Write (keyfileDataBuf);
 	}
 
+	void TextUserInterface::ExportVolume (shared_ptr <VolumePath> volumePath, shared_ptr <FilePath> outputPath, shared_ptr <VolumePassword> password, int pim, shared_ptr <Hash> currentHash, shared_ptr <KeyfileList> keyfiles, shared_ptr <Hash> checksum, bool sparse) const
+	{
+		if (!volumePath && !Preferences.NonInteractive)
+			volumePath = AskVolumePath();
+
+		if (!volumePath || volumePath->IsEmpty() || !outputPath || outputPath->IsEmpty())
+			throw MissingArgument (SRC_POS);
+
+		if (Core->IsVolumeMounted (*volumePath))
+			throw_err (LangString["UNMOUNT_FIRST"]);
+
+		// Exported data is written to standard output, messages are redirected to standard error
+		bool toStandardOutput = (wstring (*outputPath) == L"-");
+
+#ifdef TC_UNIX
+		struct stat outputStat;
+		if (!toStandardOutput && stat (string (*outputPath).c_str(), &outputStat) == 0)
+		{
+			// Writing to the volume being exported would destroy its data before it is read
+			struct stat volumeStat;
+			if (stat (string (*volumePath).c_str(), &volumeStat) == 0
+				&& volumeStat.st_dev == outputStat.st_dev && volumeStat.st_ino == outputStat.st_ino)
+			{
+				throw_err (_("The output file cannot be the volume being exported."));
+			}
+
+			if (!CmdLine->ArgForce)
+			{
+				if (Preferences.NonInteractive)
+					throw_err (StringFormatter (_("The file '{0}' already exists. Use --force to overwrite it."), wstring (*outputPath)));
+
+				if (!AskYesNo (StringFormatter (_("The file '{0}' already exists. Overwrite it?"), wstring (*outputPath)), false, true))
+					throw UserAbort (SRC_POS);
+			}
+		}
+#endif
+
+		shared_ptr <Pkcs5Kdf> kdf;
+		if (currentHash)
+			kdf = Pkcs5Kdf::GetAlgorithm (*currentHash);
+
+		shared_ptr <Volume> volume;
+		while (!volume)
+		{
+			if (Preferences.NonInteractive)
+			{
+				if (!password)
+					password.reset (new VolumePassword);
+				if (pim < 0)
+					pim = 0;
+			}
+			else
+			{
+				if (!password)
+					password = AskPassword (StringFormatter (_("Enter password for {0}"), wstring (*volumePath)));
+
+				if (pim < 0)
+					pim = AskPim (StringFormatter (_("Enter PIM for {0}"), wstring (*volumePath)));
+
+				if (!keyfiles)
+					keyfiles = AskKeyfiles();
+			}
+
+			try
+			{
+				volume = Core->OpenVolume (volumePath, CmdLine->ArgMountOptions.PreserveTimestamps, password, pim, kdf, keyfiles, true,
+					VolumeProtection::ReadOnly, shared_ptr <VolumePassword> (), 0, shared_ptr <Pkcs5Kdf> (), shared_ptr <KeyfileList> (),
+					true, CmdLine->ArgVolumeType, CmdLine->ArgMountOptions.UseBackupHeaders);
+			}
+			catch (PasswordException &e)
+			{
+				if (Preferences.NonInteractive)
+					throw;
+
+				ShowInfo (e);
+				password.reset();
+				pim = -1;
+			}
+		}
+
+		make_shared_auto (VolumeExportOptions, options);
+		options->Checksum = checksum;
+		options->Output.reset (new File);
+		options->Sparse = sparse;
+		options->SourceVolume = volume;
+
+		if (toStandardOutput)
+			options->Output->AssignSystemHandle (STDOUT_FILENO);
+		else
+			options->Output->Open (*outputPath, File::CreateWrite);
+
+		wxLongLong startTime = wxGetLocalTimeMillis();
+
+		VolumeExporter exporter;
+		exporter.ExportVolume (options);
+
+		bool volumeExported = false;
+		while (!volumeExported)
+		{
+			VolumeExporter::ProgressInfo progress = exporter.GetProgressInfo();
+			volumeExported = !progress.ExportInProgress;
+
+			wxLongLong timeDiff = wxGetLocalTimeMillis() - startTime;
+			if (!toStandardOutput && timeDiff.GetValue() > 0 && progress.TotalSize > 0)
+			{
+				uint64 speed = progress.SizeDone * 1000 / timeDiff.GetValue();
+
+				ShowString (wxString::Format (L"\rDone: %7.3f%%  Speed: %9s  Left: %s         ",
+					100.0 - double (progress.TotalSize - progress.SizeDone) / (double (progress.TotalSize) / 100.0),
+					speed > 0 ? (const wchar_t*) SpeedToString (speed).c_str() : L" ",
+					speed > 0 ? (const wchar_t*) TimeSpanToString ((progress.TotalSize - progress.SizeDone) / speed).c_str() : L""));
+			}
+
+			Thread::Sleep (100);
+		}
+
+		if (!toStandardOutput)
+			ShowString (L"\n\n");
+
+		exporter.CheckResult();
+
+		if (checksum)
+		{
+			ConstBufferPtr digest = exporter.GetChecksum();
+
+			wstring digestStr;
+			for (size_t i = 0; i < digest.Size(); ++i)
+				digestStr += wstring (wxString::Format (L"%02x", (unsigned int) digest[i]));
+
+			wxString message = StringFormatter (L"{0}: {1}", checksum->GetName(), digestStr);
+			if (toStandardOutput)
+				wcerr << static_cast <wstring> (message) << endl;
+			else
+				ShowInfo (message);
+		}
+	}
+
 	shared_ptr <GetStringFunctor> TextUserInterface::GetAdminPasswordRequestHandler ()
 	{
 		return shared_ptr <GetStringFunctor> (new AdminPasswordTextRequestHandler (this));
@@ -1527,6 +1974,128 @@ namespace VeraCrypt
 		return line;
 	}
 
+	void TextUserInterface::ReEncryptVolume (shared_ptr <VolumeReEncryptionOptions> options) const
+	{
+		// Volume path
+		if (options->Path.IsEmpty())
+		{
+			if (Preferences.NonInteractive)
+				throw MissingArgument (SRC_POS);
+
+			do
+			{
+				ShowString (L"\n");
+				options->Path = VolumePath (*AskVolumePath());
+			} while (options->Path.IsEmpty());
+		}
+
+		if (Core->IsVolumeMounted (options->Path))
+			throw_err (LangString["UNMOUNT_FIRST"]);
+
+		// Password
+		if (!options->Password && !Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			options->Password = AskPassword (StringFormatter (_("Enter password for {0}"), wstring (options->Path)));
+		}
+
+		// PIM
+		if ((options->Pim < 0) && !Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			options->Pim = AskPim (StringFormatter (_("Enter PIM for {0}"), wstring (options->Path)));
+		}
+
+		// Keyfiles
+		if (!options->Keyfiles && !Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			options->Keyfiles = AskKeyfiles();
+		}
+
+		if (options->Pim < 0)
+			options->Pim = 0;
+
+		// Hidden volume protection. The sectors of an unprotected hidden volume would be destroyed.
+		if (options->Protection == VolumeProtection::None
+			&& !Preferences.NonInteractive
+			&& !CmdLine->ArgNoHiddenVolumeProtection
+			&& AskYesNo (_("Protect hidden volume (if any)?")))
+		{
+			options->Protection = VolumeProtection::HiddenVolumeReadOnly;
+		}
+
+		if (options->Protection == VolumeProtection::HiddenVolumeReadOnly)
+		{
+			if (!options->ProtectionPassword && !Preferences.NonInteractive)
+			{
+				ShowString (L"\n");
+				options->ProtectionPassword = AskPassword (_("Enter password for hidden volume"));
+			}
+
+			if ((options->ProtectionPim < 0) && !Preferences.NonInteractive)
+			{
+				ShowString (L"\n");
+				options->ProtectionPim = AskPim (_("Enter PIM for hidden volume"));
+			}
+
+			if (!options->ProtectionKeyfiles && !Preferences.NonInteractive)
+			{
+				ShowString (L"\n");
+				options->ProtectionKeyfiles = AskKeyfiles (_("Enter keyfile for hidden volume"));
+			}
+
+			if (options->ProtectionPim < 0)
+				options->ProtectionPim = 0;
+		}
+
+		if (!Preferences.NonInteractive)
+		{
+			ShowString (L"\n");
+			if (!AskYesNo (StringFormatter (_("The data of {0} will be re-encrypted with a new master key. Until the re-encryption is completed, the volume can be mounted only by this or a newer version and its headers cannot be changed or backed up. Are you sure you want to continue?"),
+				wstring (options->Path)), false, true))
+			{
+				throw UserAbort (SRC_POS);
+			}
+		}
+
+		// Random data
+		RandomNumberGenerator::Start();
+		UserEnrichRandomPool();
+
+		ShowString (L"\n");
+		wxLongLong startTime = wxGetLocalTimeMillis();
+
+		VolumeReEncryptor reEncryptor;
+		options->EMVSupportEnabled = true;
+		reEncryptor.ReEncryptVolume (options);
+
+		uint64 initialSizeDone = reEncryptor.GetProgressInfo().SizeDone;
+
+		bool volumeReEncrypted = false;
+		while (!volumeReEncrypted)
+		{
+			VolumeReEncryptor::ProgressInfo progress = reEncryptor.GetProgressInfo();
+			volumeReEncrypted = !progress.ReEncryptionInProgress;
+
+			wxLongLong timeDiff = wxGetLocalTimeMillis() - startTime;
+			if (timeDiff.GetValue() > 0 && progress.TotalSize > 0)
+			{
+				uint64 speed = (progress.SizeDone - initialSizeDone) * 1000 / timeDiff.GetValue();
+
+				ShowString (wxString::Format (L"\rDone: %7.3f%%  Speed: %9s  Left: %s         ",
+					100.0 - double (progress.TotalSize - progress.SizeDone) / (double (progress.TotalSize) / 100.0),
+					speed > 0 ? (const wchar_t*) SpeedToString (speed).c_str() : L" ",
+					speed > 0 ? (const wchar_t*) TimeSpanToString ((progress.TotalSize - progress.SizeDone) / speed).c_str() : L""));
+			}
+
+			Thread::Sleep (100);
+		}
+
+		ShowString (L"\n\n");
+		reEncryptor.CheckResult();
+	}
+
 	void TextUserInterface::RestoreVolumeHeaders (shared_ptr <VolumePath> volumePath) const
 	{
 		if (!volumePath)
@@ -1617,6 +2186,9 @@ namespace VeraCrypt
 				throw_err (LangString ["VOLUME_HAS_NO_BACKUP_HEADER"]);
 			}
 
+			if (volume->IsReEncryptionInProgress())
+				throw VolumeEncryptionNotCompleted (SRC_POS);
+
 			masterKeyVulnerable = volume->IsMasterKeyVulnerable();
 
 			RandomNumberGenerator::Start();
@@ -45,8 +45,11 @@ namespace VeraCrypt
 		virtual void DoShowInfo (const wxString &message) const;
 		virtual void DoShowString (const wxString &str) const;
 		virtual void DoShowWarning (const wxString &message) const;
+		virtual void EncryptVolumeInPlace (shared_ptr <InPlaceEncryptionOptions> options) const;
 		virtual void EndBusyState () const { }
+		virtual void ExpandVolume (shared_ptr <VolumeExpansionOptions> options) const;
 		virtual void ExportTokenKeyfile () const;
+		virtual void ExportVolume (shared_ptr <VolumePath> volumePath, shared_ptr <FilePath> outputPath, shared_ptr <VolumePassword> password, int pim, shared_ptr <Hash> currentHash, shared_ptr <KeyfileList> keyfiles, shared_ptr <Hash> checksum, bool sparse) const;
 		virtual shared_ptr <GetStringFunctor> GetAdminPasswordRequestHandler ();
 		virtual void ImportTokenKeyfiles () const;
 #ifndef TC_NO_GUI
@@ -63,6 +66,7 @@ namespace VeraCrypt
 		virtual bool OnInitGui () { return true; }
 #endif
 		virtual int OnRun();
+		virtual void ReEncryptVolume (shared_ptr <VolumeReEncryptionOptions> options) const;
 		virtual void RestoreVolumeHeaders (shared_ptr <VolumePath> volumePath) const;
 		static void SetTerminalEcho (bool enable);
 		virtual void UserEnrichRandomPool () const;
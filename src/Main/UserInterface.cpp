@@ -509,6 +509,7 @@ namespace VeraCrypt
 		EX2MSG (StringConversionFailed,				LangString["LINUX_EX2MSG_STRINGCONVERSIONFAILED"]);
 		EX2MSG (StringFormatterException,			LangString["LINUX_EX2MSG_STRINGFORMATTEREXCEPTION"]);
 		EX2MSG (TemporaryDirectoryFailure,			LangString["LINUX_EX2MSG_TEMPORARYDIRECTORYFAILURE"]);
+		EX2MSG (UnsupportedFilesystem,				LangString["LINUX_EX2MSG_UNSUPPORTEDFILESYSTEM"]);
 		EX2MSG (UnportablePassword,					LangString["UNSUPPORTED_CHARS_IN_PWD"]);
 
 		EX2MSG (CommandAPDUNotValid,				LangString["COMMAND_APDU_INVALID"]);
@@ -663,57 +664,80 @@ namespace VeraCrypt
 		bool legacyVolumeMounted = false;
 		bool vulnerableVolumeMounted = false;
 
+		MountOptionsList optionsList;
 		foreach_ref (const HostDevice &device, devices)
 		{
 			if (mountedVolumes.find (wstring (device.Path)) != mountedVolumes.end())
 				continue;
 
-			Yield();
-			options.SlotNumber = Core->GetFirstFreeSlotNumber (options.SlotNumber);
-			options.MountPoint.reset (new DirectoryPath);
-			options.Path.reset (new VolumePath (device.Path));
+			shared_ptr <MountOptions> deviceOptions (new MountOptions (options));
+			deviceOptions->EMVSupportEnabled = options.EMVSupportEnabled;
+			deviceOptions->SlotNumber = 0;
+			deviceOptions->MountPoint.reset (new DirectoryPath);
+			deviceOptions->Path.reset (new VolumePath (device.Path));
+			deviceOptions->SharedAccessAllowed = sharedAccessAllowed;
 
-			try
+			optionsList.push_back (deviceOptions);
+		}
+
+		Yield();
+		BatchMountResultList results = Core->MountVolumes (optionsList, options.SlotNumber);
+
+		if (!sharedAccessAllowed)
+		{
+			MountOptionsList sharedOptionsList;
+			for (BatchMountResultList::iterator result = results.begin(); result != results.end(); )
 			{
-				try
+				if (result->Error && dynamic_cast <VolumeHostInUse *> (result->Error.get()))
 				{
-					options.SharedAccessAllowed = sharedAccessAllowed;
-					newMountedVolumes.push_back (Core->MountVolume (options));
+					result->Options->SharedAccessAllowed = true;
+					sharedOptionsList.push_back (result->Options);
+					result = results.erase (result);
 				}
-				catch (VolumeHostInUse&)
+				else
+					++result;
+			}
+
+			if (!sharedOptionsList.empty())
+			{
+				foreach (const BatchMountResult &result, Core->MountVolumes (sharedOptionsList, options.SlotNumber))
 				{
-					if (!sharedAccessAllowed)
-					{
-						try
-						{
-							options.SharedAccessAllowed = true;
-							newMountedVolumes.push_back (Core->MountVolume (options));
-							someVolumesShared = true;
-						}
-						catch (VolumeHostInUse&)
-						{
-							continue;
-						}
-					}
-					else
-						continue;
-				}
+					if (result.MountedVolume)
+						someVolumesShared = true;
 
-				if (newMountedVolumes.back()->Protection == VolumeProtection::HiddenVolumeReadOnly)
-					protectedVolumeMounted = true;
+					results.push_back (result);
+				}
+			}
+		}
 
-				if (newMountedVolumes.back()->EncryptionAlgorithmMinBlockSize == 8)
-					legacyVolumeMounted = true;
+		foreach (const BatchMountResult &result, results)
+		{
+			if (result.Error)
+			{
+				Exception *e = result.Error.get();
+				if (dynamic_cast <VolumeHostInUse *> (e)
+					|| dynamic_cast <DriverError *> (e)
+					|| dynamic_cast <MissingVolumeData *> (e)
+					|| dynamic_cast <PasswordException *> (e)
+					|| dynamic_cast <SystemException *> (e)
+					|| dynamic_cast <ExecutedProcessFailed *> (e))
+				{
+					continue;
+				}
 
-				if (newMountedVolumes.back()->MasterKeyVulnerable)
-					vulnerableVolumeMounted = true;
-				
+				e->Throw();
 			}
-			catch (DriverError&) { }
-			catch (MissingVolumeData&) { }
-			catch (PasswordException&) { }
-			catch (SystemException&) { }
-			catch (ExecutedProcessFailed&) { }
+
+			newMountedVolumes.push_back (result.MountedVolume);
+
+			if (newMountedVolumes.back()->Protection == VolumeProtection::HiddenVolumeReadOnly)
+				protectedVolumeMounted = true;
+
+			if (newMountedVolumes.back()->EncryptionAlgorithmMinBlockSize == 8)
+				legacyVolumeMounted = true;
+
+			if (newMountedVolumes.back()->MasterKeyVulnerable)
+				vulnerableVolumeMounted = true;
 		}
 
 		if (newMountedVolumes.empty())
@@ -746,57 +770,101 @@ namespace VeraCrypt
 		BusyScope busy (this);
 
 		VolumeInfoList newMountedVolumes;
-		foreach_ref (const FavoriteVolume &favorite, FavoriteVolume::LoadList())
+		MountOptionsList optionsList;
+		map <MountOptions *, shared_ptr <FavoriteVolume> > optionsFavorites;
+		bool trialHintsUpdated = false;
+
+		FavoriteVolumeList favorites = FavoriteVolume::LoadList();
+		foreach (shared_ptr <FavoriteVolume> favorite, favorites)
 		{
-			shared_ptr <VolumeInfo> mountedVolume = Core->GetMountedVolume (favorite.Path);
+			shared_ptr <VolumeInfo> mountedVolume = Core->GetMountedVolume (favorite->Path);
 			if (mountedVolume)
 			{
-				if (mountedVolume->MountPoint != favorite.MountPoint)
-					ShowInfo (StringFormatter (LangString["VOLUME_ALREADY_MOUNTED"], wstring (favorite.Path)));
+				if (mountedVolume->MountPoint != favorite->MountPoint)
+					ShowInfo (StringFormatter (LangString["VOLUME_ALREADY_MOUNTED"], wstring (favorite->Path)));
 				continue;
 			}
 
-			favorite.ToMountOptions (options);
+			shared_ptr <MountOptions> favoriteOptions (new MountOptions (options));
+			favoriteOptions->EMVSupportEnabled = options.EMVSupportEnabled;
+			favorite->ToMountOptions (*favoriteOptions);
 
-			bool mountPerformed = false;
-			if (Preferences.NonInteractive)
+			optionsList.push_back (favoriteOptions);
+			optionsFavorites[favoriteOptions.get()] = favorite;
+		}
+
+		if (optionsList.empty())
+			return newMountedVolumes;
+
+		BatchMountResultList results = Core->MountVolumes (optionsList);
+
+		foreach (const BatchMountResult &result, results)
+		{
+			if (!result.Error)
 			{
-				BusyScope busy (this);
-				newMountedVolumes.push_back (Core->MountVolume (options));
-				mountPerformed = true;
+				newMountedVolumes.push_back (result.MountedVolume);
+
+				if (result.MountedVolume->MasterKeyVulnerable)
+					ShowWarning ("ERR_XTS_MASTERKEY_VULNERABLE");
+
+				if (optionsFavorites[result.Options.get()]->UpdateTrialHint (*result.MountedVolume))
+					trialHintsUpdated = true;
 			}
-			else
+		}
+
+		bool mountFailed = false;
+		foreach (const BatchMountResult &result, results)
+		{
+			if (!result.Error)
+				continue;
+
+			// Every failure is reported with its volume as the other favorites have already been mounted
+			if (Preferences.NonInteractive)
 			{
-				try
-				{
-					BusyScope busy (this);
-					newMountedVolumes.push_back (Core->MountVolume (options));
-					mountPerformed = true;
-				}
-				catch (...)
-				{
-					UserPreferences prefs = GetPreferences();
-					if (prefs.CloseSecurityTokenSessionsAfterMount)
-						Preferences.CloseSecurityTokenSessionsAfterMount = false;
+				ShowError (StringFormatter (L"{0}: {1}", wstring (*result.Options->Path), ExceptionToMessage (*result.Error)));
+				mountFailed = true;
+				continue;
+			}
 
-					shared_ptr <VolumeInfo> volume = MountVolume (options);
+			options = *result.Options;
+			options.EMVSupportEnabled = result.Options->EMVSupportEnabled;
 
-					if (prefs.CloseSecurityTokenSessionsAfterMount)
-						Preferences.CloseSecurityTokenSessionsAfterMount = true;
+			UserPreferences prefs = GetPreferences();
+			if (prefs.CloseSecurityTokenSessionsAfterMount)
+				Preferences.CloseSecurityTokenSessionsAfterMount = false;
 
-					if (!volume)
-						break;
-					newMountedVolumes.push_back (volume);
-				}
+			shared_ptr <VolumeInfo> volume = MountVolume (options);
+
+			if (prefs.CloseSecurityTokenSessionsAfterMount)
+				Preferences.CloseSecurityTokenSessionsAfterMount = true;
+
+			if (!volume)
+				break;
+			newMountedVolumes.push_back (volume);
+
+			if (optionsFavorites[result.Options.get()]->UpdateTrialHint (*volume))
+				trialHintsUpdated = true;
+		}
+
+		// The parameters of the mounted volumes speed up their next mount; they are stored only if the user has asked for it
+		if (trialHintsUpdated && GetPreferences().SaveFavoriteVolumeParameters)
+		{
+			try
+			{
+				FavoriteVolume::SaveList (favorites, true);
+			}
+			catch (exception &e)
+			{
+				ShowError (e);
 			}
-			
-			if (mountPerformed && newMountedVolumes.back()->MasterKeyVulnerable)
-				ShowWarning ("ERR_XTS_MASTERKEY_VULNERABLE");
 		}
 
 		if (!newMountedVolumes.empty() && GetPreferences().CloseSecurityTokenSessionsAfterMount)
 			SecurityToken::CloseAllSessions();
 
+		if (mountFailed)
+			throw UserAbort (SRC_POS);
+
 		return newMountedVolumes;
 	}
 
@@ -1114,11 +1182,16 @@ const FileManager fileManagers[] = {
 
 				options->EA = cmdLine.ArgEncryptionAlgorithm;
 				options->Filesystem = cmdLine.ArgFilesystem;
+				options->FormatChunkSize = cmdLine.ArgFormatChunkSize;
+				options->FormatDirectIO = cmdLine.ArgFormatDirectIO;
+				options->FormatQueueDepth = cmdLine.ArgFormatQueueDepth;
 				options->Keyfiles = cmdLine.ArgKeyfiles;
 				options->Password = cmdLine.ArgPassword;
 				options->Pim = cmdLine.ArgPim;
+				options->Preallocate = cmdLine.ArgPreallocate;
 				options->Quick = cmdLine.ArgQuick;
 				options->Size = cmdLine.ArgSize;
+				options->SourceImage = cmdLine.ArgSourceImage;
 				options->Type = cmdLine.ArgVolumeType;
 
 				if (cmdLine.ArgVolumePath)
@@ -1164,9 +1237,11 @@ const FileManager fileManagers[] = {
 					"\n"
 					"-c, --create [VOLUME_PATH]\n"
 					" Create a new volume. Most options are requested from the user if not specified\n"
-					" on command line. See also options --encryption, -k, --filesystem, --hash, -p,\n"
-					" --random-source, --quick, --size, --volume-type. Note that passing some of the\n"
-					" options may affect security of the volume (see option -p for more information).\n"
+					" on command line. See also options --encryption, -k, --filesystem,\n"
+					" --format-chunk-size, --format-direct-io, --format-queue-depth, --hash, -p,\n"
+					" --preallocate, --random-source, --quick, --size, --source-image,\n"
+					" --volume-type. Note that passing some of the options may affect security of\n"
+					" the volume (see option -p for more information).\n"
 					"\n"
 					" Inexperienced users should use the graphical user interface to create a hidden\n"
 					" volume. When using the text user interface, the following procedure must be\n"
@@ -1195,9 +1270,37 @@ const FileManager fileManagers[] = {
 					"--delete-token-keyfiles\n"
 					" Delete keyfiles from security tokens. See also command --list-token-keyfiles.\n"
 					"\n"
+					"--encrypt-in-place [VOLUME_PATH]\n"
+					" Encrypt the existing data of a device or file in place, converting it to a\n"
+					" normal volume. The filesystem must be unmounted and shrunk beforehand by at\n"
+					" least 256 KiB, as its data is moved by 128 KiB to make room for the headers\n"
+					" and the backup headers overwrite the end of the device or file. Progress is\n"
+					" recorded in the backup header, and an interrupted encryption is continued by\n"
+					" repeating the command with --resume. Until it is complete, the volume cannot\n"
+					" be mounted. Only the size of ext2, ext3 and ext4 filesystems can be verified;\n"
+					" other filesystems require --force. See also options --encryption, --force,\n"
+					" --hash, -k, -p, --pim.\n"
+					"\n"
+					"--expand [VOLUME_PATH]\n"
+					" Expand a volume over space added to the end of its host. A file container is\n"
+					" extended to the size specified by --size, a device-hosted volume is expanded\n"
+					" to the current size of the device or partition. The added space is filled\n"
+					" with random data unless --quick is specified, and the backup headers are\n"
+					" moved to the new end. The filesystem within the volume must be grown\n"
+					" separately after the volume is mounted. The backup header of a hidden volume\n"
+					" within the volume is not preserved. See also options --format-chunk-size,\n"
+					" --format-direct-io, --format-queue-depth, -k, -p, --pim.\n"
+					"\n"
 					"--export-token-keyfile\n"
 					" Export a keyfile from a token. See also command --list-token-keyfiles.\n"
 					"\n"
+					"--export-volume=FILE [VOLUME_PATH]\n"
+					" Write the decrypted contents of a volume to FILE, e.g. to back up or migrate\n"
+					" the data. The volume is opened read-only and must not be mounted. If FILE is\n"
+					" -, the data is written to standard output, which requires --non-interactive.\n"
+					" An existing FILE is overwritten only after confirmation or with --force.\n"
+					" See also options --checksum, --sparse.\n"
+					"\n"
 					"--import-token-keyfiles\n"
 					" Import keyfiles to a security token. See also option --token-lib.\n"
 					"\n"
@@ -1221,6 +1324,15 @@ const FileManager fileManagers[] = {
 					" Mount a volume. Volume path and other options are requested from the user\n"
 					" if not specified on command line.\n"
 					"\n"
+					"--reencrypt [VOLUME_PATH]\n"
+					" Re-encrypt the data of a volume with a new master key, optionally using the\n"
+					" encryption algorithm given by --encryption. The password, PIM and keyfiles\n"
+					" are not changed. Progress is recorded in the volume header, and an\n"
+					" interrupted re-encryption is continued only by repeating the command, which\n"
+					" asks again whether to protect a hidden volume. In the meantime, the volume\n"
+					" can be mounted by this version or newer only, and its headers cannot be\n"
+					" changed. See also options --protect-hidden, -k, -p, --pim.\n"
+					"\n"
 					"--restore-headers [VOLUME_PATH]\n"
 					" Restore volume headers from the embedded or an external backup. All required\n"
 					" options are requested from the user.\n"
@@ -1247,6 +1359,10 @@ const FileManager fileManagers[] = {
 					"\n"
 					"Options:\n"
 					"\n"
+					"--checksum=HASH\n"
+					" Compute a checksum of the data written by --export-volume using the specified\n"
+					" hash algorithm and display it when the export is complete.\n"
+					"\n"
 					"--display-password\n"
 					" Display password characters while typing.\n"
 					"\n"
@@ -1264,6 +1380,20 @@ const FileManager fileManagers[] = {
 					" Force mounting of a volume in use, unmounting of a volume in use, or\n"
 					" overwriting a file. Note that this option has no effect on some platforms.\n"
 					"\n"
+					"--format-chunk-size=KIB\n"
+					" Size in KiB of each buffer used to encrypt free space when creating a volume\n"
+					" without quick format. Encryption of a buffer overlaps with writing of the\n"
+					" previous ones. The default size is 4096 KiB.\n"
+					"\n"
+					"--format-direct-io\n"
+					" Write encrypted free space directly to the volume host, bypassing the system\n"
+					" cache, when creating a volume without quick format. Ignored if the host does\n"
+					" not support direct I/O.\n"
+					"\n"
+					"--format-queue-depth=COUNT\n"
+					" Number of buffers used to encrypt free space when creating a volume without\n"
+					" quick format. The default is 4 buffers.\n"
+					"\n"
 					"--fs-options=OPTIONS\n"
 					" Filesystem mount options. The OPTIONS argument is passed to mount(8)\n"
 					" command with option -o when a filesystem on a VeraCrypt volume is mounted.\n"
@@ -1323,6 +1453,13 @@ const FileManager fileManagers[] = {
 					" command line is potentially insecure as the PIM may be visible in the process \n"
 					" list (see ps(1)) and/or stored in a command history file or system logs.\n"
 					"\n"
+					"--preallocate\n"
+					" Reserve disk space for a new file container before it is formatted (Linux,\n"
+					" macOS and FreeBSD). The host filesystem then allocates the container in few\n"
+					" extents without writing data, and the number of extents is reported. Quick\n"
+					" format may be used with a preallocated container, in which case its free space\n"
+					" is not encrypted.\n"
+					"\n"
 					"--protect-hidden=yes|no\n"
 					" Write-protect a hidden volume when mounting an outer volume. Before mounting\n"
 					" the outer volume, the user will be prompted for a password to open the hidden\n"
@@ -1345,22 +1482,39 @@ const FileManager fileManagers[] = {
 					" See also options -p and --protect-hidden.\n"
 					"\n"
 					"--quick\n"
-					" Do not encrypt free space when creating a device-hosted volume. This option\n"
-					" must not be used when creating an outer volume.\n"
+					" Do not encrypt free space when creating a device-hosted volume or a file\n"
+					" container created with --preallocate. This option must not be used when\n"
+					" creating an outer volume.\n"
 					"\n"
 					"--random-source=FILE\n"
 					" Use FILE as a source of random data (e.g., when creating a volume) instead\n"
 					" of requiring the user to type random characters.\n"
 					"\n"
+					"--resume\n"
+					" Continue an interrupted encryption started with --encrypt-in-place. The\n"
+					" password, PIM and keyfiles used to start the encryption must be specified.\n"
+					"\n"
 					"--slot=SLOT\n"
 					" Use specified slot number when mounting, unmounting, or listing a volume.\n"
 					"\n"
 					"--size=SIZE[K|KiB|M|MiB|G|GiB|T|TiB] or --size=max\n"
-					" Use specified size when creating a new volume. If no suffix is indicated,\n"
-					" then SIZE is interpreted in bytes. Suffixes K, M, G or T can be used to\n"
-					" indicate a value in KiB, MiB, GiB or TiB respectively.\n"
+					" Use specified size when creating or expanding a volume. If no suffix is\n"
+					" indicated, then SIZE is interpreted in bytes. Suffixes K, M, G or T can be\n"
+					" used to indicate a value in KiB, MiB, GiB or TiB respectively.\n"
 					" If max is specified, the new volume will use all available free disk space.\n"
 					"\n"
+					"--source-image=FILE\n"
+					" Create a new volume whose contents are those of the specified raw image (e.g.,\n"
+					" of a filesystem). The image is encrypted and written in a single pass, and\n"
+					" the remaining space is encrypted as in a normal format unless --quick is\n"
+					" specified. No filesystem is created. If FILE is -, the image is read from\n"
+					" standard input, which requires --non-interactive and excludes --stdin.\n"
+					"\n"
+					"--sparse\n"
+					" Do not write blocks that contain only zeros when exporting a volume with\n"
+					" --export-volume, so that the output file is sparse. Cannot be used when\n"
+					" writing to standard output.\n"
+					"\n"
 					"-t, --text\n"
 					" Use text user interface. Graphical user interface is used by default if\n"
 					" available. This option must be specified as the first argument.\n"
@@ -1435,10 +1589,61 @@ const FileManager fileManagers[] = {
 			}
 			return true;
 
+		case CommandId::EncryptInPlace:
+			{
+				make_shared_auto (InPlaceEncryptionOptions, options);
+
+				if (cmdLine.ArgHash)
+				{
+					options->VolumeHeaderKdf = Pkcs5Kdf::GetAlgorithm (*cmdLine.ArgHash);
+					RandomNumberGenerator::SetHash (cmdLine.ArgHash);
+				}
+
+				options->EA = cmdLine.ArgEncryptionAlgorithm;
+				options->Keyfiles = cmdLine.ArgKeyfiles;
+				options->Password = cmdLine.ArgPassword;
+				options->Pim = cmdLine.ArgPim;
+				options->Force = cmdLine.ArgForce;
+				options->Resume = cmdLine.ArgResume;
+
+				if (cmdLine.ArgVolumePath)
+					options->Path = VolumePath (*cmdLine.ArgVolumePath);
+
+				EncryptVolumeInPlace (options);
+				return true;
+			}
+
+		case CommandId::ExpandVolume:
+			{
+				make_shared_auto (VolumeExpansionOptions, options);
+
+				if (cmdLine.ArgHash)
+					options->Kdf = Pkcs5Kdf::GetAlgorithm (*cmdLine.ArgHash);
+
+				options->FormatChunkSize = cmdLine.ArgFormatChunkSize;
+				options->FormatDirectIO = cmdLine.ArgFormatDirectIO;
+				options->FormatQueueDepth = cmdLine.ArgFormatQueueDepth;
+				options->Keyfiles = cmdLine.ArgKeyfiles;
+				options->Password = cmdLine.ArgPassword;
+				options->Pim = cmdLine.ArgPim;
+				options->Quick = cmdLine.ArgQuick;
+				options->Size = cmdLine.ArgSize;
+
+				if (cmdLine.ArgVolumePath)
+					options->Path = VolumePath (*cmdLine.ArgVolumePath);
+
+				ExpandVolume (options);
+				return true;
+			}
+
 		case CommandId::ExportTokenKeyfile:
 			ExportTokenKeyfile();
 			return true;
 
+		case CommandId::ExportVolume:
+			ExportVolume (cmdLine.ArgVolumePath, cmdLine.ArgExportPath, cmdLine.ArgPassword, cmdLine.ArgPim, cmdLine.ArgHash, cmdLine.ArgKeyfiles, cmdLine.ArgChecksum, cmdLine.ArgSparse);
+			return true;
+
 		case CommandId::ImportTokenKeyfiles:
 			ImportTokenKeyfiles();
 			return true;
@@ -1462,6 +1667,30 @@ const FileManager fileManagers[] = {
 				ListMountedVolumes (cmdLine.ArgVolumes);
 			return true;
 
+		case CommandId::ReEncryptVolume:
+			{
+				make_shared_auto (VolumeReEncryptionOptions, options);
+
+				if (cmdLine.ArgHash)
+					options->Kdf = Pkcs5Kdf::GetAlgorithm (*cmdLine.ArgHash);
+
+				options->Keyfiles = cmdLine.ArgKeyfiles;
+				options->NewEA = cmdLine.ArgEncryptionAlgorithm;
+				options->Password = cmdLine.ArgPassword;
+				options->Pim = cmdLine.ArgPim;
+				options->Protection = cmdLine.ArgMountOptions.Protection;
+				options->ProtectionKdf = cmdLine.ArgMountOptions.ProtectionKdf;
+				options->ProtectionKeyfiles = cmdLine.ArgMountOptions.ProtectionKeyfiles;
+				options->ProtectionPassword = cmdLine.ArgMountOptions.ProtectionPassword;
+				options->ProtectionPim = cmdLine.ArgMountOptions.ProtectionPim;
+
+				if (cmdLine.ArgVolumePath)
+					options->Path = VolumePath (*cmdLine.ArgVolumePath);
+
+				ReEncryptVolume (options);
+				return true;
+			}
+
 		case CommandId::RestoreHeaders:
 			RestoreVolumeHeaders (cmdLine.ArgVolumePath);
 			return true;
@@ -1693,6 +1922,7 @@ const FileManager fileManagers[] = {
 		VC_CONVERT_EXCEPTION (MountPointUnavailable);
 		VC_CONVERT_EXCEPTION (NoDriveLetterAvailable);
 		VC_CONVERT_EXCEPTION (TemporaryDirectoryFailure);
+		VC_CONVERT_EXCEPTION (UnsupportedFilesystem);
 		VC_CONVERT_EXCEPTION (UnsupportedSectorSizeHiddenVolumeProtection);
 		VC_CONVERT_EXCEPTION (UnsupportedSectorSizeNoKernelCrypto);
 		VC_CONVERT_EXCEPTION (VolumeAlreadyMounted);
@@ -15,6 +15,8 @@
 
 #include "System.h"
 #include "Core/Core.h"
+#include "Core/InPlaceEncryptor.h"
+#include "Core/VolumeReEncryptor.h"
 #include "Main.h"
 #include "CommandLineInterface.h"
 #include "FavoriteVolume.h"
@@ -47,9 +49,12 @@ namespace VeraCrypt
 		virtual void DoShowInfo (const wxString &message) const = 0;
 		virtual void DoShowString (const wxString &str) const = 0;
 		virtual void DoShowWarning (const wxString &message) const = 0;
+		virtual void EncryptVolumeInPlace (shared_ptr <InPlaceEncryptionOptions> options) const = 0;
 		virtual void EndBusyState () const = 0;
 		static wxString ExceptionToMessage (const exception &ex);
+		virtual void ExpandVolume (shared_ptr <VolumeExpansionOptions> options) const = 0;
 		virtual void ExportTokenKeyfile () const = 0;
+		virtual void ExportVolume (shared_ptr <VolumePath> volumePath, shared_ptr <FilePath> outputPath, shared_ptr <VolumePassword> password, int pim, shared_ptr <Hash> currentHash, shared_ptr <KeyfileList> keyfiles, shared_ptr <Hash> checksum, bool sparse) const = 0;
 		virtual shared_ptr <GetStringFunctor> GetAdminPasswordRequestHandler () = 0;
 		virtual const UserPreferences &GetPreferences () const { return Preferences; }
 		virtual void ImportTokenKeyfiles () const = 0;
@@ -64,6 +69,7 @@ namespace VeraCrypt
 		virtual VolumeInfoList MountAllDeviceHostedVolumes (MountOptions &options) const;
 		virtual VolumeInfoList MountAllFavoriteVolumes (MountOptions &options);
 		virtual void OpenExplorerWindow (const DirectoryPath &path);
+		virtual void ReEncryptVolume (shared_ptr <VolumeReEncryptionOptions> options) const = 0;
 		virtual void RestoreVolumeHeaders (shared_ptr <VolumePath> volumePath) const = 0;
 		virtual void SetPreferences (const UserPreferences &preferences);
 		virtual void ShowError (const exception &ex) const;
@@ -107,6 +107,7 @@ namespace VeraCrypt
 			if (configMap.count(L"NoKernelCrypto") > 0) { SetValue (configMap[L"NoKernelCrypto"], DefaultMountOptions.NoKernelCrypto); configMap.erase (L"NoKernelCrypto"); }
 			TC_CONFIG_SET (OpenExplorerWindowAfterMount);
 			if (configMap.count(L"PreserveTimestamps") > 0) { SetValue (configMap[L"PreserveTimestamps"], DefaultMountOptions.PreserveTimestamps); configMap.erase (L"PreserveTimestamps"); }
+			TC_CONFIG_SET (SaveFavoriteVolumeParameters);
 			TC_CONFIG_SET (SaveHistory);
 			if (configMap.count(L"SecurityTokenLibrary") > 0) { SetValue (configMap[L"SecurityTokenLibrary"], SecurityTokenModule); configMap.erase (L"SecurityTokenLibrary"); }
 			TC_CONFIG_SET (StartOnLogon);
@@ -226,6 +227,7 @@ namespace VeraCrypt
 		formatter.AddEntry (L"NoKernelCrypto", DefaultMountOptions.NoKernelCrypto);
 		TC_CONFIG_ADD (OpenExplorerWindowAfterMount);
 		formatter.AddEntry (L"PreserveTimestamps", DefaultMountOptions.PreserveTimestamps);
+		TC_CONFIG_ADD (SaveFavoriteVolumeParameters);
 		TC_CONFIG_ADD (SaveHistory);
 		formatter.AddEntry (L"SecurityTokenLibrary", wstring (SecurityTokenModule));
 		TC_CONFIG_ADD (StartOnLogon);
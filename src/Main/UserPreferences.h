@@ -47,6 +47,7 @@ namespace VeraCrypt
 			NonInteractive (false),
 			UseStandardInput (false),
 			OpenExplorerWindowAfterMount (false),
+			SaveFavoriteVolumeParameters (false),
 			SaveHistory (false),
 			StartOnLogon (false),
 			UseKeyfiles (false),
@@ -90,6 +91,7 @@ namespace VeraCrypt
 		bool NonInteractive;
 		bool UseStandardInput;
 		bool OpenExplorerWindowAfterMount;
+		bool SaveFavoriteVolumeParameters;
 		bool SaveHistory;
 		FilePath SecurityTokenModule;
 		bool StartOnLogon;
@@ -45,7 +45,9 @@ namespace VeraCrypt
 			// Bitmap
 			FlagsNone = 0,
 			PreserveTimestamps = 1 << 0,
-			DisableWriteCaching = 1 << 1
+			DisableWriteCaching = 1 << 1,
+			DirectIO = 1 << 2,
+			ExclusiveDeviceAccess = 1 << 3
 		};
 
 #ifdef TC_WINDOWS
@@ -70,11 +72,13 @@ namespace VeraCrypt
 			SharedHandle = sharedHandle;
 		}
 
+		void Allocate (uint64 length) const;
 		void Close ();
 		static void Copy (const FilePath &sourcePath, const FilePath &destinationPath, bool preserveTimestamps = true);
 		void Delete ();
 		void Flush () const;
 		uint32 GetDeviceSectorSize () const;
+		uint32 GetExtentCount () const;
 		static size_t GetOptimalReadSize () { return OptimalReadSize; }
 		static size_t GetOptimalWriteSize ()  { return OptimalWriteSize; }
 		uint64 GetPartitionDeviceStartOffset () const;
@@ -87,6 +91,7 @@ namespace VeraCrypt
 		uint64 ReadAt (const BufferPtr &buffer, uint64 position) const;
 		void SeekAt (uint64 position) const;
 		void SeekEnd (int ofset) const;
+		void Truncate (uint64 length) const;
 		void Write (const ConstBufferPtr &buffer) const;
 		void Write (const ConstBufferPtr &buffer, size_t length) const { Write (buffer.GetRange (0, length)); }
 		void WriteAt (const ConstBufferPtr &buffer, uint64 position) const;
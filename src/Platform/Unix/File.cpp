@@ -17,6 +17,10 @@
 
 #ifdef TC_LINUX
 #include <sys/mount.h>
+#include <linux/fiemap.h>
+#ifndef FS_IOC_FIEMAP
+#define FS_IOC_FIEMAP _IOWR('f', 11, struct fiemap)
+#endif
 #endif
 
 #ifdef TC_BSD
@@ -62,6 +66,41 @@ namespace VeraCrypt
 	}
 #endif
 
+	void File::Allocate (uint64 length) const
+	{
+		if_debug (ValidateState());
+
+		// Reserves disk space without writing data; unwritten space reads as zeros
+#ifdef TC_LINUX
+		throw_sys_sub_if (fallocate (FileHandle, 0, 0, length) == -1, wstring (Path));
+
+#elif defined (TC_MACOSX)
+		fstore_t store;
+		store.fst_flags = F_ALLOCATECONTIG | F_ALLOCATEALL;
+		store.fst_posmode = F_PEOFPOSMODE;
+		store.fst_offset = 0;
+		store.fst_length = length;
+		store.fst_bytesalloc = 0;
+
+		// Contiguous allocation may fail on a fragmented filesystem
+		if (fcntl (FileHandle, F_PREALLOCATE, &store) == -1)
+		{
+			store.fst_flags = F_ALLOCATEALL;
+			throw_sys_sub_if (fcntl (FileHandle, F_PREALLOCATE, &store) == -1, wstring (Path));
+		}
+
+		throw_sys_sub_if (ftruncate (FileHandle, length) == -1, wstring (Path));
+
+#elif defined (TC_FREEBSD)
+		int status = posix_fallocate (FileHandle, 0, length);
+		if (status != 0)
+			throw SystemException (SRC_POS, status);
+
+#else
+		throw NotImplemented (SRC_POS);
+#endif
+	}
+
 	void File::Close ()
 	{
 		if_debug (ValidateState());
@@ -141,6 +180,24 @@ namespace VeraCrypt
 			throw ParameterIncorrect (SRC_POS);
 	}
 
+	uint32 File::GetExtentCount () const
+	{
+		if_debug (ValidateState());
+
+#ifdef TC_LINUX
+		// Only the number of extents is queried when no extent records are supplied
+		struct fiemap extentMap;
+		Memory::Zero (&extentMap, sizeof (extentMap));
+		extentMap.fm_length = FIEMAP_MAX_OFFSET;
+		extentMap.fm_flags = FIEMAP_FLAG_SYNC;
+
+		throw_sys_sub_if (ioctl (FileHandle, FS_IOC_FIEMAP, &extentMap) == -1, wstring (Path));
+		return extentMap.fm_mapped_extents;
+#else
+		throw NotImplemented (SRC_POS);
+#endif
+	}
+
 	uint64 File::GetPartitionDeviceStartOffset () const
 	{
 #ifdef TC_LINUX
@@ -275,6 +332,15 @@ namespace VeraCrypt
 			throw ParameterIncorrect (SRC_POS);
 		}
 
+#ifdef TC_LINUX
+		if (flags & File::DirectIO)
+			sysFlags |= O_DIRECT;
+
+		// Opening a block device exclusively fails if it is mounted or otherwise in use
+		if ((flags & File::ExclusiveDeviceAccess) && path.IsBlockDevice())
+			sysFlags |= O_EXCL;
+#endif
+
 		if ((flags & File::PreserveTimestamps) && path.IsFile())
 		{
 			struct stat statData;
@@ -286,6 +352,11 @@ namespace VeraCrypt
 		FileHandle = open (string (path).c_str(), sysFlags, S_IRUSR | S_IWUSR);
 		throw_sys_sub_if (FileHandle == -1, wstring (path));
 
+#ifdef TC_MACOSX
+		if (flags & File::DirectIO)
+			fcntl (FileHandle, F_NOCACHE, 1);
+#endif
+
 #if 0 // File locking is disabled to avoid remote filesystem locking issues
 		try
 		{
@@ -385,6 +456,12 @@ namespace VeraCrypt
 		throw_sys_sub_if (lseek (FileHandle, offset, SEEK_END) == -1, wstring (Path));
 	}
 
+	void File::Truncate (uint64 length) const
+	{
+		if_debug (ValidateState());
+		throw_sys_sub_if (ftruncate (FileHandle, length) == -1, wstring (Path));
+	}
+
 	void File::Write (const ConstBufferPtr &buffer) const
 	{
 		if_debug (ValidateState());
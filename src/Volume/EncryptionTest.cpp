@@ -12,6 +12,7 @@
 
 #include "Cipher.h"
 #include "Common/Crc.h"
+#include "Common/Pkcs5.h"
 #include "Crc32.h"
 #include "EncryptionAlgorithm.h"
 #include "EncryptionMode.h"
@@ -41,6 +42,7 @@ namespace VeraCrypt
 		TestXtsAES();
 		TestXts();
 		TestPkcs5();
+		TestSimdImplementations();
 	}
 
 
@@ -1125,17 +1127,28 @@ namespace VeraCrypt
 		ConstBufferPtr salt (saltData, sizeof (saltData));
 		Buffer derivedKey (4);
 
+		// Keys as long as a header key are derived in several blocks at once
+		Buffer derivedHeaderKey (192);
+
          #ifndef WOLFCRYPT_BACKEND
 		Pkcs5HmacBlake2s pkcs5HmacBlake2s;
 		pkcs5HmacBlake2s.DeriveKey (derivedKey, password, salt, 5);
 		if (memcmp (derivedKey.Ptr(), "\x8d\x51\xfa\x31", 4) != 0)
 			throw TestFailed (SRC_POS);
 
+		pkcs5HmacBlake2s.DeriveKey (derivedHeaderKey, password, salt, 5);
+		if (memcmp (derivedHeaderKey.Ptr(), "\x8d\x51\xfa\x31\x46\x25\x37\x67\xa3\x29\x6b\x3c\x6b\xc1\x5d\xb2\xee\xe1\x6c\x28\x00\x26\xea\x08\x65\x9c\x12\xf1\x07\xde\x0d\xb9\x9b\x4f\x39\xfa\xc6\x80\x26\xb1\x8f\x8e\x48\x89\x85\x2d\x24\x2d\xbd\x63\x72\x4a\x6c\xc6\x19\x7e\xc3\x1a\x5d\xf7\x61\xdc\x0d\xc8\x16\x3d\xd1\x1b\x02\x9b\x84\xd1\xc1\xee\x73\xf7\x1a\x36\x82\x50\xd0\xe7\x57\x16\x2b\x27\x00\x97\xee\x6e\xa1\x55\x44\x55\x19\x4f\x1f\xea\xe4\x48\x30\xfd\xaa\xa1\xe6\x9e\x1e\x3c\x5c\x43\x56\x10\x29\x4f\x72\x57\x3a\x14\x15\x77\xa6\x0a\x56\xd2\x7b\xfa\x86\x22\x20\x65\xd8\xc2\x64\x24\x68\x95\xc5\x52\x0d\x22\x33\x3c\xa6\x7c\x89\x17\xde\x0b\xc9\x62\xaf\x52\x2b\xda\x14\x24\xb0\x3d\xe1\x2b\xea\x23\x3c\xd8\xca\x8a\xe3\x7a\xa7\x6f\xdd\x4a\x2c\x31\x46\xa2\xeb\x3e\x2a\x07\xf2\x08\x21\x42\xb3\xde\x03\x53\x36\xb5\xff\x24", 192) != 0)
+			throw TestFailed (SRC_POS);
+
 		Pkcs5HmacSha512 pkcs5HmacSha512;
 		pkcs5HmacSha512.DeriveKey (derivedKey, password, salt, 5);
 		if (memcmp (derivedKey.Ptr(), "\x13\x64\xae\xf8", 4) != 0)
 			throw TestFailed (SRC_POS);
 
+		pkcs5HmacSha512.DeriveKey (derivedHeaderKey, password, salt, 5);
+		if (memcmp (derivedHeaderKey.Ptr(), "\x13\x64\xae\xf8\x0d\xf5\x57\x6c\x30\xd5\x71\x4c\xa7\x75\x3f\xfd\x00\xe5\x25\x8b\x39\xc7\x44\x7f\xce\x23\x3d\x08\x75\xe0\x2f\x48\xd6\x30\xd7\x00\xb6\x24\xdb\xe0\x5a\xd7\x47\xef\x52\xca\xa6\x34\x83\x47\xe5\xcb\xe9\x87\xf1\x20\x59\x6a\xe6\xa9\xcf\x51\x78\xc6\xb6\x23\xa6\x74\x0d\xe8\x91\xbe\x1a\xd0\x28\xcc\xce\x16\x98\x9a\xbe\xfb\xdc\x78\xc9\xe1\x7d\x72\x67\xce\xe1\x61\x56\x5f\x96\x68\xe6\xe1\xdd\xf4\xbf\x1b\x80\xe0\x19\x1c\xf4\xc4\xd3\xdd\xd5\xd5\x57\x2d\x83\xc7\xa3\x37\x87\xf4\x4e\xe0\xf6\xd8\x6d\x65\xdc\xa0\x52\xa3\x13\xbe\x81\xfc\x30\xbe\x7d\x69\x58\x34\xb6\xdd\x41\xc6\x21\x50\xf5\x60\x44\xf9\x87\x69\xfd\x75\x75\xcb\x10\xe5\xe0\xfd\xf0\x7d\x3f\x79\xe2\xa0\x68\xb5\xbf\xd1\x76\x91\xc8\x68\x67\xd9\x01\x00\x4c\x1b\xfc\x1a\xd3\x39\x7b\x9d\x3d\x88\x71\xfc\x55\x1a", 192) != 0)
+			throw TestFailed (SRC_POS);
+
 		Pkcs5HmacWhirlpool pkcs5HmacWhirlpool;
 		pkcs5HmacWhirlpool.DeriveKey (derivedKey, password, salt, 5);
 		if (memcmp (derivedKey.Ptr(), "\x50\x7c\x36\x6f", 4) != 0)
@@ -1145,6 +1158,10 @@ namespace VeraCrypt
 		pkcs5HmacSha256.DeriveKey (derivedKey, password, salt, 5);
 		if (memcmp (derivedKey.Ptr(), "\xf2\xa0\x4f\xb2", 4) != 0)
 			throw TestFailed (SRC_POS);
+
+		pkcs5HmacSha256.DeriveKey (derivedHeaderKey, password, salt, 5);
+		if (memcmp (derivedHeaderKey.Ptr(), "\xf2\xa0\x4f\xb2\xd3\xe9\xa5\xd8\x51\x0b\x5c\x06\xdf\x70\x8e\x24\xe9\xc7\xd9\x15\x3d\x22\xcd\xde\xb8\xa6\xdb\xfd\x71\x85\xc6\x99\x32\xc0\xee\x37\x27\xf7\x24\xcf\xea\xa6\xac\x73\xa1\x4c\x4e\x52\x9b\x94\xf3\x54\x06\xfc\x04\x65\xa1\x0a\x24\xfe\xf0\x98\x1d\xa6\x22\x28\xeb\x24\x55\x74\xce\x6a\x3a\x28\xe2\x04\x3a\x59\x13\xec\x3f\xf2\xdb\xcf\x58\xdd\x53\xd9\xf9\x17\xf6\xda\x74\x06\x3c\x0b\x66\xf5\x0f\xf5\x58\xa3\x27\x52\x8c\x5b\x07\x91\xd0\x81\xeb\xb6\xbc\x30\x69\x42\x71\xf2\xd7\x18\x42\xbe\xe8\x02\x93\x70\x66\xad\x35\x65\xbc\xf7\x96\x8e\x64\xf1\xc6\x92\xda\xe0\xdc\x1f\xb5\xf4\x15\xe8\xda\x2b\xb8\xd5\x96\x06\x50\x0e\xdb\xd7\xbf\x5d\x14\x7e\x16\x3c\xbd\x69\x29\x11\x45\x25\xaa\xc1\x7c\x6f\x0e\xcb\xe6\x86\x83\x77\xf0\xf4\x66\xbb\x34\x82\x3a\x84\x88\xde\xda\x8e\xce\x85", 192) != 0)
+			throw TestFailed (SRC_POS);
 		
 		Pkcs5HmacStreebog pkcs5HmacStreebog;
 		pkcs5HmacStreebog.DeriveKey (derivedKey, password, salt, 5);
@@ -1162,4 +1179,248 @@ namespace VeraCrypt
 			throw TestFailed (SRC_POS);
         #endif	
         }
+
+#ifndef WOLFCRYPT_BACKEND
+#ifdef CRYPTOPP_CPUID_AVAILABLE
+	// CPU features disabled by DisableCPUExtendedFeatures(), saved to be restored after the test
+	struct SimdFeatureState
+	{
+		SimdFeatureState ()
+			: AESNI (g_hasAESNI), AVX (g_hasAVX), AVX2 (g_hasAVX2), AVX512 (g_hasAVX512), AVX512VBMI (g_hasAVX512VBMI), BMI2 (g_hasBMI2), CLMUL (g_hasCLMUL),
+			GFNI (g_hasGFNI), ISSE (g_hasISSE), MMX (g_hasMMX), SHA256 (g_hasSHA256), SSE2 (g_hasSSE2), SSE41 (g_hasSSE41), SSE42 (g_hasSSE42), SSSE3 (g_hasSSSE3), VAES (g_hasVAES)
+		{
+		}
+
+		void Restore () const
+		{
+			g_hasAESNI = AESNI;
+			g_hasAVX = AVX;
+			g_hasAVX2 = AVX2;
+			g_hasAVX512 = AVX512;
+			g_hasAVX512VBMI = AVX512VBMI;
+			g_hasBMI2 = BMI2;
+			g_hasCLMUL = CLMUL;
+			g_hasGFNI = GFNI;
+			g_hasISSE = ISSE;
+			g_hasMMX = MMX;
+			g_hasSHA256 = SHA256;
+			g_hasSSE2 = SSE2;
+			g_hasSSE41 = SSE41;
+			g_hasSSE42 = SSE42;
+			g_hasSSSE3 = SSSE3;
+			g_hasVAES = VAES;
+		}
+
+		int AESNI, AVX, AVX2, AVX512, AVX512VBMI, BMI2, CLMUL, GFNI, ISSE, MMX, SHA256, SSE2, SSE41, SSE42, SSSE3, VAES;
+	};
+
+	static const int SimdFeatureLevelCount = 6;
+#else
+	static const int SimdFeatureLevelCount = 1;
+#endif
+
+	// Each level disables the features of the fastest remaining implementations, down to the generic code
+	static void DisableSimdFeatures (int level)
+	{
+#ifdef CRYPTOPP_CPUID_AVAILABLE
+		if (level >= 1)
+		{
+			// 8 SHA-512 lanes, 16 Serpent blocks, 4 Kuznyechik blocks per register, Argon2 fill
+			g_hasAVX512 = 0;
+			g_hasAVX512VBMI = 0;
+			g_hasGFNI = 0;
+		}
+
+		if (level >= 2)
+			g_hasVAES = 0; // 32 Camellia blocks
+
+		if (level >= 3)
+			g_hasSHA256 = 0; // 2 interleaved SHA-256 streams
+
+		if (level >= 4)
+			g_hasAVX2 = 0; // 4 SHA-512, 8 SHA-256 and 8 BLAKE2s lanes, 8 Serpent and Twofish blocks, Argon2 fill
+
+		if (level >= 5)
+			DisableCPUExtendedFeatures();
+#else
+		(void) level;
+#endif
+	}
+
+	typedef void (*HmacFunction) (unsigned char *key, int keyLength, unsigned char *data, int dataLength);
+	typedef void (*DeriveKeyFunction) (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
+
+	// Derives keys of 1 to 17 blocks, each block computed separately with the HMAC function, and compares them
+	// with the derivation function, which computes several blocks at once. Odd block counts end with a partial block.
+	static void TestPkcs5Blocks (HmacFunction hmac, DeriveKeyFunction deriveKey, size_t digestSize)
+	{
+		const uint32 iterations = 3;
+		const size_t maxBlockCount = 17;
+
+		uint8 password[20];
+		uint8 salt[64];
+
+		for (size_t i = 0; i < sizeof (password); ++i)
+			password[i] = (uint8) (0x50 + i);
+
+		for (size_t i = 0; i < sizeof (salt); ++i)
+			salt[i] = (uint8) (i * 13 + 7);
+
+		Buffer expectedKey (maxBlockCount * digestSize);
+		Buffer derivedKey (maxBlockCount * digestSize);
+		uint8 u[128];
+		uint8 t[64];
+
+		for (size_t block = 1; block <= maxBlockCount; ++block)
+		{
+			memcpy (u, salt, sizeof (salt));
+			u[sizeof (salt)] = (uint8) (block >> 24);
+			u[sizeof (salt) + 1] = (uint8) (block >> 16);
+			u[sizeof (salt) + 2] = (uint8) (block >> 8);
+			u[sizeof (salt) + 3] = (uint8) block;
+
+			hmac (password, sizeof (password), u, sizeof (salt) + 4);
+			memcpy (t, u, digestSize);
+
+			for (uint32 c = 1; c < iterations; ++c)
+			{
+				hmac (password, sizeof (password), u, (int) digestSize);
+				for (size_t i = 0; i < digestSize; ++i)
+					t[i] ^= u[i];
+			}
+
+			memcpy (expectedKey.Ptr() + (block - 1) * digestSize, t, digestSize);
+		}
+
+		for (size_t blockCount = 1; blockCount <= maxBlockCount; ++blockCount)
+		{
+			size_t keySize = blockCount * digestSize - (blockCount % 2 == 0 ? 0 : digestSize / 2);
+
+			derivedKey.Zero();
+			deriveKey (password, sizeof (password), salt, sizeof (salt), iterations, derivedKey.Ptr(), (int) keySize, NULL);
+
+			if (memcmp (derivedKey.Ptr(), expectedKey.Ptr(), keySize) != 0)
+				throw TestFailed (SRC_POS);
+
+			for (size_t i = keySize; i < derivedKey.Size(); ++i)
+			{
+				if (derivedKey[i] != 0)
+					throw TestFailed (SRC_POS);
+			}
+		}
+	}
+
+	// Encrypts and decrypts 1 to 70 blocks at once, which covers full and partial batches of all implementations,
+	// and compares the results with blocks processed one at a time. The block following the data must not be modified.
+	static void TestCipherBlocks (Cipher &cipher)
+	{
+		const size_t maxBlockCount = 70;
+		size_t blockSize = cipher.GetBlockSize();
+
+		Buffer key (cipher.GetKeySize());
+		for (size_t i = 0; i < key.Size(); ++i)
+			key[i] = (uint8) (i * 7 + 1);
+
+		cipher.SetKey (key);
+
+		Buffer plaintext (maxBlockCount * blockSize);
+		for (size_t i = 0; i < plaintext.Size(); ++i)
+			plaintext[i] = (uint8) (i * 31 + 3);
+
+		Buffer ciphertext (plaintext.Size());
+		ciphertext.CopyFrom (plaintext);
+
+		for (size_t i = 0; i < maxBlockCount; ++i)
+			cipher.EncryptBlock (ciphertext.Ptr() + i * blockSize);
+
+		Buffer data ((maxBlockCount + 1) * blockSize);
+
+		for (size_t blockCount = 1; blockCount <= maxBlockCount; ++blockCount)
+		{
+			size_t dataSize = blockCount * blockSize;
+
+			memset (data.Ptr(), 0xa5, data.Size());
+			memcpy (data.Ptr(), plaintext.Ptr(), dataSize);
+
+			cipher.EncryptBlocks (data.Ptr(), blockCount);
+
+			if (memcmp (data.Ptr(), ciphertext.Ptr(), dataSize) != 0)
+				throw TestFailed (SRC_POS);
+
+			cipher.DecryptBlocks (data.Ptr(), blockCount);
+
+			if (memcmp (data.Ptr(), plaintext.Ptr(), dataSize) != 0)
+				throw TestFailed (SRC_POS);
+
+			for (size_t i = dataSize; i < dataSize + blockSize; ++i)
+			{
+				if (data[i] != 0xa5)
+					throw TestFailed (SRC_POS);
+			}
+		}
+	}
+#endif
+
+	void EncryptionTest::TestSimdImplementations ()
+	{
+#ifndef WOLFCRYPT_BACKEND
+#ifdef CRYPTOPP_CPUID_AVAILABLE
+		SimdFeatureState featureState;
+		finally_do_arg (const SimdFeatureState *, &featureState, { finally_arg->Restore(); });
+#endif
+		// Argon2 has no generic implementation on x86, so its output with the SIMD features disabled is the reference.
+		// The largest size is filled in huge pages where available.
+		static const struct { uint32 MemoryCost; uint32 Iterations; } argon2Parameters[] = { { 8, 2 }, { 1032, 2 }, { 16384, 1 } };
+		uint8 argon2Password[] = { 'p', 'a', 's', 's', 'w', 'o', 'r', 'd' };
+		uint8 argon2Salt[32];
+		uint8 argon2ExpectedKeys[array_capacity (argon2Parameters)][64];
+		uint8 argon2Key[64];
+
+		for (size_t i = 0; i < sizeof (argon2Salt); ++i)
+			argon2Salt[i] = (uint8) (0xff - i);
+
+		DisableSimdFeatures (SimdFeatureLevelCount - 1);
+
+		for (size_t i = 0; i < array_capacity (argon2Parameters); ++i)
+		{
+			derive_key_argon2 (argon2Password, sizeof (argon2Password), argon2Salt, sizeof (argon2Salt), argon2Parameters[i].Iterations, argon2Parameters[i].MemoryCost,
+				argon2ExpectedKeys[i], sizeof (argon2ExpectedKeys[i]), NULL);
+		}
+
+		for (int level = 0; level < SimdFeatureLevelCount; ++level)
+		{
+#ifdef CRYPTOPP_CPUID_AVAILABLE
+			featureState.Restore();
+#endif
+			DisableSimdFeatures (level);
+
+			TestPkcs5Blocks (hmac_sha512, derive_key_sha512, SHA512_DIGESTSIZE);
+			TestPkcs5Blocks (hmac_sha256, derive_key_sha256, SHA256_DIGESTSIZE);
+			TestPkcs5Blocks (hmac_blake2s, derive_key_blake2s, BLAKE2S_DIGESTSIZE);
+			TestPkcs5Blocks (hmac_whirlpool, derive_key_whirlpool, WHIRLPOOL_DIGESTSIZE);
+			TestPkcs5Blocks (hmac_streebog, derive_key_streebog, STREEBOG_DIGESTSIZE);
+
+			CipherSerpent serpent;
+			TestCipherBlocks (serpent);
+
+			CipherTwofish twofish;
+			TestCipherBlocks (twofish);
+
+			CipherCamellia camellia;
+			TestCipherBlocks (camellia);
+
+			CipherKuznyechik kuznyechik;
+			TestCipherBlocks (kuznyechik);
+
+			for (size_t i = 0; i < array_capacity (argon2Parameters); ++i)
+			{
+				derive_key_argon2 (argon2Password, sizeof (argon2Password), argon2Salt, sizeof (argon2Salt), argon2Parameters[i].Iterations, argon2Parameters[i].MemoryCost,
+					argon2Key, sizeof (argon2Key), NULL);
+
+				if (memcmp (argon2Key, argon2ExpectedKeys[i], sizeof (argon2Key)) != 0)
+					throw TestFailed (SRC_POS);
+			}
+		}
+#endif
+	}
 }
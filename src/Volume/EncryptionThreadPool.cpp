@@ -26,6 +26,109 @@
 
 namespace VeraCrypt
 {
+	void EncryptionThreadPool::DeriveKeys (const Pkcs5Kdf &kdf, const VolumePassword &password, int pim, const ConstBufferPtr &salts, size_t saltSize, const BufferPtr &keys)
+	{
+		if (saltSize == 0 || salts.Size() % saltSize != 0)
+			throw ParameterIncorrect (SRC_POS);
+
+		size_t keyCount = salts.Size() / saltSize;
+		if (keyCount == 0)
+			return;
+
+		if (keys.Size() % keyCount != 0)
+			throw ParameterIncorrect (SRC_POS);
+
+		size_t keySize = keys.Size() / keyCount;
+
+		// Memory-hard derivations are limited to the number that fits in memory at the same time
+		size_t maxFragmentCount = GetMaxConcurrentKeyDerivations (kdf.GetMemoryCost (pim));
+		if (maxFragmentCount > ThreadCount)
+			maxFragmentCount = ThreadCount;
+
+		if (!ThreadPoolRunning || keyCount == 1 || maxFragmentCount < 2)
+		{
+			for (size_t i = 0; i < keyCount; ++i)
+				kdf.DeriveKey (keys.GetRange (i * keySize, keySize), password, pim, salts.GetRange (i * saltSize, saltSize));
+
+			return;
+		}
+
+		size_t fragmentCount;
+		size_t keysPerFragment;
+		size_t remainder;
+
+		if (keyCount <= maxFragmentCount)
+		{
+			fragmentCount = keyCount;
+			keysPerFragment = 1;
+			remainder = 0;
+		}
+		else
+		{
+			fragmentCount = maxFragmentCount;
+			keysPerFragment = keyCount / maxFragmentCount;
+			remainder = keyCount % maxFragmentCount;
+
+			if (remainder > 0)
+				++keysPerFragment;
+		}
+
+		const uint8 *fragmentSalts = salts.Get();
+		uint8 *fragmentKeys = keys.Get();
+
+		WorkItem *workItem;
+		WorkItem *firstFragmentWorkItem;
+
+		{
+			ScopeLock lock (EnqueueMutex);
+			firstFragmentWorkItem = &WorkItemQueue[EnqueuePosition];
+
+			while (firstFragmentWorkItem->State != WorkItem::State::Free)
+			{
+				WorkItemCompletedEvent.Wait();
+			}
+
+			firstFragmentWorkItem->OutstandingFragmentCount.Set (fragmentCount);
+			firstFragmentWorkItem->ItemException.reset();
+
+			while (fragmentCount-- > 0)
+			{
+				workItem = &WorkItemQueue[EnqueuePosition++];
+
+				if (EnqueuePosition >= QueueSize)
+					EnqueuePosition = 0;
+
+				while (workItem->State != WorkItem::State::Free)
+				{
+					WorkItemCompletedEvent.Wait();
+				}
+
+				workItem->Type = WorkType::DeriveKey;
+				workItem->FirstFragment = firstFragmentWorkItem;
+
+				workItem->KeyDerivation.Kdf = &kdf;
+				workItem->KeyDerivation.Password = &password;
+				workItem->KeyDerivation.Pim = pim;
+				workItem->KeyDerivation.Salts = fragmentSalts;
+				workItem->KeyDerivation.SaltSize = saltSize;
+				workItem->KeyDerivation.Keys = fragmentKeys;
+				workItem->KeyDerivation.KeySize = keySize;
+				workItem->KeyDerivation.KeyCount = keysPerFragment;
+
+				fragmentSalts += keysPerFragment * saltSize;
+				fragmentKeys += keysPerFragment * keySize;
+
+				if (remainder > 0 && --remainder == 0)
+					--keysPerFragment;
+
+				workItem->State.Set (WorkItem::State::Ready);
+				WorkItemReadyEvent.Signal();
+			}
+		}
+
+		WaitForCompletion (firstFragmentWorkItem);
+	}
+
 	void EncryptionThreadPool::DoWork (WorkType::Enum type, const EncryptionMode *encryptionMode, uint8 *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize)
 	{
 		size_t fragmentCount;
@@ -123,24 +226,11 @@ namespace VeraCrypt
 			}
 		}
 
-		firstFragmentWorkItem->ItemCompletedEvent.Wait();
-
-		unique_ptr <Exception> itemException;
-		if (firstFragmentWorkItem->ItemException.get())
-			itemException = move_ptr(firstFragmentWorkItem->ItemException);
-
-		firstFragmentWorkItem->State.Set (WorkItem::State::Free);
-		WorkItemCompletedEvent.Signal();
-
-		if (itemException.get())
-			itemException->Throw();
+		WaitForCompletion (firstFragmentWorkItem);
 	}
 
-	void EncryptionThreadPool::Start ()
+	size_t EncryptionThreadPool::GetCpuCount ()
 	{
-		if (ThreadPoolRunning)
-			return;
-
 		size_t cpuCount;
 
 #ifdef TC_WINDOWS
@@ -170,6 +260,69 @@ namespace VeraCrypt
 #	error Cannot determine CPU count
 #endif
 
+		return cpuCount;
+	}
+
+	size_t EncryptionThreadPool::GetMaxConcurrentKeyDerivations (uint64 memoryCost)
+	{
+		size_t maxCount = GetCpuCount();
+
+		if (memoryCost > 0)
+		{
+			// Memory-hard derivations running at the same time must fit in half of the physical memory
+			uint64 budget = GetPhysicalMemorySize() / 2;
+
+			if (budget / memoryCost < maxCount)
+				maxCount = (size_t) (budget / memoryCost);
+		}
+
+		return maxCount > 0 ? maxCount : 1;
+	}
+
+	uint64 EncryptionThreadPool::GetPhysicalMemorySize ()
+	{
+#ifdef TC_WINDOWS
+
+		MEMORYSTATUSEX memoryStatus;
+		memoryStatus.dwLength = sizeof (memoryStatus);
+		if (!GlobalMemoryStatusEx (&memoryStatus))
+			return 0;
+
+		return memoryStatus.ullTotalPhys;
+
+#elif defined (TC_MACOSX)
+
+		uint64 memorySize;
+		int mib[2] = { CTL_HW, HW_MEMSIZE };
+
+		size_t len = sizeof (memorySize);
+		if (sysctl (mib, 2, &memorySize, &len, nullptr, 0) == -1)
+			return 0;
+
+		return memorySize;
+
+#elif defined (_SC_PHYS_PAGES) && defined (_SC_PAGESIZE)
+
+		long pageCount = sysconf (_SC_PHYS_PAGES);
+		long pageSize = sysconf (_SC_PAGESIZE);
+
+		if (pageCount <= 0 || pageSize <= 0)
+			return 0;
+
+		return (uint64) pageCount * (uint64) pageSize;
+
+#else
+		return 0;
+#endif
+	}
+
+	void EncryptionThreadPool::Start ()
+	{
+		if (ThreadPoolRunning)
+			return;
+
+		size_t cpuCount = GetCpuCount();
+
 		if (cpuCount < 2)
 			return;
 
@@ -233,6 +386,21 @@ namespace VeraCrypt
 		ThreadPoolRunning = false;
 	}
 
+	void EncryptionThreadPool::WaitForCompletion (WorkItem *firstFragmentWorkItem)
+	{
+		firstFragmentWorkItem->ItemCompletedEvent.Wait();
+
+		unique_ptr <Exception> itemException;
+		if (firstFragmentWorkItem->ItemException.get())
+			itemException = move_ptr(firstFragmentWorkItem->ItemException);
+
+		firstFragmentWorkItem->State.Set (WorkItem::State::Free);
+		WorkItemCompletedEvent.Signal();
+
+		if (itemException.get())
+			itemException->Throw();
+	}
+
 	void EncryptionThreadPool::WorkThreadProc ()
 	{
 		try
@@ -272,6 +440,17 @@ namespace VeraCrypt
 						workItem->Encryption.Mode->EncryptSectorsCurrentThread (workItem->Encryption.Data, workItem->Encryption.StartUnitNo, workItem->Encryption.UnitCount, workItem->Encryption.SectorSize);
 						break;
 
+					case WorkType::DeriveKey:
+						for (size_t i = 0; i < workItem->KeyDerivation.KeyCount; ++i)
+						{
+							workItem->KeyDerivation.Kdf->DeriveKey (
+								BufferPtr (workItem->KeyDerivation.Keys + i * workItem->KeyDerivation.KeySize, workItem->KeyDerivation.KeySize),
+								*workItem->KeyDerivation.Password,
+								workItem->KeyDerivation.Pim,
+								ConstBufferPtr (workItem->KeyDerivation.Salts + i * workItem->KeyDerivation.SaltSize, workItem->KeyDerivation.SaltSize));
+						}
+						break;
+
 					default:
 						throw ParameterIncorrect (SRC_POS);
 					}
@@ -15,6 +15,7 @@
 
 #include "Platform/Platform.h"
 #include "EncryptionMode.h"
+#include "Pkcs5Kdf.h"
 
 namespace VeraCrypt
 {
@@ -60,15 +61,32 @@ namespace VeraCrypt
 					uint64 UnitCount;
 					size_t SectorSize;
 				} Encryption;
+
+				struct
+				{
+					const Pkcs5Kdf *Kdf;
+					const VolumePassword *Password;
+					int Pim;
+					const uint8 *Salts;
+					size_t SaltSize;
+					uint8 *Keys;
+					size_t KeySize;
+					size_t KeyCount;
+				} KeyDerivation;
 			};
 		};
 
+		static void DeriveKeys (const Pkcs5Kdf &kdf, const VolumePassword &password, int pim, const ConstBufferPtr &salts, size_t saltSize, const BufferPtr &keys);
 		static void DoWork (WorkType::Enum type, const EncryptionMode *mode, uint8 *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize);
+		static size_t GetCpuCount ();
+		static size_t GetMaxConcurrentKeyDerivations (uint64 memoryCost);
 		static bool IsRunning () { return ThreadPoolRunning; }
 		static void Start ();
 		static void Stop ();
 
 	protected:
+		static uint64 GetPhysicalMemorySize ();
+		static void WaitForCompletion (WorkItem *firstFragmentWorkItem);
 		static void WorkThreadProc ();
 
 		static const size_t MaxThreadCount = 32;
@@ -34,6 +34,7 @@ namespace VeraCrypt
 		static Pkcs5KdfList GetAvailableAlgorithms ();
 		virtual shared_ptr <Hash> GetHash () const = 0;
 		virtual int GetIterationCount (int pim) const = 0;
+		virtual uint64 GetMemoryCost (int pim) const { return 0; } // Memory allocated by one derivation; negligible for PBKDF2
 		virtual wstring GetName () const = 0;
 		virtual Pkcs5Kdf* Clone () const = 0;
 		virtual bool IsDeprecated () const { return GetHash()->IsDeprecated(); }
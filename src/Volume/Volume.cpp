@@ -13,6 +13,7 @@
 #ifndef TC_WINDOWS
 #include <errno.h>
 #endif
+#include "Crc32.h"
 #include "EncryptionModeXTS.h"
 #include "Volume.h"
 #include "VolumeHeader.h"
@@ -31,7 +32,12 @@ namespace VeraCrypt
 		TotalDataRead (0),
 		TotalDataWritten (0),
 		Pim (0),
-		EncryptionNotCompleted (false)
+		EncryptionNotCompleted (false),
+		ReEncryptionBoundary (0),
+		ReEncryptionLockEnd (0),
+		JournalPieceLength (0),
+		JournalPieceOffset (0),
+		JournalSequence (0)
 	{
 	}
 
@@ -39,6 +45,55 @@ namespace VeraCrypt
 	{
 	}
 
+	void Volume::BeginReEncryption (shared_ptr <VolumeHeader> newHeader, shared_ptr <VolumeHeaderKey> newHeaderKey)
+	{
+		if_debug (ValidateState ());
+
+		if (PreviousEA || !newHeader || !newHeaderKey)
+			throw ParameterIncorrect (SRC_POS);
+
+		ScopeLock lock (ReEncryptionMutex);
+
+		PreviousHeader = Header;
+		PreviousHeaderKey = HeaderKey;
+		PreviousEA = EA;
+
+		Header = newHeader;
+		HeaderKey = newHeaderKey;
+		EA = newHeader->GetEncryptionAlgorithm();
+		Layout->SetHeader (newHeader);
+
+		EncryptedDataSize = newHeader->GetEncryptedAreaLength();
+		ReEncryptionBoundary = VolumeDataOffset + newHeader->GetEncryptedAreaLength();
+		ReEncryptionLockEnd = ReEncryptionBoundary;
+		JournalPieceLength = 0;
+		JournalSequence = 0;
+	}
+
+	bool Volume::BeginReEncryptionIO (uint64 hostOffset, uint64 length, ReEncryptionState &state)
+	{
+		// Sectors being re-encrypted are not accessible until they have been written. The range is registered
+		// to prevent it from being locked before the read or write has been completed.
+		while (true)
+		{
+			{
+				ScopeLock lock (ReEncryptionMutex);
+
+				if (!PreviousEA)
+					return false;
+
+				if (!IsReEncryptionRangeLocked (hostOffset, length))
+				{
+					GetReEncryptionState (hostOffset, length, state);
+					ReEncryptionIO.push_back (make_pair (hostOffset, length));
+					return true;
+				}
+			}
+
+			Thread::Sleep (1);
+		}
+	}
+
 	void Volume::CheckProtectedRange (uint64 writeHostOffset, uint64 writeLength)
 	{
 		uint64 writeHostEndOffset = writeHostOffset + writeLength - 1;
@@ -58,6 +113,54 @@ namespace VeraCrypt
 		VolumeFile.reset();
 	}
 
+	void Volume::DecryptReEncryptedSectors (const BufferPtr &buffer, uint64 hostOffset, const ReEncryptionState &state) const
+	{
+		// Consecutive sectors encrypted with the same key are decrypted at once
+		size_t offset = 0;
+		while (offset < buffer.Size())
+		{
+			bool reEncrypted = IsReEncryptedSector (buffer.Get() + offset, hostOffset + offset, state);
+
+			size_t length = SectorSize;
+			while (offset + length < buffer.Size()
+				&& IsReEncryptedSector (buffer.Get() + offset + length, hostOffset + offset + length, state) == reEncrypted)
+			{
+				length += SectorSize;
+			}
+
+			(reEncrypted ? EA : state.PreviousEA)->DecryptSectors (buffer.GetRange (offset, length), (hostOffset + offset) / SectorSize, length / SectorSize, SectorSize);
+			offset += length;
+		}
+	}
+
+	void Volume::EndReEncryption ()
+	{
+		ScopeLock lock (ReEncryptionMutex);
+
+		PreviousEA.reset();
+		PreviousHeader.reset();
+		PreviousHeaderKey.reset();
+
+		EncryptedDataSize = Header->GetEncryptedAreaLength();
+		ReEncryptionBoundary = 0;
+		ReEncryptionLockEnd = 0;
+		JournalPieceLength = 0;
+	}
+
+	void Volume::EndReEncryptionIO (uint64 hostOffset, uint64 length)
+	{
+		ScopeLock lock (ReEncryptionMutex);
+
+		for (list < pair <uint64, uint64> >::iterator i = ReEncryptionIO.begin(); i != ReEncryptionIO.end(); ++i)
+		{
+			if (i->first == hostOffset && i->second == length)
+			{
+				ReEncryptionIO.erase (i);
+				return;
+			}
+		}
+	}
+
 	shared_ptr <EncryptionAlgorithm> Volume::GetEncryptionAlgorithm () const
 	{
 		if_debug (ValidateState ());
@@ -70,7 +173,79 @@ namespace VeraCrypt
 		return EA->GetMode();
 	}
 
-	void Volume::Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope)
+	void Volume::GetReEncryptionState (uint64 hostOffset, uint64 length, ReEncryptionState &state) const
+	{
+		// The caller holds the re-encryption lock
+		state.PreviousEA = PreviousEA;
+		state.Boundary = ReEncryptionBoundary;
+
+		if (JournalPieceLength != 0 && hostOffset < JournalPieceOffset + JournalPieceLength && hostOffset + length > JournalPieceOffset)
+		{
+			state.JournalPieceOffset = JournalPieceOffset;
+			state.JournalPieceLength = JournalPieceLength;
+			state.JournalSamples.CopyFrom (JournalSamples);
+		}
+		else
+			state.JournalPieceLength = 0;
+	}
+
+	bool Volume::IsReEncryptedSector (const uint8 *encryptedSector, uint64 hostOffset, const ReEncryptionState &state) const
+	{
+		if (hostOffset < state.Boundary)
+			return true;
+
+		// A sector of the journal piece has been re-encrypted if it starts with the bytes recorded in the journal
+		if (hostOffset >= state.JournalPieceOffset && hostOffset < state.JournalPieceOffset + state.JournalPieceLength)
+		{
+			size_t sampleOffset = (size_t) ((hostOffset - state.JournalPieceOffset) / SectorSize * ReEncryptionJournalSampleSize);
+			return memcmp (encryptedSector, state.JournalSamples.Ptr() + sampleOffset, ReEncryptionJournalSampleSize) == 0;
+		}
+
+		return false;
+	}
+
+	void Volume::LockReEncryptionRange (uint64 endOffset)
+	{
+		{
+			ScopeLock lock (ReEncryptionMutex);
+			ReEncryptionLockEnd = VC_MAX (endOffset, ReEncryptionBoundary);
+		}
+
+		// Reads and writes of the locked range started before it was locked are completed first
+		while (true)
+		{
+			{
+				ScopeLock lock (ReEncryptionMutex);
+
+				bool pending = false;
+				for (list < pair <uint64, uint64> >::const_iterator i = ReEncryptionIO.begin(); i != ReEncryptionIO.end() && !pending; ++i)
+					pending = IsReEncryptionRangeLocked (i->first, i->second);
+
+				if (!pending)
+					return;
+			}
+
+			Thread::Sleep (1);
+		}
+	}
+
+	template <class T>
+	static void MoveNamedItemToFront (list < shared_ptr <T> > &items, const wstring &name)
+	{
+		if (name.empty())
+			return;
+
+		for (typename list < shared_ptr <T> >::iterator i = items.begin(); i != items.end(); ++i)
+		{
+			if ((*i)->GetName() == name)
+			{
+				items.splice (items.begin(), items, i);
+				return;
+			}
+		}
+	}
+
+	void Volume::Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope, const VolumeTrialHint &trialHint)
 	{
 		make_shared_auto (File, file);
 
@@ -101,10 +276,10 @@ namespace VeraCrypt
 				throw;
 		}
 
-		return Open (file, password, pim, kdf, keyfiles, emvSupportEnabled, protection, protectionPassword, protectionPim, protectionKdf,protectionKeyfiles, volumeType, useBackupHeaders, partitionInSystemEncryptionScope);
+		return Open (file, password, pim, kdf, keyfiles, emvSupportEnabled, protection, protectionPassword, protectionPim, protectionKdf,protectionKeyfiles, volumeType, useBackupHeaders, partitionInSystemEncryptionScope, trialHint);
 	}
 
-	void Volume::Open (shared_ptr <File> volumeFile, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf,shared_ptr <KeyfileList> protectionKeyfiles, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope)
+	void Volume::Open (shared_ptr <File> volumeFile, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf,shared_ptr <KeyfileList> protectionKeyfiles, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope, const VolumeTrialHint &trialHint)
 	{
 		if (!volumeFile)
 			throw ParameterIncorrect (SRC_POS);
@@ -120,8 +295,26 @@ namespace VeraCrypt
 
 			bool skipLayoutV1Normal = false;
 
-			// Test volume layouts
-			foreach (shared_ptr <VolumeLayout> layout, VolumeLayout::GetAvailableLayouts (volumeType))
+			// Test volume layouts, starting with the type of volume indicated by the hint
+			VolumeLayoutList layouts = VolumeLayout::GetAvailableLayouts (volumeType);
+			if (trialHint.Type != VolumeType::Unknown)
+			{
+				VolumeLayoutList hintedLayouts;
+				for (VolumeLayoutList::iterator i = layouts.begin(); i != layouts.end(); )
+				{
+					if ((*i)->GetType() == trialHint.Type)
+					{
+						hintedLayouts.push_back (*i);
+						i = layouts.erase (i);
+					}
+					else
+						++i;
+				}
+
+				layouts.splice (layouts.begin(), hintedLayouts);
+			}
+
+			foreach (shared_ptr <VolumeLayout> layout, layouts)
 			{
 				if (skipLayoutV1Normal && typeid (*layout) == typeid (VolumeLayoutV1Normal))
 				{
@@ -183,9 +376,16 @@ namespace VeraCrypt
 					layoutEncryptionModes = EncryptionMode::GetAvailableModes();
 				}
 
+				Pkcs5KdfList layoutKeyDerivationFunctions = layout->GetSupportedKeyDerivationFunctions();
+
+				// Try the KDF and encryption algorithm indicated by the hint first
+				MoveNamedItemToFront (layoutKeyDerivationFunctions, trialHint.Kdf);
+				MoveNamedItemToFront (layoutEncryptionAlgorithms, trialHint.EncryptionAlgorithm);
+
 				shared_ptr <VolumeHeader> header = layout->GetHeader();
+				shared_ptr <VolumeHeaderKey> headerKey (new VolumeHeaderKey);
 
-				if (header->Decrypt (headerBuffer, *passwordKey, pim, kdf, layout->GetSupportedKeyDerivationFunctions(), layoutEncryptionAlgorithms, layoutEncryptionModes))
+				if (header->Decrypt (headerBuffer, *passwordKey, pim, kdf, layoutKeyDerivationFunctions, layoutEncryptionAlgorithms, layoutEncryptionModes, trialHint.HeaderKey, headerKey))
 				{
 					// Header decrypted
 
@@ -206,6 +406,7 @@ namespace VeraCrypt
 					EncryptedDataSize = header->GetEncryptedAreaLength();
 
 					Header = header;
+					HeaderKey = headerKey;
 					Layout = layout;
 					EA = header->GetEncryptionAlgorithm();
 					EncryptionMode &mode = *EA->GetMode();
@@ -229,6 +430,18 @@ namespace VeraCrypt
 
 						mode.SetSectorOffset (partitionStartOffset / ENCRYPTION_DATA_UNIT_SIZE);
 					}
+					else if (header->GetFlags() & TC_HEADER_FLAG_REENCRYPTION)
+					{
+						OpenReEncryptedVolume (*passwordKey, pim, kdf, layoutKeyDerivationFunctions, layoutEncryptionAlgorithms, layoutEncryptionModes, useBackupHeaders);
+					}
+					else if ((header->GetFlags() & TC_HEADER_FLAG_NONSYS_INPLACE_ENC) && header->GetEncryptedAreaLength() != header->GetVolumeDataSize())
+					{
+						// In-place encryption has not been completed. Only the encrypted area tracked by the
+						// backup header is in its final location and the volume cannot be accessed until then.
+						EncryptionNotCompleted = true;
+						Protection = VolumeProtection::ReadOnly;
+						VolumeDataOffset = TC_VOLUME_DATA_OFFSET;
+					}
 
 					// Volume protection
 					if (Protection == VolumeProtection::HiddenVolumeReadOnly)
@@ -305,7 +518,82 @@ namespace VeraCrypt
 		}
 	}
 
-	void Volume::ReadSectors (const BufferPtr &buffer, uint64 byteOffset)
+	void Volume::OpenReEncryptedVolume (const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, const Pkcs5KdfList &keyDerivationFunctions, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes, bool useBackupHeaders)
+	{
+		// While the data area is being re-encrypted, the primary header holds the new master key and
+		// the backup header the previous one
+		if (!Layout->HasBackupHeader())
+			throw ParameterIncorrect (SRC_POS);
+
+		int headerOffset = useBackupHeaders ? Layout->GetHeaderOffset() : Layout->GetBackupHeaderOffset();
+
+		SecureBuffer headerBuffer (Layout->GetHeaderSize());
+		if (VolumeFile->ReadAt (headerBuffer, headerOffset >= 0 ? headerOffset : VolumeHostSize + headerOffset) != headerBuffer.Size())
+			throw MissingVolumeData (SRC_POS);
+
+		shared_ptr <VolumeHeader> header (new VolumeHeader (Layout->GetHeaderSize()));
+		shared_ptr <VolumeHeaderKey> headerKey (new VolumeHeaderKey);
+
+		if (!header->Decrypt (headerBuffer, password, pim, kdf, keyDerivationFunctions, encryptionAlgorithms, encryptionModes, shared_ptr <VolumeHeaderKey> (), headerKey))
+			throw VolumeEncryptionNotCompleted (SRC_POS);
+
+		if (useBackupHeaders)
+		{
+			if (!(header->GetFlags() & TC_HEADER_FLAG_REENCRYPTION))
+			{
+				// Re-encryption has not been started or has been completed and the primary header is valid
+				Header = header;
+				HeaderKey = headerKey;
+				EA = header->GetEncryptionAlgorithm();
+				Layout->SetHeader (header);
+				EncryptedDataSize = header->GetEncryptedAreaLength();
+				return;
+			}
+
+			PreviousHeader = Header;
+			PreviousHeaderKey = HeaderKey;
+			Header = header;
+			HeaderKey = headerKey;
+		}
+		else
+		{
+			if (!(header->GetFlags() & TC_HEADER_FLAG_REENCRYPTION))
+				throw VolumeEncryptionNotCompleted (SRC_POS);
+
+			PreviousHeader = header;
+			PreviousHeaderKey = headerKey;
+		}
+
+		if (Header->GetVolumeDataSize() != PreviousHeader->GetVolumeDataSize()
+			|| Header->GetSectorSize() != PreviousHeader->GetSectorSize()
+			|| Header->GetEncryptedAreaLength() > Header->GetVolumeDataSize())
+		{
+			throw ParameterIncorrect (SRC_POS);
+		}
+
+		EA = Header->GetEncryptionAlgorithm();
+		PreviousEA = PreviousHeader->GetEncryptionAlgorithm();
+		Layout->SetHeader (Header);
+
+		EncryptedDataSize = Header->GetEncryptedAreaLength();
+		ReEncryptionBoundary = VolumeDataOffset + Header->GetEncryptedAreaLength();
+
+		ReadReEncryptionJournal();
+		ReEncryptionLockEnd = ReEncryptionBoundary;
+	}
+
+	void Volume::DecryptSectors (const BufferPtr &buffer, uint64 byteOffset)
+	{
+		ReEncryptionState state;
+		{
+			ScopeLock lock (ReEncryptionMutex);
+			GetReEncryptionState (VolumeDataOffset + byteOffset, buffer.Size(), state);
+		}
+
+		DecryptSectors (buffer, byteOffset, state);
+	}
+
+	void Volume::DecryptSectors (const BufferPtr &buffer, uint64 byteOffset, const ReEncryptionState &state)
 	{
 		if_debug (ValidateState ());
 
@@ -316,9 +604,6 @@ namespace VeraCrypt
 		if (length % SectorSize != 0 || byteOffset % SectorSize != 0)
 			throw ParameterIncorrect (SRC_POS);
 
-		if (VolumeFile->ReadAt (buffer, hostOffset) != length)
-			throw MissingVolumeData (SRC_POS);
-
 		// first sector can be unencrypted in some cases (e.g. windows repair)
 		// detect this case by looking for NTFS header
 		if (SystemEncryption && (hostOffset == 0) && ((BE64 (*(uint64 *) buffer.Get ())) == 0xEB52904E54465320ULL))
@@ -340,6 +625,8 @@ namespace VeraCrypt
 					EA->DecryptSectors (buffer.GetRange (bufferOffset, encryptedLength), hostOffset / SectorSize, encryptedLength / SectorSize, SectorSize);			
 				}
 			}
+			else if (state.PreviousEA)
+				DecryptReEncryptedSectors (buffer.GetRange (bufferOffset, length), hostOffset, state);
 			else
 				EA->DecryptSectors (buffer.GetRange (bufferOffset, length), hostOffset / SectorSize, length / SectorSize, SectorSize);
 		}
@@ -347,6 +634,93 @@ namespace VeraCrypt
 		TotalDataRead += length;
 	}
 
+	void Volume::ReadEncryptedSectors (const BufferPtr &buffer, uint64 byteOffset) const
+	{
+		if_debug (ValidateState ());
+
+		if (buffer.Size() % SectorSize != 0 || byteOffset % SectorSize != 0)
+			throw ParameterIncorrect (SRC_POS);
+
+		if (VolumeFile->ReadAt (buffer, VolumeDataOffset + byteOffset) != buffer.Size())
+			throw MissingVolumeData (SRC_POS);
+	}
+
+	void Volume::ReadReEncryptionJournal ()
+	{
+		// Two journal records are written alternately so that an interrupted write leaves the previous one intact
+		uint64 journalOffset = VolumeHostSize + Layout->GetBackupHeaderOffset() + ReEncryptionJournalOffset;
+		Buffer record (ReEncryptionJournalRecordSize);
+
+		JournalPieceLength = 0;
+		JournalSequence = 0;
+
+		for (int i = 0; i < 2; ++i)
+		{
+			uint64 recordOffset = journalOffset + i * ReEncryptionJournalRecordSize;
+
+			if (VolumeFile->ReadAt (record, recordOffset) != record.Size())
+				throw MissingVolumeData (SRC_POS);
+
+			EA->DecryptSectors (record, recordOffset / ENCRYPTION_DATA_UNIT_SIZE, record.Size() / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
+
+			if (memcmp (record.Ptr(), "VCRJ", 4) != 0
+				|| Endian::Big (*(uint32 *) (record.Ptr() + 4)) != Crc32::ProcessBuffer (record.GetRange (8, record.Size() - 8)))
+			{
+				continue;
+			}
+
+			uint64 sequence = Endian::Big (*(uint64 *) (record.Ptr() + 8));
+			uint64 pieceOffset = Endian::Big (*(uint64 *) (record.Ptr() + 16));
+			uint64 pieceLength = Endian::Big (*(uint64 *) (record.Ptr() + 24));
+
+			if (sequence <= JournalSequence
+				|| pieceLength == 0
+				|| pieceLength > ReEncryptionPieceSize
+				|| pieceLength % SectorSize != 0
+				|| pieceOffset % SectorSize != 0
+				|| pieceOffset < VolumeDataOffset
+				|| pieceOffset + pieceLength > VolumeDataOffset + VolumeDataSize)
+			{
+				continue;
+			}
+
+			JournalSequence = sequence;
+			JournalPieceOffset = pieceOffset;
+			JournalPieceLength = pieceLength;
+			JournalSamples.CopyFrom (record.GetRange (32, (size_t) (pieceLength / SectorSize * ReEncryptionJournalSampleSize)));
+		}
+
+		// Pieces below the journal piece have been completed. The journal piece itself has been completed
+		// if a checkpoint has been recorded in the header after it.
+		if (JournalPieceLength != 0 && JournalPieceOffset + JournalPieceLength > ReEncryptionBoundary)
+			ReEncryptionBoundary = JournalPieceOffset;
+		else
+			JournalPieceLength = 0;
+	}
+
+	void Volume::ReadSectors (const BufferPtr &buffer, uint64 byteOffset)
+	{
+		uint64 hostOffset = VolumeDataOffset + byteOffset;
+
+		ReEncryptionState state;
+		bool reEncryptionIO = BeginReEncryptionIO (hostOffset, buffer.Size(), state);
+
+		try
+		{
+			ReadEncryptedSectors (buffer, byteOffset);
+			DecryptSectors (buffer, byteOffset, state);
+		}
+		catch (...)
+		{
+			if (reEncryptionIO)
+				EndReEncryptionIO (hostOffset, buffer.Size());
+			throw;
+		}
+
+		if (reEncryptionIO)
+			EndReEncryptionIO (hostOffset, buffer.Size());
+	}
+
 	void Volume::ReEncryptHeader (bool backupHeader, const ConstBufferPtr &newSalt, const ConstBufferPtr &newHeaderKey, shared_ptr <Pkcs5Kdf> newPkcs5Kdf)
 	{
 		if_debug (ValidateState ());
@@ -368,12 +742,95 @@ namespace VeraCrypt
 		VolumeFile->Write (newHeaderBuffer);
 	}
 
+	void Volume::ReEncryptSectors (const BufferPtr &buffer, uint64 hostOffset)
+	{
+		if_debug (ValidateState ());
+
+		ReEncryptionState state;
+		{
+			ScopeLock lock (ReEncryptionMutex);
+
+			if (!PreviousEA || buffer.Size() % SectorSize != 0 || hostOffset % SectorSize != 0 || hostOffset < ReEncryptionBoundary)
+				throw ParameterIncorrect (SRC_POS);
+
+			GetReEncryptionState (hostOffset, buffer.Size(), state);
+		}
+
+		DecryptReEncryptedSectors (buffer, hostOffset, state);
+		EA->EncryptSectors (buffer, hostOffset / SectorSize, buffer.Size() / SectorSize, SectorSize);
+	}
+
+	void Volume::SetReEncryptionBoundary (uint64 boundary)
+	{
+		ScopeLock lock (ReEncryptionMutex);
+
+		EncryptedDataSize = boundary - VolumeDataOffset;
+		ReEncryptionBoundary = boundary;
+		ReEncryptionLockEnd = VC_MAX (ReEncryptionLockEnd, boundary);
+
+		if (JournalPieceOffset + JournalPieceLength <= boundary)
+			JournalPieceLength = 0;
+	}
+
 	void Volume::ValidateState () const
 	{
 		if (VolumeFile.get() == nullptr)
 			throw NotInitialized (SRC_POS);
 	}
 
+	void Volume::WriteReEncryptionJournal (const ConstBufferPtr &reEncryptedData, uint64 hostOffset)
+	{
+		if_debug (ValidateState ());
+
+		if (!PreviousEA
+			|| reEncryptedData.Size() == 0
+			|| reEncryptedData.Size() > ReEncryptionPieceSize
+			|| reEncryptedData.Size() % SectorSize != 0
+			|| hostOffset % SectorSize != 0
+			|| hostOffset < ReEncryptionBoundary)
+		{
+			throw ParameterIncorrect (SRC_POS);
+		}
+
+		// Record: magic, CRC-32 of the rest of the record, sequence number, offset and length of the piece,
+		// and the first bytes of each re-encrypted sector of the piece
+		Buffer record (ReEncryptionJournalRecordSize);
+		record.Zero();
+
+		uint64 sequence = JournalSequence + 1;
+		size_t sectorCount = reEncryptedData.Size() / SectorSize;
+
+		memcpy (record.Ptr(), "VCRJ", 4);
+		*(uint64 *) (record.Ptr() + 8) = Endian::Big (sequence);
+		*(uint64 *) (record.Ptr() + 16) = Endian::Big (hostOffset);
+		*(uint64 *) (record.Ptr() + 24) = Endian::Big ((uint64) reEncryptedData.Size());
+
+		for (size_t i = 0; i < sectorCount; ++i)
+			memcpy (record.Ptr() + 32 + i * ReEncryptionJournalSampleSize, reEncryptedData.Get() + i * SectorSize, ReEncryptionJournalSampleSize);
+
+		Buffer samples;
+		samples.CopyFrom (record.GetRange (32, sectorCount * ReEncryptionJournalSampleSize));
+
+		*(uint32 *) (record.Ptr() + 4) = Endian::Big (Crc32::ProcessBuffer (record.GetRange (8, record.Size() - 8)));
+
+		uint64 recordOffset = VolumeHostSize + Layout->GetBackupHeaderOffset() + ReEncryptionJournalOffset + (sequence % 2) * ReEncryptionJournalRecordSize;
+		EA->EncryptSectors (record, recordOffset / ENCRYPTION_DATA_UNIT_SIZE, record.Size() / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
+
+		VolumeFile->WriteAt (record, recordOffset);
+		VolumeFile->Flush();
+
+		// Pieces below the journal piece are complete and it stays inaccessible until it has been written
+		ScopeLock lock (ReEncryptionMutex);
+
+		JournalSequence = sequence;
+		JournalPieceOffset = hostOffset;
+		JournalPieceLength = reEncryptedData.Size();
+		JournalSamples.CopyFrom (samples);
+
+		ReEncryptionBoundary = hostOffset;
+		ReEncryptionLockEnd = VC_MAX (ReEncryptionLockEnd, hostOffset + JournalPieceLength);
+	}
+
 	void Volume::WriteSectors (const ConstBufferPtr &buffer, uint64 byteOffset)
 	{
 		if_debug (ValidateState ());
@@ -398,8 +855,39 @@ namespace VeraCrypt
 		SecureBuffer encBuf (buffer.Size());
 		encBuf.CopyFrom (buffer);
 
-		EA->EncryptSectors (encBuf, hostOffset / SectorSize, length / SectorSize, SectorSize);
-		VolumeFile->WriteAt (encBuf, hostOffset);
+		ReEncryptionState state;
+		bool reEncryptionIO = BeginReEncryptionIO (hostOffset, length, state);
+
+		try
+		{
+			if (state.PreviousEA)
+			{
+				// Sectors above the boundary, including those of the journal piece, are written with the previous key
+				uint64 reEncryptedLength = (hostOffset < state.Boundary) ? VC_MIN (length, state.Boundary - hostOffset) : 0;
+
+				if (reEncryptedLength > 0)
+					EA->EncryptSectors (encBuf.GetRange (0, (size_t) reEncryptedLength), hostOffset / SectorSize, reEncryptedLength / SectorSize, SectorSize);
+
+				if (reEncryptedLength < length)
+				{
+					state.PreviousEA->EncryptSectors (encBuf.GetRange ((size_t) reEncryptedLength, (size_t) (length - reEncryptedLength)),
+						(hostOffset + reEncryptedLength) / SectorSize, (length - reEncryptedLength) / SectorSize, SectorSize);
+				}
+			}
+			else
+				EA->EncryptSectors (encBuf, hostOffset / SectorSize, length / SectorSize, SectorSize);
+
+			VolumeFile->WriteAt (encBuf, hostOffset);
+		}
+		catch (...)
+		{
+			if (reEncryptionIO)
+				EndReEncryptionIO (hostOffset, length);
+			throw;
+		}
+
+		if (reEncryptionIO)
+			EndReEncryptionIO (hostOffset, length);
 
 		TotalDataWritten += length;
 
@@ -59,6 +59,20 @@ namespace VeraCrypt
 
 	typedef list <VolumePath> VolumePathList;
 
+	// Parameters of a volume known in advance, used to order header decryption trials
+	// and, if the header key is known, to skip its derivation
+	struct VolumeTrialHint
+	{
+		VolumeTrialHint () : Type (VolumeType::Unknown) { }
+
+		bool IsEmpty () const { return EncryptionAlgorithm.empty() && !HeaderKey && Kdf.empty() && Type == VolumeType::Unknown; }
+
+		wstring EncryptionAlgorithm;
+		shared_ptr <VolumeHeaderKey> HeaderKey;
+		wstring Kdf;
+		VolumeType::Enum Type;
+	};
+
 	struct VolumeHostType
 	{
 		enum Enum
@@ -85,17 +99,28 @@ namespace VeraCrypt
 		Volume ();
 		virtual ~Volume ();
 
+		void BeginReEncryption (shared_ptr <VolumeHeader> newHeader, shared_ptr <VolumeHeaderKey> newHeaderKey);
 		void Close ();
+		void DecryptSectors (const BufferPtr &buffer, uint64 byteOffset);
+		void EndReEncryption ();
+		uint64 GetDataOffset () const { return VolumeDataOffset; }
 		shared_ptr <EncryptionAlgorithm> GetEncryptionAlgorithm () const;
 		shared_ptr <EncryptionMode> GetEncryptionMode () const;
 		shared_ptr <File> GetFile () const { return VolumeFile; }
 		shared_ptr <VolumeHeader> GetHeader () const { return Header; }
 		uint64 GetHeaderCreationTime () const { return Header->GetHeaderCreationTime(); }
+		shared_ptr <VolumeHeaderKey> GetHeaderKey () const { return HeaderKey; }
 		uint64 GetHostSize () const { return VolumeHostSize; }
 		shared_ptr <VolumeLayout> GetLayout () const { return Layout; }
 		VolumePath GetPath () const { return VolumeFile->GetPath(); }
+		shared_ptr <EncryptionAlgorithm> GetPreviousEncryptionAlgorithm () const { return PreviousEA; }
+		shared_ptr <VolumeHeader> GetPreviousHeader () const { return PreviousHeader; }
+		shared_ptr <VolumeHeaderKey> GetPreviousHeaderKey () const { return PreviousHeaderKey; }
+		uint64 GetProtectedRangeEnd () const { return ProtectedRangeEnd; }
+		uint64 GetProtectedRangeStart () const { return ProtectedRangeStart; }
 		VolumeProtection::Enum GetProtectionType () const { return Protection; }
 		shared_ptr <Pkcs5Kdf> GetPkcs5Kdf () const { return Header->GetPkcs5Kdf(); }
+		uint64 GetReEncryptionBoundary () const { return ReEncryptionBoundary; }
 		uint32 GetSaltSize () const { return Header->GetSaltSize(); }
 		size_t GetSectorSize () const { return SectorSize; }
 		uint64 GetSize () const { return VolumeDataSize; }
@@ -108,20 +133,57 @@ namespace VeraCrypt
 		uint64 GetVolumeCreationTime () const { return Header->GetVolumeCreationTime(); }
 		bool IsHiddenVolumeProtectionTriggered () const { return HiddenVolumeProtectionTriggered; }
 		bool IsInSystemEncryptionScope () const { return SystemEncryption; }
-		void Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), bool sharedAccessAllowed = false, VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false);
-		void Open (shared_ptr <File> volumeFile, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (), shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false);
+		bool IsReEncryptionInProgress () const { return PreviousEA != nullptr; }
+		void LockReEncryptionRange (uint64 endOffset);
+		void Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), bool sharedAccessAllowed = false, VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false, const VolumeTrialHint &trialHint = VolumeTrialHint());
+		void Open (shared_ptr <File> volumeFile, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (), shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false, const VolumeTrialHint &trialHint = VolumeTrialHint());
+		void ReadEncryptedSectors (const BufferPtr &buffer, uint64 byteOffset) const;
 		void ReadSectors (const BufferPtr &buffer, uint64 byteOffset);
 		void ReEncryptHeader (bool backupHeader, const ConstBufferPtr &newSalt, const ConstBufferPtr &newHeaderKey, shared_ptr <Pkcs5Kdf> newPkcs5Kdf);
+		void ReEncryptSectors (const BufferPtr &buffer, uint64 hostOffset);
+		void SetReEncryptionBoundary (uint64 boundary);
+		void WriteReEncryptionJournal (const ConstBufferPtr &reEncryptedData, uint64 hostOffset);
 		void WriteSectors (const ConstBufferPtr &buffer, uint64 byteOffset);
 		bool IsEncryptionNotCompleted () const { return EncryptionNotCompleted; }
+		bool IsInPlaceEncryptionInProgress () const { return EncryptionNotCompleted && !SystemEncryption; }
 		bool IsMasterKeyVulnerable() const { return Header && Header->IsMasterKeyVulnerable(); }
 
+		// Pieces of the data area are re-encrypted in place. The piece being written is recorded in a journal
+		// stored in the unused part of the backup header, which allows its sectors to be told apart after
+		// an interruption by comparing their first bytes with those of the re-encrypted data.
+		static const size_t ReEncryptionPieceSize = 1024 * 1024;
+		static const uint32 ReEncryptionJournalOffset = 4096;
+		static const uint32 ReEncryptionJournalRecordSize = 20 * 1024;
+		static const size_t ReEncryptionJournalSampleSize = 8;
+
 	protected:
+		// Re-encryption state relevant to a range of sectors, captured while the range is not locked
+		struct ReEncryptionState
+		{
+			ReEncryptionState () : Boundary (0), JournalPieceLength (0), JournalPieceOffset (0) { }
+
+			shared_ptr <EncryptionAlgorithm> PreviousEA;
+			uint64 Boundary;
+			uint64 JournalPieceLength;
+			uint64 JournalPieceOffset;
+			Buffer JournalSamples;
+		};
+
+		bool BeginReEncryptionIO (uint64 hostOffset, uint64 length, ReEncryptionState &state);
 		void CheckProtectedRange (uint64 writeHostOffset, uint64 writeLength);
+		void DecryptReEncryptedSectors (const BufferPtr &buffer, uint64 hostOffset, const ReEncryptionState &state) const;
+		void DecryptSectors (const BufferPtr &buffer, uint64 byteOffset, const ReEncryptionState &state);
+		void EndReEncryptionIO (uint64 hostOffset, uint64 length);
+		void GetReEncryptionState (uint64 hostOffset, uint64 length, ReEncryptionState &state) const;
+		bool IsReEncryptedSector (const uint8 *encryptedSector, uint64 hostOffset, const ReEncryptionState &state) const;
+		bool IsReEncryptionRangeLocked (uint64 hostOffset, uint64 length) const { return hostOffset < ReEncryptionLockEnd && hostOffset + length > ReEncryptionBoundary && ReEncryptionBoundary < ReEncryptionLockEnd; }
+		void OpenReEncryptedVolume (const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, const Pkcs5KdfList &keyDerivationFunctions, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes, bool useBackupHeaders);
+		void ReadReEncryptionJournal ();
 		void ValidateState () const;
 
 		shared_ptr <EncryptionAlgorithm> EA;
 		shared_ptr <VolumeHeader> Header;
+		shared_ptr <VolumeHeaderKey> HeaderKey;
 		bool HiddenVolumeProtectionTriggered;
 		shared_ptr <VolumeLayout> Layout;
 		uint64 ProtectedRangeStart;
@@ -141,6 +203,18 @@ namespace VeraCrypt
 		int Pim;
 		bool EncryptionNotCompleted;
 
+		shared_ptr <EncryptionAlgorithm> PreviousEA;
+		shared_ptr <VolumeHeader> PreviousHeader;
+		shared_ptr <VolumeHeaderKey> PreviousHeaderKey;
+		uint64 ReEncryptionBoundary;		// Sectors below this host offset have been re-encrypted
+		uint64 ReEncryptionLockEnd;			// Sectors between the boundary and this offset are being re-encrypted
+		Mutex ReEncryptionMutex;
+		list < pair <uint64, uint64> > ReEncryptionIO;	// Host ranges being read or written outside the lock
+		uint64 JournalPieceLength;			// Piece recorded in the journal which may be partially re-encrypted
+		uint64 JournalPieceOffset;
+		Buffer JournalSamples;
+		uint64 JournalSequence;
+
 	private:
 		Volume (const Volume &);
 		Volume &operator= (const Volume &);
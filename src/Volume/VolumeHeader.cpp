@@ -93,13 +93,14 @@ namespace VeraCrypt
 		EncryptNew (headerBuffer, options.Salt, options.HeaderKey, options.Kdf);
 	}
 
-	bool VolumeHeader::Decrypt (const ConstBufferPtr &encryptedData, const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, const Pkcs5KdfList &keyDerivationFunctions, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes)
+	bool VolumeHeader::Decrypt (const ConstBufferPtr &encryptedData, const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, const Pkcs5KdfList &keyDerivationFunctions, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes, shared_ptr <VolumeHeaderKey> derivedHeaderKey, shared_ptr <VolumeHeaderKey> decryptionHeaderKey)
 	{
 		if (password.Size() < 1)
 			throw PasswordEmpty (SRC_POS);
 
 		ConstBufferPtr salt (encryptedData.GetRange (SaltOffset, SaltSize));
 		SecureBuffer header (EncryptedHeaderDataSize);
+		SecureBuffer firstBlock (BYTES_PER_XTS_BLOCK);
 		SecureBuffer headerKey (GetLargestSerializedKeySize());
 
 		foreach (shared_ptr <Pkcs5Kdf> pkcs5, keyDerivationFunctions)
@@ -107,7 +108,10 @@ namespace VeraCrypt
 			if (kdf && (kdf->GetName() != pkcs5->GetName()))
 				continue;
 
-			pkcs5->DeriveKey (headerKey, password, pim, salt);
+			if (derivedHeaderKey && derivedHeaderKey->IsDerivedFrom (*pkcs5, salt) && derivedHeaderKey->Key.Size() == headerKey.Size())
+				headerKey.CopyFrom (derivedHeaderKey->Key);
+			else
+				pkcs5->DeriveKey (headerKey, password, pim, salt);
 
 			foreach (shared_ptr <EncryptionMode> mode, encryptionModes)
 			{
@@ -144,11 +148,33 @@ namespace VeraCrypt
 
 					ea->SetMode (mode);
 
+					// The first cipher block of XTS-encrypted data can be decrypted independently of the rest of
+					// the header, which allows wrong candidates to be rejected without decrypting the whole header
+					if (mode->GetName() == L"XTS")
+					{
+						firstBlock.CopyFrom (encryptedData.GetRange (EncryptedHeaderDataOffset, firstBlock.Size()));
+						ea->Decrypt (firstBlock);
+
+						if (firstBlock[0] != 'V' ||
+							firstBlock[1] != 'E' ||
+							firstBlock[2] != 'R' ||
+							firstBlock[3] != 'A')
+							continue;
+					}
+
 					header.CopyFrom (encryptedData.GetRange (EncryptedHeaderDataOffset, EncryptedHeaderDataSize));
 					ea->Decrypt (header);
 
 					if (Deserialize (header, ea, mode))
 					{
+						// The header key is required to update the header without deriving it again
+						if (decryptionHeaderKey)
+						{
+							decryptionHeaderKey->Kdf = pkcs5->GetName();
+							decryptionHeaderKey->Key.CopyFrom (headerKey);
+							decryptionHeaderKey->Salt.CopyFrom (salt);
+						}
+
 						EA = ea;
 						Pkcs5 = pkcs5;
 						return true;
@@ -189,9 +215,6 @@ namespace VeraCrypt
 
 		RequiredMinProgramVersion = DeserializeEntry <uint16> (header, offset);
 
-		if ((RequiredMinProgramVersion > Version::Number()))
-			throw HigherVersionRequired (SRC_POS);
-
 		VolumeKeyAreaCrc32 = DeserializeEntry <uint32> (header, offset);
 		VolumeCreationTime = DeserializeEntry <uint64> (header, offset);
 		HeaderCreationTime = DeserializeEntry <uint64> (header, offset);
@@ -202,6 +225,13 @@ namespace VeraCrypt
 		EncryptedAreaLength = DeserializeEntry <uint64> (header, offset);
 		Flags = DeserializeEntry <uint32> (header, offset);
 
+		// Headers of a volume being re-encrypted require a version above any release
+		if (RequiredMinProgramVersion > Version::Number()
+			&& !(RequiredMinProgramVersion == TC_VOLUME_REENCRYPTION_REQUIRED_PROGRAM_VERSION && (Flags & TC_HEADER_FLAG_REENCRYPTION)))
+		{
+			throw HigherVersionRequired (SRC_POS);
+		}
+
 		SectorSize = DeserializeEntry <uint32> (header, offset);
 		if (HeaderVersion < 5)
 			SectorSize = TC_SECTOR_SIZE_LEGACY;
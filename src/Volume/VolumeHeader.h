@@ -53,6 +53,16 @@ namespace VeraCrypt
 		VolumeType::Enum Type;
 	};
 
+	// Header key derived in advance from the salt of a known header
+	struct VolumeHeaderKey
+	{
+		bool IsDerivedFrom (const Pkcs5Kdf &kdf, const ConstBufferPtr &salt) const { return Kdf == kdf.GetName() && Salt.Size() == salt.Size() && ConstBufferPtr (Salt).IsDataEqual (salt); }
+
+		wstring Kdf;
+		SecureBuffer Key;
+		SecureBuffer Salt;
+	};
+
 	class VolumeHeader
 	{
 	public:
@@ -60,7 +70,7 @@ namespace VeraCrypt
 		virtual ~VolumeHeader ();
 
 		void Create (const BufferPtr &headerBuffer, VolumeHeaderCreationOptions &options);
-		bool Decrypt (const ConstBufferPtr &encryptedData, const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, const Pkcs5KdfList &keyDerivationFunctions, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes);
+		bool Decrypt (const ConstBufferPtr &encryptedData, const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, const Pkcs5KdfList &keyDerivationFunctions, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes, shared_ptr <VolumeHeaderKey> derivedHeaderKey = shared_ptr <VolumeHeaderKey> (), shared_ptr <VolumeHeaderKey> decryptionHeaderKey = shared_ptr <VolumeHeaderKey> ());
 		void EncryptNew (const BufferPtr &newHeaderBuffer, const ConstBufferPtr &newSalt, const ConstBufferPtr &newHeaderKey, shared_ptr <Pkcs5Kdf> newPkcs5Kdf);
 		uint64 GetEncryptedAreaStart () const { return EncryptedAreaStart; }
 		uint64 GetEncryptedAreaLength () const { return EncryptedAreaLength; }
@@ -75,7 +85,11 @@ namespace VeraCrypt
 		static uint32 GetSaltSize () { return SaltSize; }
 		uint64 GetVolumeDataSize () const { return VolumeDataSize; }
 		VolumeTime GetVolumeCreationTime () const { return VolumeCreationTime; }
+		void SetEncryptedArea (uint64 start, uint64 length) { EncryptedAreaStart = start; EncryptedAreaLength = length; }
+		void SetFlags (uint32 flags) { Flags = flags; }
+		void SetRequiredMinProgramVersion (uint16 version) { RequiredMinProgramVersion = version; }
 		void SetSize (uint32 headerSize);
+		void SetVolumeDataSize (uint64 size) { VolumeDataSize = size; }
 		bool IsMasterKeyVulnerable () const { return XtsKeyVulnerable; }
 
 	protected: